@@ -0,0 +1,290 @@
+/* ************************************************************************** */
+/**
+ * @file     hot_cold.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Benchmark a filtered scan over the ion and line tables, with and without
+ * their cold fields stored inline.
+ *
+ * @details
+ *
+ * The cold fields of each ion and line are kept apart from them in ion_links
+ * and line_links. To measure what that saves a query, the same synthetic
+ * records are put into a table of the hot records on their own, and into a
+ * table where each hot record is followed by its cold record, which is how
+ * they were stored before. The same filter is then run over both, in storage
+ * order and through a shuffled pointer array as lin_ptr is used.
+ *
+ * There are no hardware counters to read, so the number of cache lines each
+ * table takes up is printed alongside the best time of NREPEAT scans.
+ *
+ * Usage: bench_hot_cold [nlines] [nions]
+ *
+ * ************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "../src/atomix.h"
+
+#define NLINES_DEFAULT 2000000
+#define NIONS_DEFAULT 200000
+#define NREPEAT 7
+#define CACHE_LINE 64
+
+typedef struct wide_line
+{
+  line_dummy hot;
+  line_links_dummy cold;
+} wide_line;
+
+typedef struct wide_ion
+{
+  ion_dummy hot;
+  ion_links_dummy cold;
+} wide_ion;
+
+/* The tables are published through escape, so the compiler has to assume the
+   timer calls can change them and cannot move a scan out of its timed region.
+   The count of each scan is stored in found, so no scan can be left out */
+
+static void *volatile escape;
+static volatile int found;
+
+/* ************************************************************************** */
+/**
+ * @brief  The time in seconds from an arbitrary start.
+ *
+ * ************************************************************************** */
+
+static double
+wall_time(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  A uniform random number in [0, 1).
+ *
+ * ************************************************************************** */
+
+static double
+uniform(void)
+{
+  return rand() / (RAND_MAX + 1.0);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  The filter used by the line queries, on z, istate, freq and gf.
+ *
+ * ************************************************************************** */
+
+static inline int
+line_matches(const line_dummy *l)
+{
+  return l->z == 26 && l->istate == 2 && l->freq > 1e15 && l->freq < 2e15 && l->gl * l->f > 0.1;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  The filter used by the ion queries, on z, phot_info and ip.
+ *
+ * ************************************************************************** */
+
+static inline int
+ion_matches(const ion_dummy *ion)
+{
+  return ion->z == 26 && ion->phot_info > 0 && ion->ip > 1e-11;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the best time of a scan and the cache lines of its table.
+ *
+ * ************************************************************************** */
+
+static void
+report(const char *name, double best, size_t bytes, int nfound)
+{
+  printf("  %-28s %9.0f cache lines %8.2f ms  (%d found)\n", name, (double) bytes / CACHE_LINE, 1e3 * best,
+         nfound);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Scan the lines, in storage order and in a shuffled order.
+ *
+ * ************************************************************************** */
+
+static int
+bench_lines(int n)
+{
+  int i, j, k, r, nfound;
+  int *order;
+  double t, best_hot, best_wide, best_hot_ptr, best_wide_ptr;
+  line_dummy *hot;
+  wide_line *wide;
+
+  hot = calloc(n, sizeof(line_dummy));
+  wide = calloc(n, sizeof(wide_line));
+  order = malloc(n * sizeof(int));
+  if(hot == NULL || wide == NULL || order == NULL)
+    return EXIT_FAILURE;
+  escape = hot;
+  escape = wide;
+
+  for(i = 0; i < n; ++i)
+  {
+    hot[i].freq = 1e14 * (1 + 99 * uniform());
+    hot[i].f = uniform();
+    hot[i].gl = 1 + rand() % 10;
+    hot[i].gu = 1 + rand() % 10;
+    hot[i].z = 1 + rand() % 30;
+    hot[i].istate = 1 + rand() % hot[i].z;
+    wide[i].hot = hot[i];
+    order[i] = i;
+  }
+
+  for(i = n - 1; i > 0; --i)
+  {
+    j = rand() % (i + 1);
+    k = order[i];
+    order[i] = order[j];
+    order[j] = k;
+  }
+
+  best_hot = best_wide = best_hot_ptr = best_wide_ptr = 1e30;
+  nfound = 0;
+
+  for(r = 0; r < NREPEAT; ++r)
+  {
+    t = wall_time();
+    for(i = 0, nfound = 0; i < n; ++i)
+      nfound += line_matches(&hot[i]);
+    found = nfound;
+    best_hot = fmin(best_hot, wall_time() - t);
+
+    t = wall_time();
+    for(i = 0, nfound = 0; i < n; ++i)
+      nfound += line_matches(&wide[i].hot);
+    found = nfound;
+    best_wide = fmin(best_wide, wall_time() - t);
+
+    t = wall_time();
+    for(i = 0, nfound = 0; i < n; ++i)
+      nfound += line_matches(&hot[order[i]]);
+    found = nfound;
+    best_hot_ptr = fmin(best_hot_ptr, wall_time() - t);
+
+    t = wall_time();
+    for(i = 0, nfound = 0; i < n; ++i)
+      nfound += line_matches(&wide[order[i]].hot);
+    found = nfound;
+    best_wide_ptr = fmin(best_wide_ptr, wall_time() - t);
+  }
+
+  printf("%d lines, %zu byte hot record, %zu byte cold record:\n", n, sizeof(line_dummy), sizeof(line_links_dummy));
+  report("inline cold, storage order", best_wide, n * sizeof(wide_line), nfound);
+  report("split, storage order", best_hot, n * sizeof(line_dummy), nfound);
+  report("inline cold, shuffled order", best_wide_ptr, n * sizeof(wide_line), nfound);
+  report("split, shuffled order", best_hot_ptr, n * sizeof(line_dummy), nfound);
+
+  free(hot);
+  free(wide);
+  free(order);
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Scan the ions in storage order.
+ *
+ * ************************************************************************** */
+
+static int
+bench_ions(int n)
+{
+  int i, r, nfound;
+  double t, best_hot, best_wide;
+  ion_dummy *hot;
+  wide_ion *wide;
+
+  hot = calloc(n, sizeof(ion_dummy));
+  wide = calloc(n, sizeof(wide_ion));
+  if(hot == NULL || wide == NULL)
+    return EXIT_FAILURE;
+  escape = hot;
+  escape = wide;
+
+  for(i = 0; i < n; ++i)
+  {
+    hot[i].z = 1 + rand() % 30;
+    hot[i].istate = 1 + rand() % hot[i].z;
+    hot[i].ip = 1e-12 * (1 + 99 * uniform());
+    hot[i].phot_info = rand() % 3 - 1;
+    wide[i].hot = hot[i];
+  }
+
+  best_hot = best_wide = 1e30;
+  nfound = 0;
+
+  for(r = 0; r < NREPEAT; ++r)
+  {
+    t = wall_time();
+    for(i = 0, nfound = 0; i < n; ++i)
+      nfound += ion_matches(&hot[i]);
+    found = nfound;
+    best_hot = fmin(best_hot, wall_time() - t);
+
+    t = wall_time();
+    for(i = 0, nfound = 0; i < n; ++i)
+      nfound += ion_matches(&wide[i].hot);
+    found = nfound;
+    best_wide = fmin(best_wide, wall_time() - t);
+  }
+
+  printf("%d ions, %zu byte hot record, %zu byte cold record:\n", n, sizeof(ion_dummy), sizeof(ion_links_dummy));
+  report("inline cold, storage order", best_wide, n * sizeof(wide_ion), nfound);
+  report("split, storage order", best_hot, n * sizeof(ion_dummy), nfound);
+
+  free(hot);
+  free(wide);
+
+  return EXIT_SUCCESS;
+}
+
+int
+main(int argc, char **argv)
+{
+  int n, nion;
+
+  n = argc > 1 ? atoi(argv[1]) : NLINES_DEFAULT;
+  nion = argc > 2 ? atoi(argv[2]) : NIONS_DEFAULT;
+  if(n < 1 || nion < 1)
+  {
+    fprintf(stderr, "usage: %s [nlines] [nions]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  srand(7);
+
+  if(bench_lines(n) || bench_ions(nion))
+  {
+    fprintf(stderr, "unable to allocate memory for the tables\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
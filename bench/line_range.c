@@ -0,0 +1,360 @@
+/* ************************************************************************** */
+/**
+ * @file     line_range.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Benchmark and check find_line_range() against the binary search which
+ * limit_lines() used before it.
+ *
+ * @details
+ *
+ * A synthetic line list is built, either with the frequencies spread at random
+ * over four decades or with most of the lines clustered into narrow
+ * multiplets, and a set of random frequency windows is generated for it. Every
+ * window is first checked against a brute force scan of the line list, and
+ * limit_lines() is checked against the old routine. Then the time per query is
+ * measured for the old routine and for find_line_range().
+ *
+ * Usage: bench_line_range [nlines] [nqueries]
+ *
+ * ************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "../src/atomix.h"
+
+#define NLINES_DEFAULT 200000
+#define NQUERIES_DEFAULT 1000000
+#define CHECK_WORK 1000000000L  /* The number of lines compared by the brute force check, at most */
+
+/* ************************************************************************** */
+/**
+ * @brief  The limits of a frequency range, as limit_lines() found them before
+ *         find_line_range().
+ *
+ * @param[in]  freqmin  The lowest frequency of the range
+ * @param[in]  freqmax  The highest frequency of the range
+ *
+ * @return  The number of lines between nline_min and nline_max, inclusive
+ *
+ * ************************************************************************** */
+
+static int
+limit_lines_bsearch(double freqmin, double freqmax)
+{
+  int nmin, nmax, n;
+  double f;
+
+  if(freqmin > lin_ptr[nlines - 1]->freq || freqmax < lin_ptr[0]->freq)
+  {
+    nline_min = 0;
+    nline_max = 0;
+    nline_delt = 0;
+    return (0);
+  }
+
+  f = freqmin;
+  nmin = 0;
+  nmax = nlines - 1;
+  n = (nmin + nmax) >> 1;
+
+  while(n != nmin)
+  {
+    if(lin_ptr[n]->freq < f)
+      nmin = n;
+    if(lin_ptr[n]->freq >= f)
+      nmax = n;
+    n = (nmin + nmax) >> 1;
+  }
+
+  nline_min = nmin;
+
+  f = freqmax;
+  nmin = 0;
+  nmax = nlines - 1;
+  n = (nmin + nmax) >> 1;
+
+  while(n != nmin)
+  {
+    if(lin_ptr[n]->freq <= f)
+      nmin = n;
+    if(lin_ptr[n]->freq > f)
+      nmax = n;
+    n = (nmin + nmax) >> 1;
+  }
+
+  nline_max = nmax;
+
+  return (nline_delt = nline_max - nline_min + 1);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  The time in seconds from an arbitrary start.
+ *
+ * ************************************************************************** */
+
+static double
+wall_time(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  A uniform random number in [0, 1).
+ *
+ * ************************************************************************** */
+
+static double
+uniform(void)
+{
+  return rand() / (RAND_MAX + 1.0);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Compare two doubles for qsort().
+ *
+ * ************************************************************************** */
+
+static int
+compare_double(const void *a, const void *b)
+{
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+
+  return (x > y) - (x < y);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build a synthetic line list, ordered by frequency.
+ *
+ * @param[in]  n          The number of lines
+ * @param[in]  clustered  If TRUE, nine in ten lines are put into one of twenty
+ *                        narrow multiplets
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * Every fiftieth line repeats the frequency of the line before it, so that
+ * windows which start or end exactly on a run of equal frequencies are tested.
+ *
+ * ************************************************************************** */
+
+static int
+make_lines(int n, int clustered)
+{
+  int i;
+  double *freq;
+
+  free(line);
+  free(lin_ptr);
+  free_line_columns();
+
+  line = calloc(n, sizeof(line_dummy));
+  lin_ptr = malloc(n * sizeof(LinePtr));
+  if((freq = malloc(n * sizeof(double))) == NULL || line == NULL || lin_ptr == NULL)
+  {
+    free(freq);
+    return EXIT_FAILURE;
+  }
+
+  for(i = 0; i < n; i++)
+  {
+    if(clustered && i % 10 != 0)
+      freq[i] = pow(10, 14 + 2 * (rand() % 20) / 20.0) * (1 + 1e-5 * uniform());
+    else
+      freq[i] = pow(10, 13 + 4 * uniform());
+    if(i > 0 && i % 50 == 0)
+      freq[i] = freq[i - 1];
+  }
+
+  qsort(freq, n, sizeof(double), compare_double);
+
+  for(i = 0; i < n; i++)
+  {
+    line[i].freq = freq[i];
+    line[i].z = 1;
+    lin_ptr[i] = &line[i];
+  }
+  nlines = n;
+  free(freq);
+
+  return build_line_columns();
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Generate random frequency windows over the line list.
+ *
+ * @details
+ *
+ * Random windows are up to 2% wide and cover the list and a little either side
+ * of it. For a clustered list, every other window is a narrow one inside a
+ * multiplet. One window in 97 is a single frequency of a line, so that exact
+ * hits on the edges are tested.
+ *
+ * ************************************************************************** */
+
+static void
+make_windows(int nqueries, int clustered, double *freqmin, double *freqmax)
+{
+  int i;
+  double lo, hi;
+
+  for(i = 0; i < nqueries; i++)
+  {
+    if(clustered && i % 2)
+    {
+      lo = lin_ptr[rand() % nlines]->freq * (1 + 1e-6 * (uniform() - 0.5));
+      hi = lo * (1 + 1e-5 * uniform());
+    }
+    else
+    {
+      lo = pow(10, 12.9 + 4.2 * uniform());
+      hi = lo * pow(10, 0.01 * uniform());
+    }
+    if(i % 97 == 0)
+      lo = hi = lin_ptr[rand() % nlines]->freq;
+    freqmin[i] = lo;
+    freqmax[i] = hi;
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Check the ranges of a sample of the windows by brute force.
+ *
+ * @return  The number of windows where find_line_range() or limit_lines()
+ *          disagree with the brute force scan or the old routine
+ *
+ * @details
+ *
+ * The scan looks at every line for each window, so the windows are sampled
+ * evenly to keep the number of lines compared below CHECK_WORK.
+ *
+ * ************************************************************************** */
+
+static int
+check_windows(int nqueries, const double *freqmin, const double *freqmax)
+{
+  int i, stride, first, end, nbad;
+  int ndelt, nmin, nmax;
+  LineRange range;
+
+  nbad = 0;
+  stride = (int) ((long) nqueries * nlines / CHECK_WORK) + 1;
+
+  for(i = 0; i < nqueries; i += stride)
+  {
+    for(first = 0; first < nlines && lin_ptr[first]->freq < freqmin[i]; first++);
+    for(end = first; end < nlines && lin_ptr[end]->freq <= freqmax[i]; end++);
+
+    range = find_line_range(freqmin[i], freqmax[i]);
+    if(range.first != first || range.end != end)
+      nbad++;
+
+    ndelt = limit_lines_bsearch(freqmin[i], freqmax[i]);
+    nmin = nline_min;
+    nmax = nline_max;
+    if(limit_lines(freqmin[i], freqmax[i]) != ndelt || nline_min != nmin || nline_max != nmax)
+      nbad++;
+  }
+
+  return nbad;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Time each query over all of the windows.
+ *
+ * ************************************************************************** */
+
+static void
+time_windows(int nqueries, const double *freqmin, const double *freqmax, double *t_old, double *t_new)
+{
+  int i;
+  double start;
+  LineRange range;
+  volatile long sink = 0;
+
+  start = wall_time();
+  for(i = 0; i < nqueries; i++)
+  {
+    limit_lines_bsearch(freqmin[i], freqmax[i]);
+    sink += nline_min + nline_max;
+  }
+  *t_old = (wall_time() - start) / nqueries;
+
+  start = wall_time();
+  for(i = 0; i < nqueries; i++)
+  {
+    range = find_line_range(freqmin[i], freqmax[i]);
+    sink += range.first + range.end;
+  }
+  *t_new = (wall_time() - start) / nqueries;
+
+  (void) sink;
+}
+
+int
+main(int argc, char **argv)
+{
+  int n, nqueries, clustered, nbad, error;
+  double *freqmin, *freqmax;
+  double t_old, t_new;
+
+  n = argc > 1 ? atoi(argv[1]) : NLINES_DEFAULT;
+  nqueries = argc > 2 ? atoi(argv[2]) : NQUERIES_DEFAULT;
+  if(n < 1 || nqueries < 1)
+  {
+    fprintf(stderr, "usage: %s [nlines] [nqueries]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  freqmin = malloc(nqueries * sizeof(double));
+  freqmax = malloc(nqueries * sizeof(double));
+  if(freqmin == NULL || freqmax == NULL)
+  {
+    fprintf(stderr, "unable to allocate memory for the windows\n");
+    return EXIT_FAILURE;
+  }
+
+  error = FALSE;
+  srand(7);
+
+  for(clustered = FALSE; clustered <= TRUE; clustered++)
+  {
+    if(make_lines(n, clustered))
+    {
+      fprintf(stderr, "unable to allocate memory for the line list\n");
+      return EXIT_FAILURE;
+    }
+
+    make_windows(nqueries, clustered, freqmin, freqmax);
+    nbad = check_windows(nqueries, freqmin, freqmax);
+    time_windows(nqueries, freqmin, freqmax, &t_old, &t_new);
+
+    printf("%8d lines, %-9s windows: limit_lines %7.1f ns, find_line_range %7.1f ns per query, %d mismatches\n",
+           n, clustered ? "clustered" : "random", 1e9 * t_old, 1e9 * t_new, nbad);
+    error |= nbad != 0;
+  }
+
+  free(freqmin);
+  free(freqmax);
+
+  return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
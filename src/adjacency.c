@@ -0,0 +1,231 @@
+/* ************************************************************************** */
+/**
+ * @file     adjacency.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Lists of the lines and photoionization edges which go into or out of each
+ * level.
+ *
+ * @details
+ *
+ * Only macro atom levels have lists of their jumps, so for any other level the
+ * transitions it takes part in had to be found by checking the lower and upper
+ * configuration of every line. Instead, for each kind of link in LevelLink,
+ * the positions of the transitions are grouped by level in one array, with a
+ * second array giving where the list of each level starts. The lists are
+ * filled with a counting sort over the frequency ordered lists, so each list
+ * is in frequency order and the transitions of a level are found in time
+ * proportional to how many there are.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+
+#include "atomix.h"
+
+typedef struct LevelLinks_t
+{
+  int nkeys;                    /* The number of levels */
+  int *start;                   /* Where the list of each level starts, with an extra entry for the end */
+  int *entries;                 /* The positions in frequency order */
+} LevelLinks_t;
+
+static LevelLinks_t level_links[NLEVEL_LINKS];
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the level link lists.
+ *
+ * ************************************************************************** */
+
+void
+free_level_links(void)
+{
+  int kind;
+
+  for(kind = 0; kind < NLEVEL_LINKS; ++kind)
+  {
+    free(level_links[kind].start);
+    free(level_links[kind].entries);
+    level_links[kind].start = NULL;
+    level_links[kind].entries = NULL;
+    level_links[kind].nkeys = 0;
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the number of entries in the list a kind of link points into,
+ *         and the level one of them is linked to.
+ *
+ * @param[in]   kind   The kind of link
+ * @param[in]   i      The position of the entry, or -1 to only get the number
+ *                     of entries
+ * @param[out]  level  The level the entry is linked to, which is negative if
+ *                     it is not linked to a level
+ *
+ * @return  The number of entries in the list
+ *
+ * ************************************************************************** */
+
+static int
+level_link_source(int kind, int i, int *level)
+{
+  switch(kind)
+  {
+  case LEVEL_LINES_UP:
+    if(i >= 0)
+      *level = lin_ptr[i]->nconfigl;
+    return line_columns.nlines;
+  case LEVEL_LINES_DOWN:
+    if(i >= 0)
+      *level = lin_ptr[i]->nconfigu;
+    return line_columns.nlines;
+  case LEVEL_PHOT_FROM:
+    if(i >= 0)
+      *level = phot_top_ptr[i]->nlev;
+    return nphot_total;
+  case LEVEL_PHOT_TO:
+    if(i >= 0)
+      *level = phot_top_ptr[i]->uplev;
+    return nphot_total;
+  case LEVEL_INNER_FROM:
+    if(i >= 0)
+      *level = inner_cross_ptr[i]->nlev;
+    return n_inner_tot;
+  default:
+    return 0;
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the link lists for every level.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * This has to be called once the line columns have been built, and again
+ * whenever the frequency ordered lists change. Lines which were not matched to
+ * a level when the data was read in are left out.
+ *
+ * ************************************************************************** */
+
+int
+build_level_links(void)
+{
+  int i, n, kind, level;
+  int *keys;
+  LevelLinks_t *links;
+
+  free_level_links();
+
+  for(kind = 0; kind < NLEVEL_LINKS; ++kind)
+  {
+    links = &level_links[kind];
+    n = level_link_source(kind, -1, NULL);
+
+    links->nkeys = nlevels;
+    links->start = calloc(nlevels + 1, sizeof(int));
+    links->entries = malloc((n + 1) * sizeof(int));
+    keys = malloc((n + 1) * sizeof(int));
+
+    if(links->start == NULL || links->entries == NULL || keys == NULL)
+    {
+      free(keys);
+      free_level_links();
+      return EXIT_FAILURE;
+    }
+
+    /*
+     * As with the posting lists, count the entries of each level, turn the
+     * counts into where each list ends and put the entries in from the back
+     */
+
+    for(i = 0; i < n; ++i)
+    {
+      level_link_source(kind, i, &level);
+      keys[i] = level;
+      if(level >= 0 && level < nlevels)
+        links->start[level]++;
+    }
+
+    for(level = 1; level <= nlevels; ++level)
+      links->start[level] += links->start[level - 1];
+
+    for(i = n - 1; i >= 0; --i)
+      if(keys[i] >= 0 && keys[i] < nlevels)
+        links->entries[--links->start[keys[i]]] = i;
+
+    free(keys);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the transitions of one kind which are linked to a level.
+ *
+ * @param[in]   kind     The kind of link
+ * @param[in]   level    The level, as an index into config
+ * @param[out]  entries  The positions in the frequency ordered list of each
+ *                       transition found, in frequency order
+ *
+ * @return  The number of transitions found
+ *
+ * @details
+ *
+ * entries points into the link lists, so must not be freed and is only good
+ * until the link lists are next built.
+ *
+ * ************************************************************************** */
+
+int
+find_level_links(int kind, int level, const int **entries)
+{
+  LevelLinks_t *links;
+
+  *entries = NULL;
+
+  if(kind < 0 || kind >= NLEVEL_LINKS)
+    return 0;
+
+  links = &level_links[kind];
+  if(links->start == NULL || level < 0 || level >= links->nkeys)
+    return 0;
+
+  *entries = links->entries + links->start[level];
+
+  return links->start[level + 1] - links->start[level];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the level link lists to a memory table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * ************************************************************************** */
+
+void
+level_links_memory(MemoryTable *table)
+{
+  int kind, n;
+  const LevelLinks_t *links;
+
+  for(kind = 0; kind < NLEVEL_LINKS; ++kind)
+  {
+    links = &level_links[kind];
+    if(links->start == NULL)
+      continue;
+
+    n = level_link_source(kind, -1, NULL);
+    account_memory(table, links->start, (links->nkeys + 1) * sizeof(int), (links->nkeys + 1) * sizeof(int));
+    account_memory(table, links->entries, (n + 1) * sizeof(int), links->start[links->nkeys] * sizeof(int));
+  }
+}
@@ -57,39 +57,42 @@ enum ERRORS
    Note that the structure ele array may not be completely filled.  In this structure, the dimension is simply
    the order in which elements are read in, and one may skip elements (which are not of interest).
 
-   So that one can easily find, say carbon, however, *elz contains pointers to ele such that elz[6] is the
-   pointer to carbon.  Elements for which there is no data, point to the dummy element structure foo_element
+   So that one can easily find, say carbon, however, elz contains the index into ele such that ele[elz[6]] is
+   carbon.  Elements for which there is no data have an index of -1.  The tables are filled in by the functions
+   in lookup.c, which should be used rather than accessing elz directly
 
    If you want to cycle through the elements one will act on ele directly.  If you want to know something
-   about a specific element *elz may be better, at least that is the idea
+   about a specific element, element_index() and element_index_by_name() are the way to find it
 
  */
 
 
 #define NELEMENTS		50          /* Maximum number of elements to consider */
+#define ZMAX			120         /* Largest atomic number which can be looked up */
 int nelements;                  /* The actual number of ions read from the data file */
-#define NIONS		500             /* Maximum number of ions to consider */
+#define NIONS		500             /* The size of the rate coefficient work arrays, one entry per ion */
 int nions;                      /*The actual number of ions read from the datafile */
-#define NLEVELS 	12000         /* Maximum number of levels for all elements and ions */
+int nions_max;                  /* The number of ions allocated */
 int nlevels;                    /*These are the actual number of levels which were read in */
+int nlevels_max;                /* The number of levels allocated */
 #define NLTE_LEVELS	12000       /* Maximum number of levels to treat explicitly */
 int nlte_levels;                /* Actual number of levels to treat explicityly */
 #define NLEVELS_MACRO   200     /* Maximum number of macro atom levels. (SS, June 04) */
 int nlevels_macro;              /* Actual number of macro atom levels. (SS, June 04) */
-#define NLINES 		200000        /* Maximum number of lines to be read */
+#define NLINES 		200000        /* Maximum number of lines in Python, which bound-free process numbers follow on from */
 int nlines;                     /* Actual number of lines that were read in */
+int nlines_max;                 /* The number of lines allocated */
 int nlines_macro;               /* Actual number of Macro Atom lines that were read in.  New version of get_atomic
                                    data assumes that macro lines are read in before non-macro lines */
 #define N_INNER     10          /*Maximum number of inner shell ionization cross sections per ion */
 int n_inner_tot;                /*The actual number of inner shell ionization cross sections in total */
+int n_inner_max;                /* The number of inner shell cross sections and yields allocated */
 
 
-#define NBBJUMPS         100    /* Maximum number of Macro Atom bound-bound jumps from any one configuration (SS) */
-
-#define NBFJUMPS         100    /* Maximum number of Macro Atom Bound-free jumps from any one configuration (SS) */
-
 #define MAXJUMPS          1000000 /* The maximum number of Macro Atom jumps before emission (if this is exceeded
                                      it gives up (SS) */
+#define TABLE_SIZE_INIT 256       /* The initial number of entries allocated for the tables which grow as data is read */
+
 #define NAUGER 2                /*Maximum number of "auger" processes */
 int nauger;                     /*Actual number of innershell edges for which autoionization is to be computed */
 
@@ -108,34 +111,29 @@ typedef struct elements
 ele_dummy, *ElemPtr;
 
 ElemPtr ele;
+int elz[ZMAX + 1];              /* Index into ele of each atomic number, or -1 */
 
 double rho2nh;                  /* The conversion constant from rho to nh the total number of H atoms */
 
-/* Note that ion is the basic structure.  It is filled from 0 up to nions.  *ionzi is a set of pointers which 
-   can be accessed via z and i (the ionization state).  But it is important to know that the pointer is really
-   not pointed at foo_ion */
+/* Note that ion is the basic structure.  It is filled from 0 up to nions.  ionzi is a table of indexes into
+   ions which can be accessed via z and i (the ionization state), with -1 for ions which are not in the data.
+   Use ion_index() rather than accessing ionzi directly */
 
 
 typedef struct ions
 {
-  int z;                        /* defines the element for this ion */
-  int istate;                   /* 1=neutral, 2 = once ionized, etc. */
-  int nelem;                    /* index to elements structure */
   double ip;                    /* ionization potential of this ion (converted from eV to ergs by get_atomic) */
   double g;                     /* multiplicity of ground state, note that this is not totally consistent
                                    with energy levels and this needs to be reconciled */
-  int nmax;                     /* The maximum number of allowed lte configurations for this ion. 
-                                   Used only by get_atomic */
-  int n_lte_max;                /* The maximum number of allowed nlte configurations for this ion. 
-                                   Used only by get_atomic */
+  int z;                        /* defines the element for this ion */
+  int istate;                   /* 1=neutral, 2 = once ionized, etc. */
+  int nelem;                    /* index to elements structure */
   int firstlevel;               /* Index into config struc; should also refer to ground state for this ion */
   int nlevels;                  /* Actual number of "lte" levels for this ion. "lte" here refers to any level 
                                    in which densities are to be calculated on the fly, instead of the beginning 
                                    or end of an ionization cycle */
   int first_nlte_level;         /* Index into config structure for the nlte_levels. There will be nlte 
                                    levels associated with this ion */
-  int first_levden;             /* Index into the levden array in wind structure, not necessairly 
-                                   the same as first_nlte_level  (Name changed 080810 -- 62 */
   int nlte;                     /* Actual number of nlte levels for this ion */
   int phot_info;                /*-1 means there are no photoionization cross sections for this ion, 
 				                           0  means the photoionization is given on an ion basis (e.g. for the
@@ -149,11 +147,6 @@ typedef struct ions
                                    set to 0 if macro atom method is not used  (SS) for this ion (ksl)
                                    Note: program will exit if -1 before leaving get_atomicdata
                                  */
-  int ntop_first;               /* Internal index into topbase photionization structure */
-  int ntop_ground;              /* NSH 03/12 Index to the ground state topbase photoionization state */
-  int ntop;                     /* Number of topbase photoionization cross sections for this ion */
-  int nxphot;                   /* Internal index into VFKY photionionization structure.  There
-                                   is only one of these per ion */
   int lev_type;                 /* The type of configurations used to descibe this ion 
                                    set to -1 initially (means not known)
                                    set to  0 if Kurucz (Note ultimately this may be treated similarly
@@ -163,6 +156,26 @@ typedef struct ions
                                    set to  2 if topbase inputs, even if their ar no so-called non-lte
                                    levels, i.e. levels in the levden array
                                  */
+  int ntop;                     /* Number of topbase photoionization cross sections for this ion */
+}
+ion_dummy, *IonPtr;
+
+/* The links from each ion into the other tables, which are only followed while the data is read in.  These are kept
+   apart from ions, in ion_links[nion], so that a scan over ions only has to load the fields which are used to query
+   the data.  Use ion_link() to get the links for an ion */
+
+typedef struct ion_links
+{
+  int nmax;                     /* The maximum number of allowed lte configurations for this ion. 
+                                   Used only by get_atomic */
+  int n_lte_max;                /* The maximum number of allowed nlte configurations for this ion. 
+                                   Used only by get_atomic */
+  int first_levden;             /* Index into the levden array in wind structure, not necessairly 
+                                   the same as first_nlte_level  (Name changed 080810 -- 62 */
+  int ntop_first;               /* Internal index into topbase photionization structure */
+  int ntop_ground;              /* NSH 03/12 Index to the ground state topbase photoionization state */
+  int nxphot;                   /* Internal index into VFKY photionionization structure.  There
+                                   is only one of these per ion */
   int drflag;                   /* The number of dielectronic recombination parameter types read in. 0
                                    probably means it has no data. 2 is good, 3 or 1 means an error has taken
                                    place - this is trapped in get_atomicdata.c */
@@ -184,11 +197,12 @@ typedef struct ions
   int nxderedi;                 /* index into the dere direct ionization structure to give the location of the data for this ion */
   int nxinner[N_INNER];         /*index to each of the inner shell cross sections associtated with this ion */
   int n_inner;                  /*The number of inner shell cross section associated with this ion */
-
 }
-ion_dummy, *IonPtr;
+ion_links_dummy, *IonLinksPtr;
 
 IonPtr ions;
+IonLinksPtr ion_links;
+int ionzi[ZMAX + 1][ZMAX + 2];  /* Index into ions of each z and istate, or -1 */
 
 
 /* And now for the arrays which describe the energy levels.  In the Topbase data, g is float (although
@@ -197,6 +211,23 @@ an integer everywhere else in the code....but this is something to watch ??? */
 
 /* The number of configurations is given by nlevels */
 
+/* The kinds of Macro Atom jump which a configuration can have. The jumps of every configuration are stored in
+   compressed sparse row form, one array for each kind, so there is no limit on the number of jumps and configurations
+   without any jumps do not take up any room. The jumps of one configuration are found with config_jumps() */
+
+typedef enum macro_jump
+{
+  JUMP_BB_UP,                   /* Upwards bb jumps, indices into line */
+  JUMP_BB_DOWN,                 /* Downwards bb jumps, indices into line */
+  JUMP_BF_UP,                   /* Upwards bf jumps, indices into phot_top */
+  JUMP_BF_DOWN,                 /* Downwards bf jumps, indices into phot_top */
+  NMACRO_JUMPS
+}
+MacroJump;
+
+int *macro_jumps[NMACRO_JUMPS]; /* The jumps of every configuration, grouped by configuration */
+int nmacro_jumps[NMACRO_JUMPS]; /* The total number of jumps of each kind */
+
 typedef struct configurations
 {
   int z;                        /*The element associated with this configuration */
@@ -217,10 +248,7 @@ typedef struct configurations
   double q_num;                 /* principal quantum number.  In Topbase this has non-integer values */
   double ex;                    /*excitation energy of level */
   double rad_rate;              /* Total spontaneous radiative de-excitation rate for level */
-  int bbu_jump[NBBJUMPS];       /* list of upwards bb jumps from this configuration (SS) */
-  int bbd_jump[NBBJUMPS];       /* list of downwards bb jumps from this configuration (SS) */
-  int bfu_jump[NBFJUMPS];       /* list of upwards bf jumps from this configuration (SS) */
-  int bfd_jump[NBFJUMPS];       /* list of downwards bf jumps from this configuration (SS) */
+  int jump_start[NMACRO_JUMPS]; /* Where the jumps of each kind from this configuration start in macro_jumps */
   int bbu_indx_first;           /* index to first MC estimator for bb jumps from this configuration (SS) */
   int bfu_indx_first;           /* index to first MC estimator for bf jumps from this configuration (SS) */
   int bfd_indx_first;           /* index to first rate for downward bf jumps from this configuration (SS) */
@@ -238,9 +266,13 @@ ConfigPtr config;
 
 typedef struct lines
 {
-  int nion;                     /*The ion no (in python) of the transition */
-  int z, istate;                /*element and ion associated with the line */
+  double freq;                  /* The frequency of the resonance line */
+  double f;                     /*oscillator strength.  Note: it might be better to keep PI_E2_OVER_MEC flambda times this.
+                                   Could do that by initializing */
   double gl, gu;                /*multiplicity of lower and upper level respectively */
+  double el, eu;                /* The energy of the lower and upper levels for the transition */
+  int z, istate;                /*element and ion associated with the line */
+  int nion;                     /*The ion no (in python) of the transition */
   int nconfigl, nconfigu;       /*The configuration no (in python) of the transition */
   int levl, levu;               /*level no of transition..parallel/redundant with el,eu hopefully */
   int macro_info;               /* Identifies whether line is to be treated using a Macro Atom approach.
@@ -249,10 +281,15 @@ typedef struct lines
                                    set to 1 if a macro atom line  (ksl 04 apr)
                                    Note: program will exit if -1 before leaving get_atomicdata
                                  */
-  double freq;                  /* The frequency of the resonance line */
-  double f;                     /*oscillator strength.  Note: it might be better to keep PI_E2_OVER_MEC flambda times this.
-                                   Could do that by initializing */
-  double el, eu;                /* The energy of the lower and upper levels for the transition */
+}
+line_dummy, *LinePtr;
+
+/* The parts of each line which are only needed while the data is read in, or by the macro atom and collision
+   routines, are kept apart from line in line_links, with line_links[n] belonging to line[n].  Use line_link() to get
+   them for a line */
+
+typedef struct line_links
+{
   double pow;                   /*The power in the lines as last calculated in total_line_emission */
   int where_in_list;            /* Position of line in the line list: i.e. lin_ptr[line[n].where_in_list] points
                                    to the line. Added by SS for use in macro atom method. */
@@ -262,16 +299,37 @@ typedef struct lines
                                    configuration (nconfigl) and then up_index. (SS) */
   int up_index;
   int coll_index;               /* A link into the collision strength data, if its -999 it means there is no data and van reg should be used */
-
 }
-line_dummy, *LinePtr;
+line_links_dummy, *LineLinksPtr;
 
 
-LinePtr line, lin_ptr[NLINES];  /* line[] is the actual structure array that contains all the data, *lin_ptr
+LinePtr line, *lin_ptr;        /* line[] is the actual structure array that contains all the data, *lin_ptr
                                    is an array which contains a frequency ordered set of ptrs to line */
                                 /* fast_line (added by SS August 05) is going to be a hypothetical
                                    rapid transition used in the macro atoms to stabilise level populations */
 struct lines fast_line;
+LineLinksPtr line_links;
+
+/* line_columns is a copy of the frequency ordered line list, with each quantity stored in its own contiguous column,
+   so that the whole line list can be searched without following lin_ptr into the line structure.  Entry i of each
+   column is for the line lin_ptr[i].  The columns are built once the lines have been indexed by build_line_columns */
+
+typedef struct line_columns
+{
+  int nlines;                   /* The number of lines in each column */
+  double *freq;                 /* The frequency of the line */
+  double *wavelength;           /* The wavelength of the line in Angstroms */
+  double *f;                    /* The oscillator strength */
+  double *gl, *gu;              /* The multiplicity of the lower and upper level */
+  int *z, *istate;              /* The element and ion of the line */
+  int *nion;                    /* The ion number of the line */
+  int *levl, *levu;             /* The lower and upper level numbers */
+  int *macro_info;              /* Whether the line is a macro atom line */
+  void *block;                  /* The single allocation which all of the columns are in */
+}
+LineColumns;
+
+LineColumns line_columns;
 
 int nline_min, nline_max, nline_delt; /* Used to select a range of lines in a frequency band from the lin_ptr array 
                                          in situations where the frequency range of interest is limited, including for defining which
@@ -280,6 +338,122 @@ int nline_min, nline_max, nline_delt; /* Used to select a range of lines in a fr
                                          routine limit_lines.
                                        */
 
+/* LineRange is a range of lines in the frequency ordered line list, as found by find_line_range.  The lines in the
+   range are lin_ptr[first] up to but not including lin_ptr[end], so the range is empty when first == end */
+
+typedef struct line_range
+{
+  int first;                    /* The first line in the range */
+  int end;                      /* One past the last line in the range */
+}
+LineRange;
+
+/* The kinds of frequency ordered list which have posting lists for each element and ion.  A posting list is the
+   positions, in frequency order, of the entries in lin_ptr, phot_top_ptr or inner_cross_ptr which belong to one
+   element or ion, and they are built once the atomic data is in frequency order by build_posting_lists */
+
+typedef enum posting_kind
+{
+  POSTING_LINES,                /* Positions in lin_ptr and line_columns */
+  POSTING_PHOT,                 /* Positions in phot_top_ptr */
+  POSTING_INNER,                /* Positions in inner_cross_ptr */
+  NPOSTING_KINDS
+}
+PostingKind;
+
+/* The transitions which are linked to each level by build_level_links, and which list of the frequency ordered
+   data they are positions in */
+
+typedef enum level_link
+{
+  LEVEL_LINES_UP,               /* Lines with the level as the lower level, positions in lin_ptr */
+  LEVEL_LINES_DOWN,             /* Lines with the level as the upper level, positions in lin_ptr */
+  LEVEL_PHOT_FROM,              /* Photoionization from the level, positions in phot_top_ptr */
+  LEVEL_PHOT_TO,                /* Photoionization into the level from the ion below, positions in phot_top_ptr */
+  LEVEL_INNER_FROM,             /* Inner shell ionization from the level, positions in inner_cross_ptr */
+  NLEVEL_LINKS
+}
+LevelLink;
+
+/* The frequency ordered lists of photoionization cross sections which have an index of the frequency range each
+   cross section covers, as built by build_coverage_index */
+
+typedef enum xsection_list
+{
+  XSECTION_PHOT,                /* phot_top_ptr */
+  XSECTION_INNER,               /* inner_cross_ptr */
+  NXSECTION_LISTS
+}
+XsectionList;
+
+/* The measures of line strength which the strongest lines in a frequency range can be found by */
+
+typedef enum line_strength
+{
+  STRENGTH_GF,                  /* gl * f */
+  STRENGTH_A21,                 /* The Einstein A coefficient */
+  NSTRENGTHS
+}
+LineStrength;
+
+/* SpeciesStats are totals over the lines and edges of one element or ion, which are computed once from the posting
+   lists by build_species_stats, so that they do not have to be counted again each time they are looked at */
+
+typedef struct species_stats
+{
+  int nlines;                   /* The number of lines */
+  int nmacro, nsimple;          /* The number of macro atom and simple lines */
+  int ncoll;                    /* The number of lines with a collision strength */
+  int nphot;                    /* The number of photoionization edges */
+  int ninner;                   /* The number of inner shell edges */
+  double wmin, wmax;            /* The wavelength range of the lines in Angstroms */
+  double gf_sum;                /* The sum of gl * f over the lines */
+  int strongest;                /* The position in lin_ptr of the line with the largest gl * f, or -1 if no lines */
+}
+SpeciesStats;
+
+/* The orders which a table of SpeciesStats can be sorted into.  Apart from STATS_BY_INDEX, the largest come first */
+
+typedef enum stats_order
+{
+  STATS_BY_INDEX,               /* The order of ele or ions */
+  STATS_BY_LINES,               /* The number of lines */
+  STATS_BY_GF,                  /* The sum of gf */
+  STATS_BY_MACRO,               /* The number of macro atom lines */
+  STATS_BY_COLL,                /* The number of lines with a collision strength */
+  STATS_BY_EDGES,               /* The number of photoionization and inner shell edges */
+  NSTATS_ORDERS
+}
+StatsOrder;
+
+/* A spectral window is a wavelength range, optionally widened by a velocity, for which the lines and photoionization
+   edges inside it are found by find_window_ranges.  The edges are ranges in phot_top_ptr and inner_cross_ptr, using
+   the same first and end convention as the lines */
+
+typedef struct spectral_window
+{
+  double wmin, wmax;            /* The wavelength range in Angstroms */
+  double velocity;              /* The velocity in km/s by which the range is widened at each end */
+  double freqmin, freqmax;      /* The frequency range after it has been widened */
+  LineRange lines;              /* The lines in lin_ptr within the window */
+  LineRange phot;               /* The photoionization edges in phot_top_ptr within the window */
+  LineRange inner;              /* The inner shell edges in inner_cross_ptr within the window */
+}
+SpectralWindow;
+
+/* MemoryTable is the memory taken by one of the atomic data tables, or one of the indices built over them, in bytes.
+   reserved is what has been allocated or set aside statically, used is the part which holds data and touched is the
+   part which is resident in memory.  They are filled by account_memory in memory.c */
+
+typedef struct memory_table
+{
+  const char *name;             /* The name of the table */
+  size_t reserved;              /* The bytes allocated */
+  size_t used;                  /* The bytes holding data */
+  size_t touched;               /* The bytes resident in memory */
+}
+MemoryTable;
+
 
         /* coll_stren is the collision strength interpolation data extracted from Chianti */
 
@@ -302,7 +476,8 @@ typedef struct coll_stren
   double scups[N_COLL_STREN_PTS]; //The sclaed coll sttengths in ythe fit.
 } Coll_stren, *Coll_strenptr;
 
-Coll_stren coll_stren[NLINES];  //Set up the structure - we could in principle have as many of these as we have lines
+Coll_stren *coll_stren;         //Set up the structure - we could in principle have as many of these as we have lines
+int n_coll_stren_max;           //The number of collision strengths allocated
 
 
 
@@ -312,8 +487,7 @@ int nxphot;                     /*The actual number of ions for which there are
 double phot_freq_min;           /*The lowest frequency for which photoionization can occur */
 double inner_freq_min;          /*The lowest frequency for which inner shel ionization can take place */
 
-#define NCROSS 1500
-#define NTOP_PHOT 400           /* Maximum number of photoionisation processes. (SS) */
+#define NCROSS 1500             /* Maximum number of points in a single x-section */
 int ntop_phot;                  /* The actual number of TopBase photoionzation x-sections */
 int nphot_total;                /* total number of photoionzation x-sections = nxphot + ntop_phot */
 
@@ -344,14 +518,28 @@ typedef struct topbase_phot
                                    configuration (nlev) and then up_index. (SS) */
   int up_index;
   int use;                      /* It we are to use this cross section. This allows unused VFKY cross sections to sit in the array. */
-  double freq[NCROSS], x[NCROSS];
+  int offset;                   /* The index of the first point of the x-section in xsection_freq and xsection_x */
+  double *freq, *x;             /* The points of the x-section, which point into xsection_freq and xsection_x */
+  short *packed;                /* If the x-section is stored compactly, the differences of its points after the
+                                   first, otherwise NULL.  See compact_xsections */
   double f, sigma;              /*last freq, last x-section */
 } Topbase_phot, *TopPhotPtr;
 
-Topbase_phot phot_top[NLEVELS];
-TopPhotPtr phot_top_ptr[NLEVELS]; /* Pointers to phot_top in threshold frequency order - this */
-Topbase_phot inner_cross[N_INNER * NIONS];
-TopPhotPtr inner_cross_ptr[N_INNER * NIONS];
+Topbase_phot *phot_top;
+TopPhotPtr *phot_top_ptr;       /* Pointers to phot_top in threshold frequency order - this */
+int nphot_max;                  /* The number of photoionization x-sections allocated */
+Topbase_phot *inner_cross;
+TopPhotPtr *inner_cross_ptr;    /* Pointers to inner_cross in threshold frequency order */
+
+/* The points of all of the photoionization and inner shell x-sections are stored contiguously in these pools,
+   with each x-section using np points starting at its offset. The first point is a sentinel of -1, which is
+   where x-sections without any points are left pointing */
+
+#define XSECTION_POINTS_INIT 4096
+double *xsection_freq;
+double *xsection_x;
+int nxsection_points;           /* The number of points used in the pools */
+int nxsection_points_max;       /* The number of points allocated for the pools */
 
 
 
@@ -393,7 +581,7 @@ typedef struct inner_elec_yield
   double Ea;                    /*Average electron energy */
 } Inner_elec_yield, Inner_elec_yieldPtr;
 
-Inner_elec_yield inner_elec_yield[N_INNER * NIONS];
+Inner_elec_yield *inner_elec_yield; /* Allocated with inner_cross */
 
 /* This structure is for the flourescent photon yield following inner shell ionization from Kaastra and Mewe*/
 typedef struct inner_fluor_yield
@@ -405,7 +593,7 @@ typedef struct inner_fluor_yield
   double yield;                 /*number of photons per ionization */
 } Inner_fluor_yield, Inner_fluor_yieldPtr;
 
-Inner_fluor_yield inner_fluor_yield[N_INNER * NIONS];
+Inner_fluor_yield *inner_fluor_yield; /* Allocated with inner_cross */
 
 
 
@@ -420,7 +608,7 @@ struct ground_fracs
                                    and then we go in steps of 5000 to ground_frac[19] which is for t=1e5. these
                                    fractions must have been computed elsewhere */
 }
-ground_frac[NIONS];
+ *ground_frac;                  /* One for each ion, allocated with ions */
 
 
 //081115 nsh New structure and variables to hold the dielectronic recombination rate data
@@ -430,6 +618,7 @@ ground_frac[NIONS];
 #define DRTYPE_BADNELL	    0
 #define DRTYPE_SHULL	    1
 int ndrecomb;                   //This is the actual number of DR parameters
+int ndrecomb_max;               /* The number of DR parameter sets allocated */
 
 typedef struct dielectronic_recombination
 {
@@ -442,7 +631,7 @@ typedef struct dielectronic_recombination
 } Drecomb, *Drecombptr;
 
 
-Drecomb drecomb[NIONS];         //set up the actual structure
+Drecomb *drecomb;               //set up the actual structure
 
 double dr_coeffs[NIONS];        //this will be an array to temprarily store the volumetric dielectronic recombination rate coefficients for the current cell under interest. We may want to make this 2D and store the coefficients for a range of temperatures to interpolate.
 
@@ -451,6 +640,7 @@ double dr_coeffs[NIONS];        //this will be an array to temprarily store the
 #define RRTYPE_BADNELL	    0
 #define RRTYPE_SHULL	    1
 int n_total_rr;
+int n_total_rr_max;             /* The number of total RR rates allocated */
 typedef struct total_rr
 {
   int nion;                     //Internal cross reference to the ion that this refers to
@@ -460,10 +650,11 @@ typedef struct total_rr
   int type;                     /* NSH 23/7/2012 - What type of parampeters we have for this ion */
 } Total_rr, *total_rrptr;
 
-Total_rr total_rr[NIONS];       //Set up the structure
+Total_rr *total_rr;             //Set up the structure
 
 #define BAD_GS_RR_PARAMS 19     //This is the number of points in the fit.
 int n_bad_gs_rr;
+int n_bad_gs_rr_max;            /* The number of ground state RR rates allocated */
 typedef struct badnell_gs_rr
 {
   int nion;                     //Internal cross reference to the ion that this refers to
@@ -471,11 +662,12 @@ typedef struct badnell_gs_rr
   double rates[BAD_GS_RR_PARAMS]; //rates corresponding to those temperatures
 } Bad_gs_rr, *Bad_gs_rrptr;
 
-Bad_gs_rr bad_gs_rr[NIONS];     //Set up the structure
+Bad_gs_rr *bad_gs_rr;           //Set up the structure
 
 
 #define DERE_DI_PARAMS 20       //This is the maximum number of points in the fit.
 int n_dere_di_rate;
+int n_dere_di_rate_max;         /* The number of Dere DI rates allocated */
 typedef struct dere_di_rate
 {
   int nion;                     //Internal cross reference to the ion that this refers to
@@ -486,7 +678,7 @@ typedef struct dere_di_rate
   double min_temp;
 } Dere_di_rate, *Dere_di_rateptr;
 
-Dere_di_rate dere_di_rate[NIONS]; //Set up the structure
+Dere_di_rate *dere_di_rate;     //Set up the structure
 
 double di_coeffs[NIONS];        //This is an array to store the di_coeffs 
 double qrecomb_coeffs[NIONS];   //JM 1508 analogous array for three body recombination 
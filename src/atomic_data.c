@@ -15,6 +15,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include "atomix.h"
 
@@ -220,7 +222,7 @@ linterp(x, xarray, yarray, xdim, y, mode)
  * @brief      Index the topbase photoionzation crossections by frequency
  *
  *
- * @return     Always returns 0
+ * @return     EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
  *
  * @details
  *
@@ -233,42 +235,34 @@ linterp(x, xarray, yarray, xdim, y, mode)
  **********************************************************/
 
 int
-index_phot_top()
+index_phot_top(void)
 {
-  float *freqs, foo;
-  int *index, ioo;
-  int n;
-  void indexx();
+  double *freqs;
+  int *index;
+  int n, error;
 
-  /* Allocate memory for some modestly large arrays */
-  freqs = calloc(sizeof(foo), ntop_phot + nxphot + 2);
-  index = calloc(sizeof(ioo), ntop_phot + nxphot + 2);
+  freqs = malloc((ntop_phot + nxphot + 1) * sizeof(double));
+  index = malloc((ntop_phot + nxphot + 1) * sizeof(int));
 
-  freqs[0] = 0;
-  for(n = 0; n < ntop_phot + nxphot; n++)
-    freqs[n + 1] = phot_top[n].freq[0]; /* So filled matrix
-                                           elements run from 1 to ntop_phot */
-
-  indexx(ntop_phot + nxphot, freqs, index); /* Note that this math recipes routine
-                                               expects arrays to run from 1 to nlines inclusive */
+  error = freqs == NULL || index == NULL;
+  if(!error)
+  {
+    for(n = 0; n < ntop_phot + nxphot; n++)
+      freqs[n] = phot_top[n].freq[0];
 
-  /* The for loop indices are complicated by the numerical recipes routine,
-     which is a simple translation of a fortran routine.
-     Specifically, index array elements 1 to nlines are now filled,
-     and the numbers run from 1 to nlines, but the
-     pointer array is only filled from elements 0 to nlines -1 */
+    error = sort_by_key(ntop_phot + nxphot, freqs, index);
+  }
 
-  for(n = 0; n < ntop_phot + nxphot; n++)
+  if(!error)
   {
-    phot_top_ptr[n] = &phot_top[index[n + 1] - 1];
+    for(n = 0; n < ntop_phot + nxphot; n++)
+      phot_top_ptr[n] = &phot_top[index[n]];
   }
 
-  /* Free the memory for the arrays */
   free(freqs);
   free(index);
 
-  return (0);
-
+  return error ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 
@@ -276,130 +270,101 @@ index_phot_top()
 /**
  * @brief      Index inner shell xsections in frequency order
  *
- * @return     Alwasy returns 0
+ * @return     EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
  *
  * @details
  * The rusults are stored in inner_cross_ptr
  *
- * ### Notes ###
- * ??? NOTES ???
- *
  **********************************************************/
 
 int
-index_inner_cross()
+index_inner_cross(void)
 {
-  float *freqs, foo;
-  int *index, ioo;
-  int n;
-  void indexx();
+  double *freqs;
+  int *index;
+  int n, error;
 
-  /* Allocate memory for some modestly large arrays */
-  freqs = calloc(sizeof(foo), n_inner_tot + 2);
-  index = calloc(sizeof(ioo), n_inner_tot + 2);
+  freqs = malloc((n_inner_tot + 1) * sizeof(double));
+  index = malloc((n_inner_tot + 1) * sizeof(int));
 
-  freqs[0] = 0;
-  for(n = 0; n < n_inner_tot; n++)
-    freqs[n + 1] = inner_cross[n].freq[0];  /* So filled matrix
-                                               elements run from 1 to ntop_phot */
-
-  indexx(n_inner_tot, freqs, index);  /* Note that this math recipes routine
-                                         expects arrays to run from 1 to nlines inclusive */
+  error = freqs == NULL || index == NULL;
+  if(!error)
+  {
+    for(n = 0; n < n_inner_tot; n++)
+      freqs[n] = inner_cross[n].freq[0];
 
-  /* The for loop indices are complicated by the numerical recipes routine,
-     which is a simple translation of a fortran routine.
-     Specifically, index array elements 1 to nlines are now filled,
-     and the numbers run from 1 to nlines, but the
-     pointer array is only filled from elements 0 to nlines -1 */
+    error = sort_by_key(n_inner_tot, freqs, index);
+  }
 
-  for(n = 0; n < n_inner_tot; n++)
+  if(!error)
   {
-    inner_cross_ptr[n] = &inner_cross[index[n + 1] - 1];
+    for(n = 0; n < n_inner_tot; n++)
+      inner_cross_ptr[n] = &inner_cross[index[n]];
   }
 
-  /* Free the memory for the arrays */
   free(freqs);
   free(index);
 
-  return (0);
-
+  return error ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
-
-/* Numerical recipes routine used by index_lines which in turn is used by get_atomic_data */
-
-
-/**********************************************************/
+/* ************************************************************************** */
 /**
- * @brief      Numerical recipes routine used by various routines to sort the atomic data
+ * @brief  Build the frequency ordered indexes of the lines and x-sections.
  *
- * @param [in] int  n   The dimension of the array that needs sorting
- * @param [in] float  arrin[]   The array to sort
- * @param [out] int  indx[]   The array that contains poionters to the sorted array
- * @return     N/A
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
  *
  * @details
  *
- * ### Notes ###
- * See nuerical recipes
- *
- * @bug Should probably replaces this with the equivalent gsl routine
+ * The three indexes do not depend on each other, so the x-sections are indexed
+ * on their own threads while the lines are indexed on this one. If a thread
+ * can not be created, the index is built on this thread instead.
  *
- **********************************************************/
+ * ************************************************************************** */
 
-void
-indexx(n, arrin, indx)
-     int n, indx[];
-     float arrin[];
+typedef struct IndexJob_t
 {
-  int l, j, ir, indxt, i;
-  float q;
-/* NSH 1408 - This routine fails in the very odd circumstance that n=1 so we now do a little test here */
-  if(n < 2)
-  {
-    logfile("Nothing for indexx to do! Only one element\n");
-    indx[0] = 0;
-    indx[1] = 1;                /* NSH 1707 - We still need to populate the array */
-    return;
-  }
+  int (*index)(void);
+  int error;
+} IndexJob_t;
+
+static void *
+index_worker(void *arg)
+{
+  IndexJob_t *job = arg;
+
+  job->error = job->index();
+
+  return NULL;
+}
+
+int
+index_frequency_order(void)
+{
+  int i;
+  int started[3];
+  pthread_t threads[3];
+  IndexJob_t jobs[3] = {
+    {index_lines, EXIT_SUCCESS},
+    {index_phot_top, EXIT_SUCCESS},
+    {index_inner_cross, EXIT_SUCCESS},
+  };
+
+  for(i = 1; i < 3; ++i)
+    started[i] = pthread_create(&threads[i], NULL, index_worker, &jobs[i]) == 0;
 
-  for(j = 1; j <= n; j++)
-    indx[j] = j;
-  l = (n >> 1) + 1;
-  ir = n;
-  for(;;)
+  index_worker(&jobs[0]);
+
+  for(i = 1; i < 3; ++i)
   {
-    if(l > 1)
-      q = arrin[(indxt = indx[--l])];
+    if(started[i])
+      pthread_join(threads[i], NULL);
     else
-    {
-      q = arrin[(indxt = indx[ir])];
-      indx[ir] = indx[1];
-      if(--ir == 1)
-      {
-        indx[1] = indxt;
-        return;
-      }
-    }
-    i = l;
-    j = l << 1;
-    while(j <= ir)
-    {
-      if(j < ir && arrin[indx[j]] < arrin[indx[j + 1]])
-        j++;
-      if(q < arrin[indx[j]])
-      {
-        indx[i] = indx[j];
-        j += (i = j);
-      }
-      else
-        j = ir + 1;
-    }
-    indx[i] = indxt;
+      index_worker(&jobs[i]);
   }
-}
-
 
+  return jobs[0].error || jobs[1].error || jobs[2].error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
 
 
 /**********************************************************/
@@ -439,6 +404,9 @@ indexx(n, arrin, indx)
  * 	is in range.  This is because depending on how the velocity is trending you may
  * 	want to sum from the highest frequency line to the lowest.
  *
+ * 	The limits are found with find_line_range, which should be used instead in new code
+ * 	as it returns the range rather than setting global variables.
+ *
  *
  **********************************************************/
 
@@ -446,12 +414,9 @@ int
 limit_lines(freqmin, freqmax)
      double freqmin, freqmax;
 {
+  LineRange range;
 
-  int nmin, nmax, n;
-  double f;
-
-
-  if(freqmin > lin_ptr[nlines - 1]->freq || freqmax < lin_ptr[0]->freq)
+  if(nlines == 0 || freqmin > lin_ptr[nlines - 1]->freq || freqmax < lin_ptr[0]->freq)
   {
     nline_min = 0;
     nline_max = 0;
@@ -459,39 +424,11 @@ limit_lines(freqmin, freqmax)
     return (0);
   }
 
-  f = freqmin;
-
-  nmin = 0;
-  nmax = nlines - 1;
-  n = (nmin + nmax) >> 1;       // Compute a midpoint >> is a bitwise right shift
-
-  while(n != nmin)
-  {
-    if(lin_ptr[n]->freq < f)
-      nmin = n;
-    if(lin_ptr[n]->freq >= f)
-      nmax = n;
-    n = (nmin + nmax) >> 1;     // Compute a midpoint >> is a bitwise right shift
-  }
-
-  nline_min = nmin;
-
-  f = freqmax;
-  nmin = 0;
-  nmax = nlines - 1;
-  n = (nmin + nmax) >> 1;       // Compute a midpoint >> is a bitwise right shift
-
-  while(n != nmin)
-  {
-    if(lin_ptr[n]->freq <= f)
-      nmin = n;
-    if(lin_ptr[n]->freq > f)
-      nmax = n;
-    n = (nmin + nmax) >> 1;     // Compute a midpoint >> is a bitwise right shift
-  }
-
-  nline_max = nmax;
+  /* The limits are one line outside of the range, unless the range runs off the end of the line list */
 
+  range = find_line_range(freqmin, freqmax);
+  nline_min = range.first > 0 ? range.first - 1 : 0;
+  nline_max = range.end < nlines ? range.end : nlines - 1;
 
   return (nline_delt = nline_max - nline_min + 1);
 }
@@ -525,14 +462,14 @@ check_xsections()
     if(ions[nion].phot_info == 1)
       logfile_error
         ("Topbase Ion %i Z %i istate %i nground %i ilv %i ntop %i f0 %8.4e IP %8.4e\n",
-         nion, ions[nion].z, ions[nion].istate, ions[nion].ntop_ground, phot_top[n].nlev, ions[nion].ntop,
+         nion, ions[nion].z, ions[nion].istate, ion_links[nion].ntop_ground, phot_top[n].nlev, ions[nion].ntop,
          phot_top[n].freq[0], ions[nion].ip);
     else if(ions[nion].phot_info == 0)
       logfile_error("Vfky Ion %i Z %i istate %i nground %i f0 %8.4e IP %8.4e\n",
-                    nion, ions[nion].z, ions[nion].istate, ions[nion].nxphot, phot_top[n].freq[0], ions[nion].ip);
+                    nion, ions[nion].z, ions[nion].istate, ion_links[nion].nxphot, phot_top[n].freq[0], ions[nion].ip);
 
     /* some simple checks -- could be made more robust */
-    if(ions[nion].n_lte_max == 0 && ions[nion].phot_info == 1)
+    if(ion_links[nion].n_lte_max == 0 && ions[nion].phot_info == 1)
     {
       logfile
         ("get_atomicdata: not tracking levels for ion %i z %i istate %i, yet marked as topbase xsection!\n",
@@ -629,13 +566,13 @@ q21 (struct lines *line_ptr, double t)
 
 
 
-    if (line_ptr->coll_index < 0)       //if we do not have a collision strength for this line use the g-bar formulation
+    if (line_link (line_ptr)->coll_index < 0)   //if we do not have a collision strength for this line use the g-bar formulation
     {
       omega = ECS_CONSTANT * line_ptr->gl * gaunt * line_ptr->f / line_ptr->freq;
     }
     else                        //otherwise use the collision strength directly. NB what we call omega, most people including hazy call upsilon.
     {
-      omega = upsilon (line_ptr->coll_index, u0);
+      omega = upsilon (line_link (line_ptr)->coll_index, u0);
     }
 
 
@@ -801,262 +738,1321 @@ upsilon(n_coll, u0)
 /**
  * @brief      sort the lines into frequency order
  *
- * @return     Always returns 0
+ * @return     EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
  *
  * @details
  *
  * ### Notes ###
- * All use a Numerical recipes routine indexx for this
+ * The sort is stable, so lines with the same frequency stay in the order
+ * they were read in
  *
  **********************************************************/
 
 int
-index_lines()
+index_lines(void)
 {
-  float *freqs, foo;
-  int *index, ioo;
-  int n;
-  void indexx();
+  double *freqs;
+  int *index;
+  int n, error;
 
-  /* Allocate memory for some modestly large arrays */
-  freqs = calloc(sizeof(foo), NLINES + 2);
-  index = calloc(sizeof(ioo), NLINES + 2);
+  freqs = malloc((nlines + 1) * sizeof(double));
+  index = malloc((nlines + 1) * sizeof(int));
 
-  freqs[0] = 0;
-  for(n = 0; n < nlines; n++)
-    freqs[n + 1] = line[n].freq;  /* So filled matrix
-                                     elements run from 1 to nlines */
-
-  indexx(nlines, freqs, index); /* Note that this math recipes routine
-                                   expects arrays to run from 1 to nlines inclusive */
+  error = freqs == NULL || index == NULL;
+  if(!error)
+  {
+    for(n = 0; n < nlines; n++)
+      freqs[n] = line[n].freq;
 
-  /* The for loop indices are complicated by the numerical recipes routine,
-     which is a simple translation of a fortran routine.
-     Specifically, index array elements 1 to nlines are now filled,
-     and the numbers run from 1 to nlines, but the
-     pointer array is only filled from elements 0 to nlines -1 */
+    error = sort_by_key(nlines, freqs, index);
+  }
 
   /* SS - adding quantity "where_in_list" to line structure so that it is easy to from emission
      in recombination line to correct place in line list. */
 
-
-  for(n = 0; n < nlines; n++)
+  if(!error)
   {
-    lin_ptr[n] = &line[index[n + 1] - 1];
-    line[index[n + 1] - 1].where_in_list = n;
+    for(n = 0; n < nlines; n++)
+    {
+      lin_ptr[n] = &line[index[n]];
+      line_links[index[n]].where_in_list = n;
+    }
   }
 
-  /* Free the memory for the arrays */
   free(freqs);
   free(index);
 
-  return (0);
+  return error ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
-/**********************************************************/
+/* ************************************************************************** */
 /**
- * @brief      generalized subroutine for reading atomic data
- *  	into a set of structures defined in "atomic.h"
- *
+ * @brief  Hash the (z, istate, levl, levu) key of a line, which is also used
+ *         for the (z, istate, ilv) key of a configuration with levu = 0.
  *
- * @param [in] char  masterfile[]   The name of the "masterfile" which refers to other files which contain the data
- * @return     Always returns 0
+ * @param[in]  z       The atomic number
+ * @param[in]  istate  The ionisation state
+ * @param[in]  levl    The lower level number
+ * @param[in]  levu    The upper level number
+ * @param[in]  bits    The number of bits in the hash
  *
- * @details
+ * @return  The hash of the key
  *
- * get_atomic_data reads in all the atomic data.  It also converts the data to cgs units unless
- * 	otherwise noted, e.g ionization potentials are converted to ergs.
+ * ************************************************************************** */
+
+static inline unsigned int
+hash_line_key(int z, int istate, int levl, int levu, int bits)
+{
+  uint64_t key;
+
+  key = (uint64_t) (uint32_t) z;
+  key = key * 0x9E3779B97F4A7C15ULL ^ (uint32_t) istate;
+  key = key * 0x9E3779B97F4A7C15ULL ^ (uint32_t) levl;
+  key = key * 0x9E3779B97F4A7C15ULL ^ (uint32_t) levu;
+  key *= 0x9E3779B97F4A7C15ULL;
+
+  return (unsigned int) (key >> (64 - bits));
+}
+
+/*
+ * The hash index of the lines used to match collision strengths to lines. The
+ * lines with the same hash are chained in line order through next, starting
+ * from head. nindexed is the number of lines which were indexed, so the index
+ * can be rebuilt if more lines are read in after it was built
+ */
+
+static int *line_key_head, *line_key_next;
+static int line_key_bits, line_key_nindexed;
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the hash index of the lines.
  *
+ * ************************************************************************** */
+
+static void
+free_line_key_index(void)
+{
+  free(line_key_head);
+  free(line_key_next);
+  line_key_head = line_key_next = NULL;
+  line_key_bits = line_key_nindexed = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build a hash index of the lines on (z, istate, levl, levu).
  *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
  *
- * The masterfile is a list of other files, which contain atomic data for specific puruposes.
+ * @details
  *
- * All of the files are ascii.  The information is keyword based.
+ * The table has at least twice as many buckets as there are lines. The lines
+ * are inserted backwards so that each chain is in line order, which means a
+ * lookup finds matching lines in the same order a search through line would.
  *
- * The order of the data is important.  Elements should be defined before ions; ions
- * before levels, levels before  lines etc.  In most if not all cases, one can either define all
- * of the elements first, all of the ions, etc ... or the first element and its ions, the
- * second element and its ions etc. Commenting out an element in the datafile has the effect of
- * eliminating all of the data associated with that element, e.g ions, lines, etc.
+ * ************************************************************************** */
+
+static int
+index_line_keys(void)
+{
+  int n, nbuckets;
+  unsigned int h;
+
+  free_line_key_index();
+
+  for(line_key_bits = 4; (1 << line_key_bits) < 2 * nlines; ++line_key_bits);
+  nbuckets = 1 << line_key_bits;
+
+  line_key_head = malloc(nbuckets * sizeof(int));
+  line_key_next = malloc((nlines + 1) * sizeof(int));
+  if(line_key_head == NULL || line_key_next == NULL)
+  {
+    free_line_key_index();
+    return EXIT_FAILURE;
+  }
+
+  for(n = 0; n < nbuckets; n++)
+    line_key_head[n] = -1;
+
+  for(n = nlines - 1; n >= 0; n--)
+  {
+    h = hash_line_key(line[n].z, line[n].istate, line[n].levl, line[n].levu, line_key_bits);
+    line_key_next[n] = line_key_head[h];
+    line_key_head[h] = n;
+  }
+
+  line_key_nindexed = nlines;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the line a collision strength record belongs to.
  *
- * The program assumes that the ions for a given element are grouped together,
- * that the levels for a given element are grouped together, etc.
+ * @param[in]   z       The atomic number
+ * @param[in]   istate  The ionisation state
+ * @param[in]   levl    The lower level number
+ * @param[in]   levu    The upper level number
+ * @param[in]   gl      The multiplicity of the lower level
+ * @param[in]   gu      The multiplicity of the upper level
+ * @param[in]   f       The oscillator strength
+ * @param[out]  nmatch  The number of lines which match
  *
- * If one wants to read both Topbase and VFKY photoionization x-sections, then the topbase
- * x-sections should be read first.  The routine will ignore data in the VFKY list if there
- * is a pre-existing Topbase data.  The routine will stop if you but a VFKY x-section first
- * on the assumption that Topbase data should trump VFKY data. (Making the program more flexible
- * would be difficult because you would have to drop various bits of Topbase data out of the
- * middle of the structure or mark it NG or something.)
+ * @return  The first line which matches, or -1 if there is no match
  *
- * Similarly, as a general rule the macro information should be provided before the simple
- * ions are described, and the macro lines should be presented before simple lines.
+ * @details
  *
- * The only data which can be mixed up completely is the line array.
+ * The index has to have been built with index_line_keys() since the last line
+ * was read in. The hash only covers (z, istate, levl, levu), so gl, gu and f
+ * are checked for each line in the chain.
  *
- * Finally, get_atomic_data creates a pointer array to  lines, which has the lines in
- * frequency ascending order.   This is actually done by a small subroutine index_lines
- * which in turn calls a Numerical Recipes routine.
+ * ************************************************************************** */
+
+static int
+find_coll_stren_line(int z, int istate, int levl, int levu, double gl, double gu, double f, int *nmatch)
+{
+  int n, first;
+
+  *nmatch = 0;
+  first = -1;
+  for(n = line_key_head[hash_line_key(z, istate, levl, levu, line_key_bits)]; n >= 0; n = line_key_next[n])
+  {
+    if(line[n].z == z && line[n].istate == istate && line[n].levl == levl && line[n].levu == levu &&
+       line[n].gl == gl && line[n].gu == gu && line[n].f == f)
+    {
+      if(first < 0)
+        first = n;
+      (*nmatch)++;
+    }
+  }
+
+  return first;
+}
+
+/*
+ * The hash index of the configurations on (z, istate, ilv), which is used to
+ * link lines and x-sections to their levels. Each level is added as it is read
+ * in, to the tail of the chain of its bucket, so each chain is in level order
+ */
+
+static int *config_key_head, *config_key_tail, *config_key_next;
+static int config_key_bits, config_key_nindexed;
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the hash index of the configurations.
  *
- * ### Notes ###
+ * ************************************************************************** */
+
+static void
+free_config_key_index(void)
+{
+  free(config_key_head);
+  free(config_key_tail);
+  free(config_key_next);
+  config_key_head = config_key_tail = config_key_next = NULL;
+  config_key_bits = config_key_nindexed = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add a configuration to the hash index of the configurations.
  *
- * get_atomic data is intended to be stand-alone, that is one should be able to use it for routines
- * other than Python, e.g for another routine intended to calculate the ionization state of
- * a plasma in collisional equilibrium.
+ * @param[in]  n  The configuration to add, which must be the next one after
+ *                those already in the index
  *
- * To this end, the routines populate stuctures in atomic.h, which are not part of python.h, and
- * one should avoid calling routines like Exit(0) that are very python centric.  It's important
- * that future modifications to get_atomic_data maintain this independence.
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
  *
+ * @details
  *
+ * The table is kept at least twice as large as the number of configurations.
+ * When it has to grow, it is rebuilt from scratch by adding all of the
+ * configurations again in order.
  *
- **********************************************************/
+ * ************************************************************************** */
 
-int
-get_atomic_data(char *masterfile, int use_relative)
+static int
+index_config_key(int n)
 {
-  int match;
-  FILE *fptr, *mptr;
-  char aline[LINELENGTH];
-  char file[LINELENGTH];
-
-  char word[LINELENGTH];
-  int n, m, i, j;
-  int n1, n2;                   //081115 nsh two new counters for DR - use new pointers to avoid any clashes!
-  int nparam;                   //081115 nsh temperary holder for number of DR parameters
-  double drp[MAX_DR_PARAMS];    //081115 nsh array to hold DR parameters prior to putting into structure
-  double btrr[T_RR_PARAMS];     //0712 nsh array to hole badnell total RR params before putting into structure
-  int ne, w;                    //081115 nsh new variables for DR variables
-  int mstart, mstop;
-  int nelem;
-  double gl, gu;
-  double el, eu;
-  int qnum;
-  double qqnum, ggg, gg;
-  int istate, z, nion;
-  int iistate, zz;
-  int levl, levu;
-  int in, il;                   //The levels used in inner shell data
-  double q;
-  double freq, f, exx, et, p;
-  double the_ground_frac[20];
-  char choice;
-  int lineno;                   /* the line number in the file beginning with 1 */
-  int simple_line_ignore[NIONS], cstren_no_line;
-  int nwords;
-  int nlte, nmax;
-  int mflag;                    //flag to identify reading data for macro atoms
-  int nconfigl, nconfigu;       //internal labels for configurations
-  int islp, ilv, np;
-  char configname[15];
-  double e, rl;
-  double xe[NCROSS], xx[NCROSS];
-  int nlines_simple;
-  int nspline;
-  double tmin;
-  int nions_simple, nions_macro;
-  int nlevels_simple;
-  int ntop_phot_simple, ntop_phot_macro;
-  int bb_max, bf_max;
-  int lev_type;
-  int nn;
-  double gstemp[BAD_GS_RR_PARAMS];  //Temporary storage for badnell resolved GS RR rates
-  double temp[LINELENGTH];      //Temporary storage for data read in off a line this is enogh if every character on the
-  char gsflag, drflag;          //Flags to say what part of data is being read in for DR and RR
-  double gstmin, gstmax;        //The range of temperatures for which all ions have GS RR rates
-  double gsqrdtemp, gfftemp, s1temp, s2temp, s3temp;  //Temporary storage for gaunt factors
-  int n_elec_yield_tot;         //The number of inner shell cross sections with matching electron yield arrays
-  int inner_no_e_yield;         //The number of inner shell cross sections with no yields
-  double I, Ea;                 //The ionization energy and mean electron energy for electron yields
-  int c_l, c_u;                 //Chianti level indicators
-  double en, gf, hlt, sp;       //Parameters in collision strangth file
-  int type;                     //used in collision strength
-
+  int i, nbuckets, nindexed;
+  unsigned int h;
 
-  /* define which files to read as data files */
+  if(config_key_head == NULL || 2 * (n + 1) > (1 << config_key_bits))
+  {
+    nindexed = n;
+    free_config_key_index();
 
+    for(config_key_bits = 8; (1 << config_key_bits) < 4 * (nindexed + 1); ++config_key_bits);
+    nbuckets = 1 << config_key_bits;
 
-  AtomixConfiguration.atomic_data_loaded = FALSE;
+    config_key_head = malloc(nbuckets * sizeof(int));
+    config_key_tail = malloc(nbuckets * sizeof(int));
+    config_key_next = malloc(nbuckets / 2 * sizeof(int));
+    if(config_key_head == NULL || config_key_tail == NULL || config_key_next == NULL)
+    {
+      free_config_key_index();
+      return EXIT_FAILURE;
+    }
 
-/* Allocate structures for storage of data */
+    for(i = 0; i < nbuckets; i++)
+      config_key_head[i] = config_key_tail[i] = -1;
 
-  if(ele != NULL)
-  {
-    free(ele);
-  }
-  ele = (ElemPtr) calloc(sizeof(ele_dummy), NELEMENTS);
-  if(ele == NULL)
-  {
-    logfile("There is a problem in allocating memory for the element structure\n");
-    return ATOMIC_MEMORY_ISSUE_ERROR;
+    for(i = 0; i < nindexed; i++)
+      index_config_key(i);
   }
+
+  h = hash_line_key(config[n].z, config[n].istate, config[n].ilv, 0, config_key_bits);
+  config_key_next[n] = -1;
+  if(config_key_head[h] < 0)
+    config_key_head[h] = n;
   else
-  {
-    logfile
-      ("Allocated %10d bytes for each of %6d elements of   elements totaling %10.0f Mb \n",
-       sizeof(ele_dummy), NELEMENTS, 1.e-6 * NELEMENTS * sizeof(ele_dummy));
-  }
+    config_key_next[config_key_tail[h]] = n;
+  config_key_tail[h] = n;
+
+  config_key_nindexed = n + 1;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the next configuration with a given (z, istate, ilv).
+ *
+ * @param[in]  z       The atomic number
+ * @param[in]  istate  The ionisation state
+ * @param[in]  ilv     The level number
+ * @param[in]  after   The configuration to search after, or -1 to find the
+ *                     first one
+ *
+ * @return  The configuration, or -1 if there are no more
+ *
+ * @details
+ *
+ * Configurations are found in the same order as a search through config, so
+ * the first one is the one a search would have found.
+ *
+ * ************************************************************************** */
+
+static int
+find_config(int z, int istate, int ilv, int after)
+{
+  int n;
+
+  if(config_key_head == NULL)
+    return -1;
+
+  if(after < 0)
+    n = config_key_head[hash_line_key(z, istate, ilv, 0, config_key_bits)];
+  else
+    n = config_key_next[after];
+
+  while(n >= 0 && (config[n].z != z || config[n].istate != istate || config[n].ilv != ilv))
+    n = config_key_next[n];
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the first level of an ion in a range of configurations with a
+ *         given level number.
+ *
+ * @param[in]  z       The atomic number
+ * @param[in]  istate  The ionisation state
+ * @param[in]  ilv     The level number
+ * @param[in]  first   The first configuration in the range
+ * @param[in]  end     One past the last configuration in the range
+ *
+ * @return  The configuration, or -1 if the ion has no such level in the range
+ *
+ * @details
+ *
+ * The range is the ion's own levels, from firstlevel to firstlevel + nlevels.
+ * Levels of the same ion outside of the range are not used. They come from
+ * another level list, such as the Topbase levels, which number ilv within each
+ * symmetry, so the same ilv is not the same level as the one the line means.
+ *
+ * ************************************************************************** */
+
+static int
+find_ion_level(int z, int istate, int ilv, int first, int end)
+{
+  int n;
+
+  n = find_config(z, istate, ilv, -1);
+  while(n >= 0 && n < first)
+    n = find_config(z, istate, ilv, n);
+
+  if(n >= 0 && n < end)
+    return n;
+
+  return -1;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Grow a table of atomic data, initialising the new entries.
+ *
+ * @param[in]  table  The table to grow, which may be NULL
+ * @param[in]  nold   The number of entries allocated for the table
+ * @param[in]  nnew   The number of entries to allocate
+ * @param[in]  size   The size of each entry
+ * @param[in]  init   The function to initialise each new entry with, or NULL
+ *                    to leave them zeroed
+ *
+ * @return  The grown table, or NULL if the memory could not be allocated in
+ *          which case the table is left as it was
+ *
+ * ************************************************************************** */
+
+static void *
+grow_table(void *table, int nold, int nnew, size_t size, void (*init)(void *))
+{
+  int n;
+  char *grown;
+
+  if((grown = realloc(table, nnew * size)) == NULL)
+    return NULL;
+
+  memset(grown + nold * size, 0, (nnew - nold) * size);
+  if(init != NULL)
+    for(n = nold; n < nnew; n++)
+      init(grown + n * size);
+
+  return grown;
+}
+
+/*
+ * The number of entries to grow a table to, so that it has room for at least n
+ * entries. Tables grow geometrically so that adding entries one at a time as
+ * they are read in is cheap
+ */
+
+#define TABLE_SIZE(nmax, n) MAX(MAX(2 * (nmax), (n)), TABLE_SIZE_INIT)
+
+static int *simple_line_ignore; /* diagnostic counter for how many lines were ignored for each ion */
+
+static void
+init_ion(void *entry)
+{
+  IonPtr ion = entry;
+
+  ion->z = (-1);
+  ion->istate = (-1);
+  ion->nelem = (-1);
+  ion->ip = (-1);
+  ion->g = (-1);
+  ion->firstlevel = (-1);
+  ion->nlevels = (-1);
+  ion->first_nlte_level = (-1);
+  ion->nlte = (-1);
+  ion->phot_info = (-1);
+  ion->macro_info = (-1);       //Initialise - don't know if using Macro Atoms or not: set to -1 (SS)
+  ion->ntop = 0;
+  ion->lev_type = (-1);         // Initialise to indicate we don't know what types of configurations will be read
+}
+
+static void
+init_ion_links(void *entry)
+{
+  int i;
+  IonLinksPtr links = entry;
+
+  links->nmax = (-1);
+  links->first_levden = (-1);
+  links->ntop_first = 0;        // The fact that ntop_first and ntop  are initialized to 0 and not -1 is important
+  links->ntop_ground = 0;       //NSH 0312 initialize the new pointer for GS cross sections
+  links->nxphot = (-1);
+  links->drflag = 0;            //Initialise to indicate as far as we know, there are no dielectronic recombination parameters associated with this ion.
+  links->total_rrflag = 0;      //Initialise to say this ion has no Badnell total recombination data
+  links->nxtotalrr = -1;        //Initialise the pointer into the bad_t_rr structure.
+  links->bad_gs_rr_t_flag = 0;  //Initialise to say this ion has no Badnell ground state recombination data
+  links->bad_gs_rr_r_flag = 0;  //Initialise to say this ion has no Badnell ground state recombination data
+  links->nxbadgsrr = -1;        //Initialise the pointer into the bad_gs_rr structure.
+  links->dere_di_flag = 0;      //Initialise to say this ion has no Dere DI rate data
+  links->nxderedi = -1;         //Initialise the pointer into the Dere DI rate structure
+  links->n_inner = 0;           //Initialise the pointer to say we have no inner shell ionization cross sections
+  for(i = 0; i < N_INNER; i++)
+    links->nxinner[i] = -1;     //Inintialise the inner shell pointer array
+}
+
+static void
+init_line(void *entry)
+{
+  LinePtr lin = entry;
+
+  lin->freq = -1;
+  lin->f = 0;
+  lin->nion = -1;
+  lin->gl = lin->gu = 0;
+  lin->el = lin->eu = 0.0;
+  lin->macro_info = -1;
+}
+
+static void
+init_line_links(void *entry)
+{
+  LineLinksPtr links = entry;
+
+  links->coll_index = -999;
+}
+
+static void
+init_coll_stren(void *entry)
+{
+  Coll_strenptr cstren = entry;
+
+  cstren->n = -1;               //Internal index
+  cstren->lower = -1;           //The lower energy level - this is in Chianti notation and is currently unused
+  cstren->upper = -1;           //The upper energy level - this is in Chianti notation and is currently unused
+  cstren->type = -1;            //The type of fit, this defines how one computes the scaled temperature and scaled coll strength
+}
+
+static void
+init_phot_top(void *entry)
+{
+  TopPhotPtr xsection = entry;
+
+  xsection->nlev = (-1);
+  xsection->uplev = (-1);
+  xsection->nion = (-1);        //the ion to which this cross section belongs
+  xsection->n_elec_yield = -1;  //pointer to the electron yield array (for inner shell)
+  xsection->n = -1;             //pointer to shell (inner shell)
+  xsection->l = -1;             //pointer to l subshell (inner shell only)
+  xsection->z = (-1);           //atomic number
+  xsection->np = (-1);          //number of points in the fit
+  xsection->macro_info = (-1);  //Initialise - don't know if using Macro Atoms or not: set to -1 (SS)
+  xsection->offset = 0;         //no cross section points yet
+  xsection->packed = NULL;      //stored in full
+  xsection->f = (-1);           //last frequency
+  xsection->sigma = 0.0;        //last cross section
+}
+
+static void
+init_inner_elec_yield(void *entry)
+{
+  Inner_elec_yield *yield = entry;
+
+  yield->nion = yield->n = yield->l = yield->z = (-1);
+}
+
+static void
+init_inner_fluor_yield(void *entry)
+{
+  Inner_fluor_yield *yield = entry;
+
+  yield->nion = yield->n = yield->l = yield->z = (-1);
+}
+
+static void
+init_drecomb(void *entry)
+{
+  Drecombptr dr = entry;
+
+  dr->nion = -1;
+  dr->nparam = -1;              //the number of parameters - it varies from ion to ion
+}
+
+static void
+init_total_rr(void *entry)
+{
+  total_rrptr rr = entry;
+
+  rr->nion = -1;
+}
+
+static void
+init_bad_gs_rr(void *entry)
+{
+  Bad_gs_rrptr rr = entry;
+
+  rr->nion = -1;
+}
+
+static void
+init_dere_di_rate(void *entry)
+{
+  Dere_di_rateptr di = entry;
+
+  di->nion = -1;
+  di->min_temp = 1e99;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n ions.
+ *
+ * @param[in]  n  The number of ions needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * The ion links and ground state fractions are kept alongside the ions, so
+ * they grow with them.
+ *
+ * ************************************************************************** */
+
+int
+grow_ions(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= nions_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(nions_max, n);
+
+  if((p = grow_table(ions, nions_max, nmax, sizeof(ion_dummy), init_ion)) == NULL)
+    return EXIT_FAILURE;
+  ions = p;
+  if((p = grow_table(ion_links, nions_max, nmax, sizeof(ion_links_dummy), init_ion_links)) == NULL)
+    return EXIT_FAILURE;
+  ion_links = p;
+  if((p = grow_table(ground_frac, nions_max, nmax, sizeof(struct ground_fracs), NULL)) == NULL)
+    return EXIT_FAILURE;
+  ground_frac = p;
+  if((p = grow_table(simple_line_ignore, nions_max, nmax, sizeof(int), NULL)) == NULL)
+    return EXIT_FAILURE;
+  simple_line_ignore = p;
+
+  nions_max = nmax;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n levels.
+ *
+ * @param[in]  n  The number of levels needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * ************************************************************************** */
+
+int
+grow_levels(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= nlevels_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(nlevels_max, n);
+
+  if((p = grow_table(config, nlevels_max, nmax, sizeof(config_dummy), NULL)) == NULL)
+    return EXIT_FAILURE;
+  config = p;
+
+  nlevels_max = nmax;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n lines.
+ *
+ * @param[in]  n  The number of lines needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * The line links grow with the lines. lin_ptr only points into line once the
+ * lines have been indexed, so it does not need to be updated when line moves.
+ *
+ * ************************************************************************** */
+
+int
+grow_lines(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= nlines_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(nlines_max, n);
+
+  if((p = grow_table(line, nlines_max, nmax, sizeof(line_dummy), init_line)) == NULL)
+    return EXIT_FAILURE;
+  line = p;
+  if((p = grow_table(line_links, nlines_max, nmax, sizeof(line_links_dummy), init_line_links)) == NULL)
+    return EXIT_FAILURE;
+  line_links = p;
+  if((p = grow_table(lin_ptr, nlines_max, nmax, sizeof(LinePtr), NULL)) == NULL)
+    return EXIT_FAILURE;
+  lin_ptr = p;
+
+  nlines_max = nmax;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the links of an ion into the other tables.
+ *
+ * @param[in]  nion  The ion number
+ *
+ * @return  The links of the ion
+ *
+ * ************************************************************************** */
+
+IonLinksPtr
+ion_link(int nion)
+{
+  return &ion_links[nion];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the macro atom and collision strength links of a line.
+ *
+ * @param[in]  lin  The line, which has to be in line, such as one pointed to
+ *                  by lin_ptr
+ *
+ * @return  The links of the line
+ *
+ * @details
+ *
+ * The links are found from where the line is in line, so a copy of a line
+ * does not have any.
+ *
+ * ************************************************************************** */
+
+LineLinksPtr
+line_link(const struct lines *lin)
+{
+  return &line_links[lin - line];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n collision strengths.
+ *
+ * @param[in]  n  The number of collision strengths needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * ************************************************************************** */
+
+int
+grow_coll_stren(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= n_coll_stren_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(n_coll_stren_max, n);
+
+  if((p = grow_table(coll_stren, n_coll_stren_max, nmax, sizeof(Coll_stren), init_coll_stren)) == NULL)
+    return EXIT_FAILURE;
+  coll_stren = p;
+
+  n_coll_stren_max = nmax;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n photoionization x-sections.
+ *
+ * @param[in]  n  The number of x-sections needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * As with lin_ptr, phot_top_ptr is only filled in once all of the x-sections
+ * have been read. The points of each x-section are pointed at again, as
+ * phot_top may have moved.
+ *
+ * ************************************************************************** */
+
+int
+grow_phot_top(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= nphot_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(nphot_max, n);
+
+  if((p = grow_table(phot_top, nphot_max, nmax, sizeof(Topbase_phot), init_phot_top)) == NULL)
+    return EXIT_FAILURE;
+  phot_top = p;
+  if((p = grow_table(phot_top_ptr, nphot_max, nmax, sizeof(TopPhotPtr), NULL)) == NULL)
+    return EXIT_FAILURE;
+  phot_top_ptr = p;
+
+  nphot_max = nmax;
 
+  if(xsection_freq != NULL)
+    update_xsection_pointers();
 
-  if(ions != NULL)
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n inner shell x-sections.
+ *
+ * @param[in]  n  The number of inner shell x-sections needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * The electron and fluorescent yields are kept alongside the x-sections, as
+ * there is at most one of each for every inner shell. As with phot_top_ptr,
+ * inner_cross_ptr is only filled in once all of the x-sections have been read,
+ * and the points of each x-section are pointed at again.
+ *
+ * ************************************************************************** */
+
+int
+grow_inner_cross(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= n_inner_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(n_inner_max, n);
+
+  if((p = grow_table(inner_cross, n_inner_max, nmax, sizeof(Topbase_phot), init_phot_top)) == NULL)
+    return EXIT_FAILURE;
+  inner_cross = p;
+  if((p = grow_table(inner_cross_ptr, n_inner_max, nmax, sizeof(TopPhotPtr), NULL)) == NULL)
+    return EXIT_FAILURE;
+  inner_cross_ptr = p;
+  if((p = grow_table(inner_elec_yield, n_inner_max, nmax, sizeof(Inner_elec_yield), init_inner_elec_yield)) == NULL)
+    return EXIT_FAILURE;
+  inner_elec_yield = p;
+  if((p = grow_table(inner_fluor_yield, n_inner_max, nmax, sizeof(Inner_fluor_yield), init_inner_fluor_yield)) == NULL)
+    return EXIT_FAILURE;
+  inner_fluor_yield = p;
+
+  n_inner_max = nmax;
+
+  if(xsection_freq != NULL)
+    update_xsection_pointers();
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n dielectronic recombination rates.
+ *
+ * @param[in]  n  The number of dielectronic recombination rates needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * ************************************************************************** */
+
+int
+grow_drecomb(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= ndrecomb_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(ndrecomb_max, n);
+
+  if((p = grow_table(drecomb, ndrecomb_max, nmax, sizeof(Drecomb), init_drecomb)) == NULL)
+    return EXIT_FAILURE;
+  drecomb = p;
+
+  ndrecomb_max = nmax;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n total radiative recombination rates.
+ *
+ * @param[in]  n  The number of total radiative recombination rates needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * ************************************************************************** */
+
+int
+grow_total_rr(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= n_total_rr_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(n_total_rr_max, n);
+
+  if((p = grow_table(total_rr, n_total_rr_max, nmax, sizeof(Total_rr), init_total_rr)) == NULL)
+    return EXIT_FAILURE;
+  total_rr = p;
+
+  n_total_rr_max = nmax;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n ground state radiative recombination rates.
+ *
+ * @param[in]  n  The number of ground state radiative recombination rates needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * ************************************************************************** */
+
+int
+grow_bad_gs_rr(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= n_bad_gs_rr_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(n_bad_gs_rr_max, n);
+
+  if((p = grow_table(bad_gs_rr, n_bad_gs_rr_max, nmax, sizeof(Bad_gs_rr), init_bad_gs_rr)) == NULL)
+    return EXIT_FAILURE;
+  bad_gs_rr = p;
+
+  n_bad_gs_rr_max = nmax;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Make sure there is room for at least n direct ionization rates.
+ *
+ * @param[in]  n  The number of direct ionization rates needed
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * ************************************************************************** */
+
+int
+grow_dere_di_rate(int n)
+{
+  int nmax;
+  void *p;
+
+  if(n <= n_dere_di_rate_max)
+    return EXIT_SUCCESS;
+
+  nmax = TABLE_SIZE(n_dere_di_rate_max, n);
+
+  if((p = grow_table(dere_di_rate, n_dere_di_rate_max, nmax, sizeof(Dere_di_rate), init_dere_di_rate)) == NULL)
+    return EXIT_FAILURE;
+  dere_di_rate = p;
+
+  n_dere_di_rate_max = nmax;
+
+  return EXIT_SUCCESS;
+}
+
+/*
+ * The Macro Atom jumps as they are read in, with the configuration of each
+ * jump, before they are grouped by configuration by build_macro_jumps
+ */
+
+static int *pending_jump_level[NMACRO_JUMPS];
+static int *pending_jump_target[NMACRO_JUMPS];
+static int npending_jumps[NMACRO_JUMPS];
+static int npending_jumps_max[NMACRO_JUMPS];
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the Macro Atom jumps, including any still waiting to be
+ *         grouped by configuration.
+ *
+ * ************************************************************************** */
+
+static void
+free_macro_jumps(void)
+{
+  int kind;
+
+  for(kind = 0; kind < NMACRO_JUMPS; ++kind)
   {
-    free(ions);
+    free(pending_jump_level[kind]);
+    free(pending_jump_target[kind]);
+    free(macro_jumps[kind]);
+    pending_jump_level[kind] = NULL;
+    pending_jump_target[kind] = NULL;
+    macro_jumps[kind] = NULL;
+    npending_jumps[kind] = npending_jumps_max[kind] = nmacro_jumps[kind] = 0;
   }
-  ions = (IonPtr) calloc(sizeof(ion_dummy), NIONS);
-  if(ions == NULL)
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Record a Macro Atom jump as it is read in.
+ *
+ * @param[in]  kind    The kind of jump
+ * @param[in]  nlevel  The configuration the jump is from
+ * @param[in]  target  The line or photoionization cross section of the jump
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * The n_bbu_jump etc. counter of the configuration has to be incremented by
+ * the caller, as it is used for the up_index and down_index of the jump.
+ *
+ * ************************************************************************** */
+
+static int
+add_macro_jump(int kind, int nlevel, int target)
+{
+  int nmax;
+  void *p;
+
+  if(npending_jumps[kind] >= npending_jumps_max[kind])
   {
-    logfile("There is a problem in allocating memory for the ion structure\n");
-    return ATOMIC_MEMORY_ISSUE_ERROR;
+    nmax = TABLE_SIZE(npending_jumps_max[kind], npending_jumps[kind] + 1);
+    if((p = grow_table(pending_jump_level[kind], npending_jumps_max[kind], nmax, sizeof(int), NULL)) == NULL)
+      return EXIT_FAILURE;
+    pending_jump_level[kind] = p;
+    if((p = grow_table(pending_jump_target[kind], npending_jumps_max[kind], nmax, sizeof(int), NULL)) == NULL)
+      return EXIT_FAILURE;
+    pending_jump_target[kind] = p;
+    npending_jumps_max[kind] = nmax;
   }
-  else
+
+  pending_jump_level[kind][npending_jumps[kind]] = nlevel;
+  pending_jump_target[kind][npending_jumps[kind]] = target;
+  npending_jumps[kind]++;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the number of Macro Atom jumps of one kind from a configuration.
+ *
+ * @param[in]  nlevel  The configuration
+ * @param[in]  kind    The kind of jump
+ *
+ * @return  The number of jumps
+ *
+ * ************************************************************************** */
+
+int
+config_njumps(int nlevel, int kind)
+{
+  switch(kind)
   {
-    logfile
-      ("Allocated %10d bytes for each of %6d elements of       ions totaling %10.1f Mb \n",
-       sizeof(ion_dummy), NIONS, 1.e-6 * NIONS * sizeof(ion_dummy));
+  case JUMP_BB_UP:
+    return config[nlevel].n_bbu_jump;
+  case JUMP_BB_DOWN:
+    return config[nlevel].n_bbd_jump;
+  case JUMP_BF_UP:
+    return config[nlevel].n_bfu_jump;
+  case JUMP_BF_DOWN:
+    return config[nlevel].n_bfd_jump;
+  default:
+    return 0;
   }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the Macro Atom jumps of one kind from a configuration.
+ *
+ * @param[in]  nlevel  The configuration
+ * @param[in]  kind    The kind of jump
+ *
+ * @return  The jumps, of which there are config_njumps(nlevel, kind), in the
+ *          order they were read in
+ *
+ * @details
+ *
+ * This replaces the fixed size bbu_jump, bbd_jump, bfu_jump and bfd_jump
+ * arrays which each configuration used to have, so jump j of the upward bb
+ * jumps is config_jumps(nlevel, JUMP_BB_UP)[j].
+ *
+ * ************************************************************************** */
+
+const int *
+config_jumps(int nlevel, int kind)
+{
+  return macro_jumps[kind] + config[nlevel].jump_start[kind];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Allocate the arrays which hold the Macro Atom jumps of every
+ *         configuration.
+ *
+ * @param[in]  njumps  The total number of jumps of each kind
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * Any jumps already held are freed.
+ *
+ * ************************************************************************** */
 
+int
+resize_macro_jumps(const int *njumps)
+{
+  int kind;
 
+  free_macro_jumps();
 
-  if(config != NULL)
+  for(kind = 0; kind < NMACRO_JUMPS; ++kind)
   {
-    free(config);
+    if((macro_jumps[kind] = malloc((njumps[kind] + 1) * sizeof(int))) == NULL)
+    {
+      free_macro_jumps();
+      return EXIT_FAILURE;
+    }
+    nmacro_jumps[kind] = njumps[kind];
   }
-  config = (ConfigPtr) calloc(sizeof(config_dummy), NLEVELS);
-  if(config == NULL)
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Group the Macro Atom jumps which have been read in by configuration.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * The jump_start of each configuration is set from the number of jumps of the
+ * configurations before it, and then each jump is put in at the end of the
+ * jumps of its configuration in the order they were read in, so the position
+ * of a jump matches the up_index or down_index it was given.
+ *
+ * ************************************************************************** */
+
+static int
+build_macro_jumps(void)
+{
+  int i, n, kind, start;
+  int *level[NMACRO_JUMPS], *target[NMACRO_JUMPS];
+  int npending[NMACRO_JUMPS];
+
+  /*
+   * Take the pending jumps before resize_macro_jumps frees them
+   */
+
+  for(kind = 0; kind < NMACRO_JUMPS; ++kind)
   {
-    logfile("There is a problem in allocating memory for the config structure\n");
-    return ATOMIC_MEMORY_ISSUE_ERROR;
+    level[kind] = pending_jump_level[kind];
+    target[kind] = pending_jump_target[kind];
+    npending[kind] = npending_jumps[kind];
+    pending_jump_level[kind] = pending_jump_target[kind] = NULL;
   }
-  else
+
+  if(resize_macro_jumps(npending))
   {
-    logfile
-      ("Allocated %10d bytes for each of %6d elements of     config totaling %10.1f Mb \n",
-       sizeof(config_dummy), NLEVELS, 1.e-6 * NLEVELS * sizeof(config_dummy));
+    for(kind = 0; kind < NMACRO_JUMPS; ++kind)
+    {
+      free(level[kind]);
+      free(target[kind]);
+    }
+    return EXIT_FAILURE;
   }
 
-  if(line != NULL)
+  for(kind = 0; kind < NMACRO_JUMPS; ++kind)
   {
-    free(line);
+    for(n = 0, start = 0; n < nlevels; ++n)
+    {
+      config[n].jump_start[kind] = start;
+      start += config_njumps(n, kind);
+    }
+
+    if(start != npending[kind])
+    {
+      for(; kind < NMACRO_JUMPS; ++kind)
+      {
+        free(level[kind]);
+        free(target[kind]);
+      }
+      free_macro_jumps();
+      return EXIT_FAILURE;
+    }
+
+    for(i = 0; i < npending[kind]; ++i)
+      macro_jumps[kind][config[level[kind][i]].jump_start[kind]++] = target[kind][i];
+
+    for(n = 0; n < nlevels; ++n)
+      config[n].jump_start[kind] -= config_njumps(n, kind);
+
+    free(level[kind]);
+    free(target[kind]);
   }
-  line = (LinePtr) calloc(sizeof(line_dummy), NLINES);
 
-  if(line == NULL)
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the tables which grow as the atomic data is read in.
+ *
+ * ************************************************************************** */
+
+void
+free_atomic_tables(void)
+{
+  free(ions);
+  free(ion_links);
+  free(ground_frac);
+  free(simple_line_ignore);
+  free(config);
+  free(line);
+  free(line_links);
+  free(lin_ptr);
+  free(coll_stren);
+  free(phot_top);
+  free(phot_top_ptr);
+  free(inner_cross);
+  free(inner_cross_ptr);
+  free(inner_elec_yield);
+  free(inner_fluor_yield);
+  free(drecomb);
+  free(total_rr);
+  free(bad_gs_rr);
+  free(dere_di_rate);
+  free_line_columns();
+  free_posting_lists();
+  free_species_stats();
+  free_strongest_index();
+  free_coverage_index();
+  free_lower_level_index();
+  free_level_links();
+  free_macro_jumps();
+  free_packed_xsections();
+
+  ions = NULL;
+  ion_links = NULL;
+  ground_frac = NULL;
+  simple_line_ignore = NULL;
+  config = NULL;
+  line = NULL;
+  line_links = NULL;
+  lin_ptr = NULL;
+  coll_stren = NULL;
+  phot_top = NULL;
+  phot_top_ptr = NULL;
+  inner_cross = NULL;
+  inner_cross_ptr = NULL;
+  inner_elec_yield = NULL;
+  inner_fluor_yield = NULL;
+  drecomb = NULL;
+  total_rr = NULL;
+  bad_gs_rr = NULL;
+  dere_di_rate = NULL;
+
+  nions_max = nlevels_max = nlines_max = n_coll_stren_max = nphot_max = 0;
+  n_inner_max = ndrecomb_max = n_total_rr_max = n_bad_gs_rr_max = n_dere_di_rate_max = 0;
+}
+
+/*
+ * The number of entries at the start of the static gaunt factor table which
+ * the last load may have written to. It starts at the size of the table, so
+ * the first load resets it in full, and is only lowered once a load has
+ * finished, so a load which fails part way through is reset in full the next
+ * time. The other tables grow as the data is read in, so they are freed and
+ * start out initialised with each load
+ */
+
+static int gaunt_total_mark = MAX_GAUNT_N_GSQRD;
+
+/* ************************************************************************** */
+/**
+ * @brief  Record how many entries of the static tables have been written to,
+ *         once a load has finished.
+ *
+ * ************************************************************************** */
+
+static void
+mark_static_tables(void)
+{
+  gaunt_total_mark = gaunt_n_gsqrd;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Empty all of the atomic data, ready for it to be read in.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * The elements are allocated again, the tables which grow are freed and start
+ * out small, the gaunt factors the last load used are reset and the number of
+ * entries in each table is set back to zero.
+ *
+ * ************************************************************************** */
+
+int
+reset_atomic_data(void)
+{
+  int n;
+
+  if(ele != NULL)
   {
-    logfile("There is a problem in allocating memory for the line structure\n");
-    return ATOMIC_MEMORY_ISSUE_ERROR;
+    free(ele);
+  }
+  ele = (ElemPtr) calloc(sizeof(ele_dummy), NELEMENTS);
+  if(ele == NULL)
+  {
+    logfile("There is a problem in allocating memory for the element structure\n");
+    return EXIT_FAILURE;
   }
   else
   {
     logfile
-      ("Allocated %10d bytes for each of %6d elements of       line totaling %10.1f Mb \n",
-       sizeof(line_dummy), NLINES, 1.e-6 * NLINES * sizeof(line_dummy));
-  }
-
-
-
-  /* Initialize variables */
+      ("Allocated %10d bytes for each of %6d elements of   elements totaling %10.0f Mb \n",
+       sizeof(ele_dummy), NELEMENTS, 1.e-6 * NELEMENTS * sizeof(ele_dummy));
+  }
 
+  /*
+   * The tables of ions, levels, lines, collision strengths, x-sections and
+   * rates grow as the data is read in, so they start out small and initialised
+   */
 
+  free_atomic_tables();
+  free_line_key_index();
+  free_config_key_index();
+  reset_lookup_tables();
+  if(grow_ions(TABLE_SIZE_INIT) || grow_levels(TABLE_SIZE_INIT) || grow_lines(TABLE_SIZE_INIT) ||
+     grow_coll_stren(TABLE_SIZE_INIT) || grow_phot_top(TABLE_SIZE_INIT) || grow_inner_cross(TABLE_SIZE_INIT) ||
+     grow_drecomb(TABLE_SIZE_INIT) || grow_total_rr(TABLE_SIZE_INIT) || grow_bad_gs_rr(TABLE_SIZE_INIT) ||
+     grow_dere_di_rate(TABLE_SIZE_INIT))
+  {
+    logfile("There is a problem in allocating memory for the atomic data tables\n");
+    return EXIT_FAILURE;
+  }
 
   phot_freq_min = VERY_BIG;
   inner_freq_min = VERY_BIG;
@@ -1071,206 +2067,326 @@ get_atomic_data(char *masterfile, int use_relative)
     ele[n].istate_max = (-1);
   }
 
-  for(n = 0; n < NIONS; n++)
-  {
-    simple_line_ignore[n] = 0;  // diagnostic counter for how many lines ignored
-    ions[n].z = (-1);
-    ions[n].istate = (-1);
-    ions[n].nelem = (-1);
-    ions[n].ip = (-1);
-    ions[n].g = (-1);
-    ions[n].nmax = (-1);
-    ions[n].firstlevel = (-1);
-    ions[n].nlevels = (-1);
-    ions[n].first_nlte_level = (-1);
-    ions[n].first_levden = (-1);
-    ions[n].nlte = (-1);
-    ions[n].phot_info = (-1);
-    ions[n].macro_info = (-1);  //Initialise - don't know if using Macro Atoms or not: set to -1 (SS)
-    ions[n].ntop_first = 0;     // The fact that ntop_first and ntop  are initialized to 0 and not -1 is important
-    ions[n].ntop_ground = 0;    //NSH 0312 initialize the new pointer for GS cross sections
-    ions[n].ntop = 0;
-    ions[n].nxphot = (-1);
-    ions[n].lev_type = (-1);    // Initialise to indicate we don't know what types of configurations will be read
-    ions[n].drflag = 0;         //Initialise to indicate as far as we know, there are no dielectronic recombination parameters associated with this ion.
-    ions[n].total_rrflag = 0;   //Initialise to say this ion has no Badnell total recombination data
-    ions[n].nxtotalrr = -1;     //Initialise the pointer into the bad_t_rr structure.
-    ions[n].bad_gs_rr_t_flag = 0; //Initialise to say this ion has no Badnell ground state recombination data
-    ions[n].bad_gs_rr_r_flag = 0; //Initialise to say this ion has no Badnell ground state recombination data
-    ions[n].nxbadgsrr = -1;     //Initialise the pointer into the bad_gs_rr structure.
-    ions[n].dere_di_flag = 0;   //Initialise to say this ion has no Dere DI rate data
-    ions[n].nxderedi = -1;      //Initialise the pointer into the Dere DI rate structure
-    ions[n].n_inner = 0;        //Initialise the pointer to say we have no inner shell ionization cross sections
-    for(i = 0; i < N_INNER; i++)
-      ions[n].nxinner[i] = -1;  //Inintialise the inner shell pointer array
-  }
-
-  nlevels = nxphot = nphot_total = ntop_phot = nauger = ndrecomb = n_inner_tot = 0; //Added counter for DR//
-  n_elec_yield_tot = 0;         //Counter for electron yield
-  //  n_fluor_yield_tot = 0;     and fluorescent photon yields
+  nelements = nions = 0;
+  nlevels = nlte_levels = nlevels_macro = 0;
+  nlines = nlines_macro = 0;
+  nxphot = nphot_total = ntop_phot = nauger = 0;
+  n_coll_stren = n_inner_tot = 0;
+  ndrecomb = n_total_rr = n_bad_gs_rr = n_dere_di_rate = 0;
 
-  /*This initializes the top_phot array - it is used for all ionization processes so some elements
-     are only used in some circumstances
-   */
+/* The following lines initialise the Sutherland gaunt factors the last load may have used */
+  gaunt_n_gsqrd = 0;            //The number of sets of scaled temperatures we have data for
+  for(n = 0; n < gaunt_total_mark; n++)
+  {
+    gaunt_total[n].log_gsqrd = 0.0;
+    gaunt_total[n].gff = 0.0;
+    gaunt_total[n].s1 = 0.0;
+    gaunt_total[n].s2 = 0.0;
+    gaunt_total[n].s3 = 0.0;
+  }
+  gaunt_total_mark = MAX_GAUNT_N_GSQRD;
 
-  for(n = 0; n < NLEVELS; n++)
-  {
-    phot_top[n].nlev = (-1);
-    phot_top[n].uplev = (-1);
-    phot_top[n].nion = (-1);    //the ion to which this cross section belongs
-    phot_top[n].n_elec_yield = -1;  //pointer to the electron yield array (for inner shell)
-//    phot_top[n].n_fluor_yield = -1;     //pointer to the fluorescent photon yield (for inner shell)
-    phot_top[n].n = -1;         //pointer to shell (inner shell)
-    phot_top[n].l = -1;         //pointer to l subshell (inner shell only)
-    phot_top[n].z = (-1);       //atomic number
-    phot_top[n].np = (-1);      //number of points in the fit
-    phot_top[n].macro_info = (-1);  //Initialise - don't know if using Macro Atoms or not: set to -1 (SS)
-    for(j = 0; j < NCROSS; j++) //initialise the crooss sectiond
-    {
-      phot_top[n].freq[j] = (-1);
-      phot_top[n].x[j] = (-1);
-    }
-    phot_top[n].f = (-1);       //last frequency
-    phot_top[n].sigma = 0.0;    //last cross section
-  }
-
-
-  for(n = 0; n < NIONS * N_INNER; n++)  //Initialise atomic arrasy with dimension NIONS*NINNER
-  {
-    inner_cross[n].nlev = (-1);
-    inner_cross[n].uplev = (-1);
-    inner_cross[n].nion = inner_elec_yield[n].nion = inner_fluor_yield[n].nion = (-1);
-    inner_cross[n].n_elec_yield = -1;
-//    inner_cross[n].n_fluor_yield = -1;
-    inner_cross[n].n = inner_elec_yield[n].n = inner_fluor_yield[n].n = (-1);
-    inner_cross[n].l = inner_elec_yield[n].l = inner_fluor_yield[n].l = (-1);
-    inner_cross[n].z = inner_elec_yield[n].z = inner_fluor_yield[n].z = (-1);
-    inner_elec_yield[n].I = inner_elec_yield[n].Ea = 0.0;
-    inner_fluor_yield[n].freq = inner_fluor_yield[n].yield = 0.0;
-    for(j = 0; j < 10; j++)
-      inner_elec_yield[n].prob[j] = 0.0;
-    inner_cross[n].np = (-1);
-    inner_cross[n].macro_info = (-1); //Initialise - don't know if using Macro Atoms or not: set to -1 (SS)
-    for(j = 0; j < NCROSS; j++)
-    {
-      inner_cross[n].freq[j] = (-1);
-      inner_cross[n].x[j] = (-1);
-    }
-    inner_cross[n].f = (-1);
-    inner_cross[n].sigma = 0.0;
+  /* Empty the pools of cross section points, leaving only the sentinel point */
+
+  nxsection_points = 0;
+  if(resize_xsection_points(XSECTION_POINTS_INIT))
+  {
+    logfile("There is a problem in allocating memory for the cross section points\n");
+    return EXIT_FAILURE;
   }
+  xsection_freq[0] = xsection_x[0] = (-1);
+  nxsection_points = 1;
 
+  return EXIT_SUCCESS;
+}
 
+/* ************************************************************************** */
+/**
+ * @brief  Point each x-section at its points in the x-section pools.
+ *
+ * @details
+ *
+ * This has to be done whenever the pools, phot_top or inner_cross have been
+ * moved by a resize.
+ *
+ * ************************************************************************** */
 
+void
+update_xsection_pointers(void)
+{
+  int n;
 
-  for(i = 0; i < NLEVELS; i++)
+  for(n = 0; n < nphot_max; n++)
   {
-    config[i].n_bbu_jump = 0;   // initialising the number of jumps from each level to 0. (SS)
-    config[i].n_bbd_jump = 0;
-    config[i].n_bfu_jump = 0;
-    config[i].n_bfd_jump = 0;
+    phot_top[n].freq = &xsection_freq[phot_top[n].offset];
+    phot_top[n].x = &xsection_x[phot_top[n].offset];
   }
 
-  for(n = 0; n < NLINES; n++)
+  for(n = 0; n < n_inner_max; n++)
   {
-    line[n].freq = -1;
-    line[n].f = 0;
-    line[n].nion = -1;
-    line[n].gl = line[n].gu = 0;
-    line[n].el = line[n].eu = 0.0;
-    line[n].macro_info = -1;
-    line[n].coll_index = -999;
+    inner_cross[n].freq = &xsection_freq[inner_cross[n].offset];
+    inner_cross[n].x = &xsection_x[inner_cross[n].offset];
   }
+}
 
-/* The following lines initialise the dielectronic recombination structure */
-  for(n = 0; n < NIONS; n++)
-  {
-    drecomb[n].nion = -1;
-    drecomb[n].nparam = -1;     //the number of parameters - it varies from ion to ion
-    for(n1 = 0; n1 < MAX_DR_PARAMS; n1++)
-    {
-      drecomb[n].c[n1] = 0.0;
-      drecomb[n].e[n1] = 0.0;
-    }
-  }
+/* ************************************************************************** */
+/**
+ * @brief  Resize the pools of x-section points.
+ *
+ * @param[in]  npoints  The number of points to allocate, which must be at least
+ *                      the number of points already in use
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * ************************************************************************** */
 
+int
+resize_xsection_points(int npoints)
+{
+  double *freq, *x;
 
-/* The following lines initialise the badnell total radiative recombination rate structure */
-  for(n = 0; n < NIONS; n++)
-  {
-    total_rr[n].nion = -1;
-    for(n1 = 0; n1 < T_RR_PARAMS; n1++)
-    {
-      total_rr[n].params[n1] = 0.0;
-    }
+  if((freq = realloc(xsection_freq, npoints * sizeof(double))) == NULL)
+    return EXIT_FAILURE;
+  xsection_freq = freq;
 
-  }
+  if((x = realloc(xsection_x, npoints * sizeof(double))) == NULL)
+    return EXIT_FAILURE;
+  xsection_x = x;
 
+  nxsection_points_max = npoints;
+  update_xsection_pointers();
 
-/* The following lines initialise the badnell total radiative recombination rate structure */
-  for(n = 0; n < NIONS; n++)
-  {
-    bad_gs_rr[n].nion = -1;
-    for(n1 = 0; n1 < BAD_GS_RR_PARAMS; n1++)
-    {
-      bad_gs_rr[n].temps[n1] = 0.0;
-      bad_gs_rr[n].rates[n1] = 0.0;
-    }
+  return EXIT_SUCCESS;
+}
 
-  }
-  gstmin = 0.0;
-  gstmax = 1e99;
+/* ************************************************************************** */
+/**
+ * @brief  Add the points of a x-section to the end of the x-section pools.
+ *
+ * @param[in,out]  xsection  The x-section the points belong to
+ * @param[in]      np        The number of points
+ * @param[in]      energy    The energy of each point in eV
+ * @param[in]      x         The cross section of each point in CGS
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the memory could not be allocated
+ *
+ * @details
+ *
+ * The pools grow geometrically. If the x-section already had points, such as
+ * when a TopBase ground state x-section is replaced by a VFKY one, the old
+ * points are left unused in the pools.
+ *
+ * ************************************************************************** */
+
+int
+add_xsection_points(TopPhotPtr xsection, int np, double energy[], double x[])
+{
+  int n;
 
+  if(nxsection_points + np > nxsection_points_max)
+    if(resize_xsection_points(2 * (nxsection_points + np)))
+      return EXIT_FAILURE;
 
-/* The following lines initialise the dere direct ionization rate struture */
-  for(n = 0; n < NIONS; n++)
-  {
-    dere_di_rate[n].nion = -1;
-    dere_di_rate[n].xi = 0.0;
-    dere_di_rate[n].min_temp = 1e99;
-    for(n1 = 0; n1 < DERE_DI_PARAMS; n1++)
-    {
-      dere_di_rate[n].temps[n1] = 0.0;
-      dere_di_rate[n].rates[n1] = 0.0;
-    }
+  xsection->offset = nxsection_points;
+  xsection->freq = &xsection_freq[xsection->offset];
+  xsection->x = &xsection_x[xsection->offset];
 
+  for(n = 0; n < np; n++)
+  {
+    xsection->freq[n] = energy[n] * EV2ERGS / H;  // convert from eV to freqency
+    xsection->x[n] = x[n];      // leave cross sections in  CGS
   }
 
+  nxsection_points += np;
+
+  return EXIT_SUCCESS;
+}
 
+/* ************************************************************************** */
+/**
+ * @brief  Get the path to one of the data files listed in a masterfile.
+ *
+ * @param[in]   file          The name of the data file as given in the masterfile
+ * @param[in]   use_relative  If TRUE, the name is used as the path
+ * @param[out]  path          The path to the data file
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if $PYTHON is required but not set
+ *
+ * @details
+ *
+ * When use_relative is FALSE, the data files are assumed to live in the
+ * Python installation given by $PYTHON, where the file names are relative to
+ * the xdata directory.
+ *
+ * ************************************************************************** */
 
+int
+get_atomic_data_file_path(char *file, int use_relative, char *path)
+{
+  char *python_file_path;
 
-/* The following lines initialise the Sutherland gaunt factors */
-  gaunt_n_gsqrd = 0;            //The number of sets of scaled temperatures we have data for
-  for(n = 0; n < MAX_GAUNT_N_GSQRD; n++)
+  if(use_relative)
   {
-    gaunt_total[n].log_gsqrd = 0.0;
-    gaunt_total[n].gff = 0.0;
-    gaunt_total[n].s1 = 0.0;
-    gaunt_total[n].s2 = 0.0;
-    gaunt_total[n].s3 = 0.0;
+    strcpy(path, file);
+    return EXIT_SUCCESS;
   }
 
+  if((python_file_path = getenv("PYTHON")) == NULL)
+    return EXIT_FAILURE;
+
+  strcpy(path, python_file_path);
+  if(path[strlen(path) - 1] != '/')
+    strcat(path, "/");
+  strcat(path, "x");
+  strcat(path, file);
+
+  return EXIT_SUCCESS;
+}
+
+/**********************************************************/
+/**
+ * @brief      generalized subroutine for reading atomic data
+ *  	into a set of structures defined in "atomic.h"
+ *
+ *
+ * @param [in] char  masterfile[]   The name of the "masterfile" which refers to other files which contain the data
+ * @return     Always returns 0
+ *
+ * @details
+ *
+ * get_atomic_data reads in all the atomic data.  It also converts the data to cgs units unless
+ * 	otherwise noted, e.g ionization potentials are converted to ergs.
+ *
+ *
+ *
+ * The masterfile is a list of other files, which contain atomic data for specific puruposes.
+ *
+ * All of the files are ascii.  The information is keyword based.
+ *
+ * The order of the data is important.  Elements should be defined before ions; ions
+ * before levels, levels before  lines etc.  In most if not all cases, one can either define all
+ * of the elements first, all of the ions, etc ... or the first element and its ions, the
+ * second element and its ions etc. Commenting out an element in the datafile has the effect of
+ * eliminating all of the data associated with that element, e.g ions, lines, etc.
+ *
+ * The program assumes that the ions for a given element are grouped together,
+ * that the levels for a given element are grouped together, etc.
+ *
+ * If one wants to read both Topbase and VFKY photoionization x-sections, then the topbase
+ * x-sections should be read first.  The routine will ignore data in the VFKY list if there
+ * is a pre-existing Topbase data.  The routine will stop if you but a VFKY x-section first
+ * on the assumption that Topbase data should trump VFKY data. (Making the program more flexible
+ * would be difficult because you would have to drop various bits of Topbase data out of the
+ * middle of the structure or mark it NG or something.)
+ *
+ * Similarly, as a general rule the macro information should be provided before the simple
+ * ions are described, and the macro lines should be presented before simple lines.
+ *
+ * The only data which can be mixed up completely is the line array.
+ *
+ * Finally, get_atomic_data creates a pointer array to  lines, which has the lines in
+ * frequency ascending order.   This is actually done by a small subroutine index_lines
+ * which in turn calls a Numerical Recipes routine.
+ *
+ * ### Notes ###
+ *
+ * get_atomic data is intended to be stand-alone, that is one should be able to use it for routines
+ * other than Python, e.g for another routine intended to calculate the ionization state of
+ * a plasma in collisional equilibrium.
+ *
+ * To this end, the routines populate stuctures in atomic.h, which are not part of python.h, and
+ * one should avoid calling routines like Exit(0) that are very python centric.  It's important
+ * that future modifications to get_atomic_data maintain this independence.
+ *
+ *
+ *
+ **********************************************************/
+
+int
+get_atomic_data(char *masterfile, int use_relative)
+{
+  int match;
+  int first_summary;
+  FILE *fptr, *mptr;
+  char aline[LINELENGTH];
+  char *file;
+  int nbatch, nbatches;
+  Batch_t *batches, *batch;
+  Record_t *record;
+  int n, m, i, j;
+  int n1, n2;                   //081115 nsh two new counters for DR - use new pointers to avoid any clashes!
+  int nparam;                   //081115 nsh temperary holder for number of DR parameters
+  double drp[MAX_DR_PARAMS];    //081115 nsh array to hold DR parameters prior to putting into structure
+  double btrr[T_RR_PARAMS];     //0712 nsh array to hole badnell total RR params before putting into structure
+  int ne, w;                    //081115 nsh new variables for DR variables
+  int mstart, mstop;
+  int nelem;
+  double gl, gu;
+  double el, eu;
+  int qnum;
+  double qqnum, ggg, gg;
+  int istate, z, nion;
+  int iistate, zz;
+  int levl, levu;
+  int in, il;                   //The levels used in inner shell data
+  double q;
+  double freq, f, exx, et, p;
+  double the_ground_frac[20];
+  char choice;
+  int lineno;                   /* the line number in the file beginning with 1 */
+  int cstren_no_line, cstren_duplicate;
+  int nwords;
+  int nlte, nmax;
+  int mflag;                    //flag to identify reading data for macro atoms
+  int nconfigl, nconfigu;       //internal labels for configurations
+  int islp, ilv, np;
+  char configname[RECORD_CHARS_LEN];
+  double e, rl;
+  double xe[NCROSS], xx[NCROSS];
+  int nlines_simple;
+  int nspline;
+  double tmin;
+  int nions_simple, nions_macro;
+  int nlevels_simple;
+  int ntop_phot_simple, ntop_phot_macro;
+  int bb_max, bf_max;
+  int lev_type;
+  int nn;
+  double gstemp[BAD_GS_RR_PARAMS];  //Temporary storage for badnell resolved GS RR rates
+  double temp[LINELENGTH];      //Temporary storage for data read in off a line this is enogh if every character on the
+  char gsflag[LINELENGTH], drflag[LINELENGTH]; //Flags to say what part of data is being read in for DR and RR
+  double gstmin, gstmax;        //The range of temperatures for which all ions have GS RR rates
+  double gsqrdtemp, gfftemp, s1temp, s2temp, s3temp;  //Temporary storage for gaunt factors
+  int n_elec_yield_tot;         //The number of inner shell cross sections with matching electron yield arrays
+  int inner_no_e_yield;         //The number of inner shell cross sections with no yields
+  double I, Ea;                 //The ionization energy and mean electron energy for electron yields
+  int c_l, c_u;                 //Chianti level indicators
+  double en, gf, hlt, sp;       //Parameters in collision strangth file
+  int type;                     //used in collision strength
+
+
+  /* define which files to read as data files */
+
+
+  AtomixConfiguration.atomic_data_loaded = FALSE;
+  start_memory_accounting();
+
+/* Allocate structures for storage of data */
+
+  if(reset_atomic_data())
+    return ATOMIC_MEMORY_ISSUE_ERROR;
+
+  n_elec_yield_tot = 0;         //Counter for electron yield
+  //  n_fluor_yield_tot = 0;     and fluorescent photon yields
+
+
+  gstmin = 0.0;
+  gstmax = 1e99;
+
 
 /* The following lines initialise the collision strengths */
-  n_coll_stren = 0;             //The number of data sets
   cstren_no_line = 0;           // counter to track how many times we don't find a matching line
-  for(n = 0; n < NLINES; n++)
-  {
-    coll_stren[n].n = -1;       //Internal index
-    coll_stren[n].lower = -1;   //The lower energy level - this is in Chianti notation and is currently unused
-    coll_stren[n].upper = -1;   //The upper energy level - this is in Chianti notation and is currently unused
-    coll_stren[n].energy = 0.0; //The energy of the transition
-    coll_stren[n].gf = 0.0;
-    coll_stren[n].hi_t_lim = 0.0; //The high temerature limit
-    coll_stren[n].n_points = 0.0; //The number of points in the splie fit
-    coll_stren[n].type = -1;    //The type of fit, this defines how one computes the scaled temperature and scaled coll strength
-    coll_stren[n].scaling_param = 0.0;  //The scaling parameter C used in the Burgess and Tully calculations
-    for(n1 = 0; n1 < N_COLL_STREN_PTS; n1++)
-    {
-      coll_stren[n].sct[n1] = 0.0;  //The scaled temperature points in the fit
-      coll_stren[n].scups[n1] = 0.0;
-    }
-  }
+  cstren_duplicate = 0;         // counter to track how many times a line already has a collision strength
 
 
 
@@ -1303,23 +2419,15 @@ structure does not have this property! */
   char *atomic_data_file_path = calloc(LINELENGTH, sizeof(char));
   char *sub_atomic_data_file_path = calloc(LINELENGTH, sizeof(char));
 
-  char *python_file_path;
-
   if(!use_relative)
   {
     char data[LINELENGTH];
-    if((python_file_path = getenv("PYTHON")) == NULL)
+    sprintf(data, "data/%s", masterfile);
+    if(get_atomic_data_file_path(data, use_relative, atomic_data_file_path))
     {
       logfile("Unable to find $PYTHON environment variable.\n");
       return ATOMIC_ENVRIONMENT_ERROR;
     }
-
-    if(python_file_path[strlen(python_file_path) - 1] != '/')
-      strcat(python_file_path, "/");
-
-    strcpy(atomic_data_file_path, python_file_path);
-    sprintf(data, "xdata/%s", masterfile);
-    strcat(atomic_data_file_path, data);
   }
   else
   {
@@ -1332,104 +2440,85 @@ structure does not have this property! */
     return ATOMIC_FILE_IO_ERROR;
   }
 
-  atomic_summary_add("Reading atomic data from %s", atomic_data_file_path);
+  atomic_summary_add("Reading atomic data from %s", atomic_data_file_path);
+  first_summary = ATOMIC_BUFFER.nlines;
+
+  /*
+   * If the same data has been read in before, restore it from the snapshot
+   * instead of parsing every file again
+   */
+
+  if(load_atomic_snapshot(atomic_data_file_path, use_relative) == EXIT_SUCCESS)
+  {
+    fclose(mptr);
+    atomic_summary_add("Atomic data restored from snapshot");
+    check_xsections();
+    free(sub_atomic_data_file_path);
+    free(atomic_data_file_path);
+    if(compact_xsections(AtomixConfiguration.xsection_error))
+    {
+      logfile("There is a problem in allocating memory to store the cross sections compactly\n");
+      return ATOMIC_MEMORY_ISSUE_ERROR;
+    }
+    mark_static_tables();
+    memory_summary();
+    AtomixConfiguration.atomic_data_loaded = TRUE;
+    return (0);
+  }
+
+/* Read each of the files listed in the masterfile into a batch of records */
+
+  if((nbatches = read_atomic_data_batches(mptr, use_relative, &batches)) < 0)
+  {
+    logfile("Get_atomic_data: Unable to allocate memory for reading the atomic data\n");
+    return ATOMIC_ERROR_TODO;
+  }
+
+  fclose(mptr);
+
+/* Process the records of each file in turn, in the order of the masterfile */
+
+  for(nbatch = 0; nbatch < nbatches; ++nbatch)
+  {
+    batch = &batches[nbatch];
+    file = batch->file;
+    strcpy(sub_atomic_data_file_path, batch->path);
+
+    if(batch->error)
+    {
+      logfile("Get_atomic_data: Could not open %s \n", sub_atomic_data_file_path);
+      return ATOMIC_FILE_IO_ERROR;
+    }
+
+    logfile("Get_atomic_data: Reading data from %s\n", sub_atomic_data_file_path);
+    lineno = 1;
 
-/* Open and read each line in the masterfile in turn */
+    /* Main loop for processing each line of the data file */
 
-  while(fgets(aline, LINELENGTH, mptr) != NULL)
-  {
-    if(sscanf(aline, "%s", file) == 1 && file[0] != '#')
+    while((record = get_next_record(batch)) != NULL)
     {
+      lineno++;
+      copy_record_line(record, aline, LINELENGTH);
+
+      if(record->choice != '*') /* A continuation means the record type remains the same */
+        choice = record->choice;
 
       /*
-       * Open one of the files designated in the masterfile and begin to read it
+       * A record adds at most one entry to a table, and the searches through
+       * the tables may look one entry past the last, so keep room for two more
        */
 
-      if(!use_relative)
-      {
-        char adata[LINELENGTH];
-        sprintf(adata, "x");
-        strcat(adata, file);
-        strcpy(sub_atomic_data_file_path, python_file_path);
-        strcat(sub_atomic_data_file_path, adata);
-      }
-      else
-      {
-        strcpy(sub_atomic_data_file_path, file);
-      }
-
-      if((fptr = fopen(sub_atomic_data_file_path, "r")) == NULL)
+      if(grow_ions(nions + 2) || grow_levels(nlevels + 2) || grow_lines(nlines + 2) ||
+         grow_coll_stren(n_coll_stren + 2) || grow_phot_top(nphot_total + 2) || grow_inner_cross(n_inner_tot + 2) ||
+         grow_drecomb(ndrecomb + 2) || grow_total_rr(n_total_rr + 2) || grow_bad_gs_rr(n_bad_gs_rr + 2) ||
+         grow_dere_di_rate(n_dere_di_rate + 2))
       {
-        logfile("Get_atomic_data: Could not open %s \n", sub_atomic_data_file_path);
-        return ATOMIC_FILE_IO_ERROR;
+        logfile("Get_atomic_data: file %s line %d: Unable to allocate memory for the atomic data\n", file, lineno);
+        return ATOMIC_MEMORY_ISSUE_ERROR;
       }
 
-      logfile("Get_atomic_data: Reading data from %s\n", sub_atomic_data_file_path);
-      lineno = 1;
-
-      /* Main loop for reading each data file line by line */
-
-      while(fgets(aline, LINELENGTH, fptr) != NULL)
+      switch (choice)
       {
-        lineno++;
-
-        strcpy(word, "");       /*For reasons which are not clear, word needs to be reinitialized every time to
-                                   properly deal with blank lines */
-
-        if(sscanf(aline, "%s", word) == 0 || strlen(word) == 0)
-          choice = 'c';         /*It's a a blank line, treated like a comment */
-        else if(strncmp(word, "!", 1) == 0)
-          choice = 'c';
-        else if(strncmp(word, "#", 1) == 0)
-          choice = 'c';         /* It's a comment */
-        else if(strncmp(word, "CSTREN", 6) == 0)  //collision strengths
-          choice = 'C';
-        else if(strncmp(word, "Element", 5) == 0)
-          choice = 'e';
-        else if(strncmp(word, "Ion", 3) == 0)
-          choice = 'i';
-        else if(strncmp(word, "LevTop", 6) == 0)
-          choice = 'N';
-        else if(strncmp(word, "LevMacro", 8) == 0)  // This indicated leves for a Macro Atom (SS)
-          choice = 'N';
-        else if(strncmp(word, "Level", 3) == 0) // There are various records of this type
-          choice = 'n';
-        else if(strncmp(word, "Phot", 4) == 0)  // There are various records of this type
-          choice = 'w';         // Macro Atom Phots are a subset of these (SS)
-        else if(strncmp(word, "Line", 4) == 0)
-          choice = 'r';
-        else if(strncmp(word, "LinMacro", 8) == 0)  //This indicates lines for a Macro Atom (SS)
-          choice = 'r';
-        else if(strncmp(word, "Frac", 4) == 0)
-          choice = 'f';         /*ground state fractions */
-        else if(strncmp(word, "InnerVYS", 8) == 0)
-          choice = 'I';         /*Its a set of inner shell photoionization cross sections */
-        else if(strncmp(word, "DR_BADNL", 8) == 0)  /* It's a badnell type dielectronic recombination file */
-          choice = 'D';
-        else if(strncmp(word, "DR_SHULL", 8) == 0)  /*its a schull type dielectronic recombination */
-          choice = 'S';
-        else if(strncmp(word, "RR_BADNL", 8) == 0)  /*Its a badnell type line in the total RR file */
-          choice = 'T';
-        else if(strncmp(word, "DI_DERE", 7) == 0) /*Its a data file giving direct ionization rates from Dere (2007) */
-          choice = 'd';
-        else if(strncmp(word, "RR_SHULL", 8) == 0)  /*Its a shull type line in the total RR file */
-          choice = 's';
-        else if(strncmp(word, "BAD_GS_RR", 9) == 0) /*Its a badnell resolved ground state RR file */
-          choice = 'G';
-        else if(strncmp(word, "FF_GAUNT", 8) == 0)  /*Its a data file giving the temperature averaged gaunt factors from Sutherland (1998) */
-          choice = 'g';
-        else if(strncmp(word, "Kelecyield", 10) == 0) /*Electron yield from inner shell ionization fro Kaastra and Mewe */
-          choice = 'K';
-//        else if (strncmp (word, "Kphotyield", 10) == 0) /*Floruescent photon yield from IS ionization from Kaastra and Mewe */
-//          choice = 'F';
-        else if(strncmp(word, "*", 1) == 0);  /* It's a continuation so record type remains same */
-
-        else
-          choice = 'z';         /* Who knows what it is */
-
-
-        switch (choice)
-        {
 /**
  * @section Elements
  *
@@ -1440,23 +2529,30 @@ structure does not have this property! */
  * where 6 here refers to z of the elemnt, C is the name, and 8.56 is the abundance relative to H at 12
  *
  * */
-          case 'e':
-            if(sscanf(aline, "%*s %d %s %le", &ele[nelements].z, ele[nelements].name, &ele[nelements].abun) != 3)
-            {
-              logfile("Get_atomic_data: file %s line %d: Element line incorrectly formatted\n", file, lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              exit(0);
-            }
-            ele[nelements].abun = pow(10., ele[nelements].abun - 12.0); /* Immediate replace by number density relative to H */
-            nelements++;
-            if(nelements > NELEMENTS)
-            {
-              logfile("getatomic_data: file %s line %d: More elements than allowed. Increase NELEMENTS in atomic.h\n",
-                      file, lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
-            break;
+        case 'e':
+          if(record_scanf(record, RECORD_ELEMENT, &ele[nelements].z, ele[nelements].name, &ele[nelements].abun) != 3)
+          {
+            logfile("Get_atomic_data: file %s line %d: Element line incorrectly formatted\n", file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            exit(0);
+          }
+          ele[nelements].abun = pow(10., ele[nelements].abun - 12.0); /* Immediate replace by number density relative to H */
+          if(add_element_lookup(nelements))
+          {
+            logfile("get_atomic_data: file %s line %d: Element has z %d, but the largest allowed is %d\n", file, lineno,
+                    ele[nelements].z, ZMAX);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          nelements++;
+          if(nelements > NELEMENTS)
+          {
+            logfile("getatomic_data: file %s line %d: More elements than allowed. Increase NELEMENTS in atomic.h\n",
+                    file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          break;
 
 
 /**
@@ -1485,66 +2581,68 @@ structure does not have this property! */
  *
  */
 
-          case 'i':
+        case 'i':
 
-            if((nwords = sscanf(aline, "%*s %*s %d %d %le %le %d %d", &z, &istate, &gg, &p, &nmax, &nlte)) != 6)
-            {
-              logfile("get_atomic_data: file %s line %d: Ion istate line incorrectly formatted\n", file, lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_FILE_FORMAT_ERROR;
-            }
+          if((nwords = record_scanf(record, RECORD_ION, &z, &istate, &gg, &p, &nmax, &nlte)) != 6)
+          {
+            logfile("get_atomic_data: file %s line %d: Ion istate line incorrectly formatted\n", file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_FILE_FORMAT_ERROR;
+          }
 // Now check that an element line for this ion has already been read
-            n = 0;
-            while(ele[n].z != z && n < nelements)
-              n++;
-            if(n == nelements)
-            {
+          if(element_index(z) < 0)
+          {
 
-              logfile_error("get_atomic_data: file %s line %d has ion for unknown element with z %d\n", file, lineno,
-                            z);
-              break;
-            }
+            logfile_error("get_atomic_data: file %s line %d has ion for unknown element with z %d\n", file, lineno,
+                          z);
+            break;
+          }
+          if(istate < 1 || istate > z + 1)
+          {
+            logfile("get_atomic_data: file %s line %d: Ion has ionization state %d, which is not possible for z %d\n",
+                    file, lineno, istate, z);
+            break;
+          }
+          if(ion_index(z, istate) >= 0)
+          {
+            logfile("get_atomic_data: file %s line %d: Ion z %d istate %d has already been read, so the first one will be used\n",
+                    file, lineno, z, istate);
+          }
 
 // Now populate the ion structure
 
-            if(nlte > 0)
-            {                   // Then we want to consider some of these levels as non-lte
-              ions[nions].first_levden = nlte_levels; /* This is the index to into
-                                                         the levden aray */
-              ions[nions].n_lte_max = nlte; //Reserve this many elements of levden
-              nlte_levels += nlte;
-              if(nlte_levels > NLTE_LEVELS)
-              {
-                logfile("get_atomic_data: nlte_levels (%d) > NLTE_LEVELS (%d)\n", nlte_levels, NLTE_LEVELS);
-                return ATOMIC_MAX_NLTE_ERROR;
-              }
-
-            }
-            ions[nions].z = z;
-            ions[nions].istate = istate;
-            ions[nions].g = gg;
-            ions[nions].ip = p * EV2ERGS;
-            ions[nions].nmax = nmax;
-/* Use the keyword IonM to classify the ion as a macro-ion (IonM) or not (simply Ion) */
-            if(strncmp(word, "IonM", 4) == 0)
-            {
-              ions[nions].macro_info = 1;
-              nions_macro++;
-            }
-            else
-            {
-              ions[nions].macro_info = 0;
-              nions_simple++;
-            }
-            nions++;
-            if(nions == NIONS)
+          if(nlte > 0)
+          {                   // Then we want to consider some of these levels as non-lte
+            ion_links[nions].first_levden = nlte_levels; /* This is the index to into
+                                                       the levden aray */
+            ion_links[nions].n_lte_max = nlte; //Reserve this many elements of levden
+            nlte_levels += nlte;
+            if(nlte_levels > NLTE_LEVELS)
             {
-              logfile
-                ("getatomic_data: file %s line %d: %d ions is more than %d allowed. Increase NIONS in atomic.h\n",
-                 file, lineno, nions, NIONS);
-              return ATOMIC_MAX_NIONS_ERROR;
+              logfile("get_atomic_data: nlte_levels (%d) > NLTE_LEVELS (%d)\n", nlte_levels, NLTE_LEVELS);
+              return ATOMIC_MAX_NLTE_ERROR;
             }
-            break;
+
+          }
+          ions[nions].z = z;
+          ions[nions].istate = istate;
+          ions[nions].g = gg;
+          ions[nions].ip = p * EV2ERGS;
+          ion_links[nions].nmax = nmax;
+/* Use the keyword IonM to classify the ion as a macro-ion (IonM) or not (simply Ion) */
+          if(record->keyword == KEYWORD_IONM)
+          {
+            ions[nions].macro_info = 1;
+            nions_macro++;
+          }
+          else
+          {
+            ions[nions].macro_info = 0;
+            nions_simple++;
+          }
+          add_ion_lookup(nions);
+          nions++;
+          break;
 
 /**
  * @section levels Levels or Configurations
@@ -1654,9 +2752,9 @@ structure does not have this property! */
  * */
 
 
-          case 'N':
+        case 'N':
 /*
-    It's a non-lte level, i.e. one for which we are going to calculate populations, at least for some number of these.
+  It's a non-lte level, i.e. one for which we are going to calculate populations, at least for some number of these.
 	For these, we have to set aside space in the levden array in the plasma structure.  This is used for topbase
 	photoionization and macro atoms
 */
@@ -1671,60 +2769,57 @@ the program working in both cases, and certainly mixed cases  04apr ksl  */
  * last bit is not actually new.
  */
 
-            if(strncmp(word, "LevTop", 6) == 0)
-            {                   //Its a TOPBASESTYLE level
-              sscanf(aline,
-                     "%*s %d %d %d %d %le %le %le %le %le %15c \n", &zz, &iistate, &islp, &ilv, &e, &exx, &ggg, &qqnum,
-                     &rl, configname);
-              istate = iistate;
-              z = zz;
-              gg = ggg;
-              exx *= EV2ERGS;   // Convert energy above ground to ergs
-              mflag = -1;       //record that this is a LevTop not LevMacro read
-              lev_type = 2;     // It's a topbase record
-            }
+          if(record->keyword == KEYWORD_LEVTOP)
+          {                   //Its a TOPBASESTYLE level
+            record_scanf(record, RECORD_LEVTOP, &zz, &iistate, &islp, &ilv, &e, &exx, &ggg, &qqnum,
+                         &rl, configname);
+            istate = iistate;
+            z = zz;
+            gg = ggg;
+            exx *= EV2ERGS;   // Convert energy above ground to ergs
+            mflag = -1;       //record that this is a LevTop not LevMacro read
+            lev_type = 2;     // It's a topbase record
+          }
 
-            else if(strncmp(word, "LevMacro", 8) == 0)
-            {                   //It's a Macro Atom level (SS)
-              sscanf(aline, "%*s %d %d %d %le %le %le %le %15c \n", &zz, &iistate, &ilv, &e, &exx, &ggg, &rl,
-                     configname);
-              islp = -1;        //these indices are not going to be used so just leave
-              qqnum = -1;       //them at -1
-              mflag = 1;        //record Macro read
-              lev_type = 1;     // It's a Macro record
-              istate = iistate;
-              z = zz;
-              gg = ggg;
-              exx *= EV2ERGS;   // Convert energy to ergs
-            }
-            else
-            {
-              logfile("get_atomic_data: file %s line %d: Level line incorrectly formatted\n", file, lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_FILE_FORMAT_ERROR;
-            }
+          else if(record->keyword == KEYWORD_LEVMACRO)
+          {                   //It's a Macro Atom level (SS)
+            record_scanf(record, RECORD_LEVMACRO, &zz, &iistate, &ilv, &e, &exx, &ggg, &rl,
+                         configname);
+            islp = -1;        //these indices are not going to be used so just leave
+            qqnum = -1;       //them at -1
+            mflag = 1;        //record Macro read
+            lev_type = 1;     // It's a Macro record
+            istate = iistate;
+            z = zz;
+            gg = ggg;
+            exx *= EV2ERGS;   // Convert energy to ergs
+          }
+          else
+          {
+            logfile("get_atomic_data: file %s line %d: Level line incorrectly formatted\n", file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_FILE_FORMAT_ERROR;
+          }
 // Now check that the ion for this level is already known.  If not break out
-            n = 0;
-            while((ions[n].z != z || ions[n].istate != istate) && n < nions)
-              n++;
-            if(n == nions)
-            {
+          n = ion_index(z, istate);
+          if(n < 0)
+          {
 
-              logfile_error("get_atomic_data: file %s line %d has level for unknown ion \n", file, lineno);
-              break;
-            }
+            logfile_error("get_atomic_data: file %s line %d has level for unknown ion \n", file, lineno);
+            break;
+          }
 
-            /* Check that for a non-lte (macro atom) that the configuration level is not greater than was allowed for in the
-             * ion line
-             */
+          /* Check that for a non-lte (macro atom) that the configuration level is not greater than was allowed for in the
+           * ion line
+           */
 
-            if(lev_type == 1 && ilv > ions[n].n_lte_max)
-            {
-              logfile("get_atomic_data: macro level %d ge %d for z %d  istate %d\n", ilv, ions[n].n_lte_max, ions[n].z,
-                      ions[n].istate);
-              //exit(0);
-              break;
-            }
+          if(lev_type == 1 && ilv > ion_links[n].n_lte_max)
+          {
+            logfile("get_atomic_data: macro level %d ge %d for z %d  istate %d\n", ilv, ion_links[n].n_lte_max,
+                    ions[n].z, ions[n].istate);
+            //exit(0);
+            break;
+          }
 
 /*  So now we know that this level can be associated with an ion
 
@@ -1732,14 +2827,14 @@ Now either set the type of level that will be used for this ion or set it if
 a level type has not been established
 		   */
 
-            if(ions[n].lev_type == (-1))
-            {
-              ions[n].lev_type = lev_type;
-            }
-            else if(ions[n].lev_type != lev_type)
-            {
-              break;
-            }
+          if(ions[n].lev_type == (-1))
+          {
+            ions[n].lev_type = lev_type;
+          }
+          else if(ions[n].lev_type != lev_type)
+          {
+            break;
+          }
 
 /*
  Now check 1) if it was a LevMacro that there isn't already a LevTop (if there was then
@@ -1750,91 +2845,91 @@ a level type has not been established
 
 
 // Next steps should never happen; we have added a more robust mechanism to prevent any kind of mix and match above
-            if(ions[n].macro_info == 1 && mflag == -1)
-            {                   //it is already flagged as macro atom - current read is for LevTop - don't use it (SS)
-              logfile("Get_atomic_data: file %s  Ignoring LevTop data for ion %d - already using Macro Atom data\n",
-                      file, n);
-              break;
-            }
-            if(ions[n].macro_info == 0 && mflag == 1)
-            {                   //It is already flagged as simple atom and this is  before MacroAtom data - so ignore.  ksl
-              logfile
-                ("Get_atomic_data: file %s  Trying to read MacroAtom data after LevTop data for ion %d. Not allowed\n",
-                 file, n);
-              break;
-            }
-
+          if(ions[n].macro_info == 1 && mflag == -1)
+          {                   //it is already flagged as macro atom - current read is for LevTop - don't use it (SS)
+            logfile("Get_atomic_data: file %s  Ignoring LevTop data for ion %d - already using Macro Atom data\n",
+                    file, n);
+            break;
+          }
+          if(ions[n].macro_info == 0 && mflag == 1)
+          {                   //It is already flagged as simple atom and this is  before MacroAtom data - so ignore.  ksl
+            logfile
+              ("Get_atomic_data: file %s  Trying to read MacroAtom data after LevTop data for ion %d. Not allowed\n",
+               file, n);
+            break;
+          }
 
-            // case where data will be used (SS)
-            if(mflag == 1)
-            {
-              config[nlevels].macro_info = 1;
 
-              /* Extra check added here to be sure that the level emissivities used in the
-                 detailed spectrum calculation won't get messed up. The next loop should
-                 never trigger and can probably be deleted but I just want to check it for now.
-                 SS June 04. */
+          // case where data will be used (SS)
+          if(mflag == 1)
+          {
+            config[nlevels].macro_info = 1;
 
-              if(nlevels_macro != nlevels)
-              {
-                logfile("get_atomicdata: Simple level has appeared before macro level. Not allowed.\n");
-                return ATOMIC_MACRO_ERROR;
-              }
-              nlevels_macro++;
+            /* Extra check added here to be sure that the level emissivities used in the
+               detailed spectrum calculation won't get messed up. The next loop should
+               never trigger and can probably be deleted but I just want to check it for now.
+               SS June 04. */
 
-              if(nlevels_macro > NLEVELS_MACRO)
-              {
-                logfile("get_atomicdata: Too many macro atom levels. Increase NLEVELS_MACRO. Abort. \n");
-                return ATOMIC_MACRO_ERROR;
-              }
-            }
-            else
+            if(nlevels_macro != nlevels)
             {
-              config[nlevels].macro_info = 0;
-              nlevels_simple++;
+              logfile("get_atomicdata: Simple level has appeared before macro level. Not allowed.\n");
+              return ATOMIC_MACRO_ERROR;
             }
+            nlevels_macro++;
 
-            config[nlevels].z = z;
-            config[nlevels].istate = istate;
-            config[nlevels].isp = islp;
-            config[nlevels].ilv = ilv;
-            config[nlevels].nion = n; //Internal index to ion structure
-            config[nlevels].q_num = qqnum;
-            config[nlevels].g = gg;
-            config[nlevels].ex = exx;
-            config[nlevels].rad_rate = rl;
-            /* SS Aug 2005
-               Previously, the line above set the rad_rate to 0 and is was never used.
-               Now I'm setting it to the radiative lifetime of the level.
-               It will now be used in the macro atom calculation - if the lifetime is
-               set to be long (infinite) in the input data, the level is assumed to be
-               collisional supported by the ground state (i.e. has the LTE excitation
-               fraction relative to ground).
-             */
-
+            if(nlevels_macro > NLEVELS_MACRO)
+            {
+              logfile("get_atomicdata: Too many macro atom levels. Increase NLEVELS_MACRO. Abort. \n");
+              return ATOMIC_MACRO_ERROR;
+            }
+          }
+          else
+          {
+            config[nlevels].macro_info = 0;
+            nlevels_simple++;
+          }
 
-            if(ions[n].n_lte_max > 0)
-            {                   // Then this ion wants nlte levels
-              if(ions[n].first_nlte_level < 0)
-              {                 // Then this is the first one that has been found
-                ions[n].first_nlte_level = nlevels;
-                ions[n].nlte = 1;
-                config[nlevels].nden = ions[n].first_levden;
-              }
-              else if(ions[n].n_lte_max > ions[n].nlte)
-              {
-                config[nlevels].nden = ions[n].first_levden + ions[n].nlte;
-                ions[n].nlte++;
-              }
-              else
-              {
-                config[nlevels].nden = -1;
-              }
+          config[nlevels].z = z;
+          config[nlevels].istate = istate;
+          config[nlevels].isp = islp;
+          config[nlevels].ilv = ilv;
+          config[nlevels].nion = n; //Internal index to ion structure
+          config[nlevels].q_num = qqnum;
+          config[nlevels].g = gg;
+          config[nlevels].ex = exx;
+          config[nlevels].rad_rate = rl;
+          /* SS Aug 2005
+             Previously, the line above set the rad_rate to 0 and is was never used.
+             Now I'm setting it to the radiative lifetime of the level.
+             It will now be used in the macro atom calculation - if the lifetime is
+             set to be long (infinite) in the input data, the level is assumed to be
+             collisional supported by the ground state (i.e. has the LTE excitation
+             fraction relative to ground).
+           */
+
+
+          if(ion_links[n].n_lte_max > 0)
+          {                   // Then this ion wants nlte levels
+            if(ions[n].first_nlte_level < 0)
+            {                 // Then this is the first one that has been found
+              ions[n].first_nlte_level = nlevels;
+              ions[n].nlte = 1;
+              config[nlevels].nden = ion_links[n].first_levden;
+            }
+            else if(ion_links[n].n_lte_max > ions[n].nlte)
+            {
+              config[nlevels].nden = ion_links[n].first_levden + ions[n].nlte;
+              ions[n].nlte++;
             }
             else
             {
               config[nlevels].nden = -1;
             }
+          }
+          else
+          {
+            config[nlevels].nden = -1;
+          }
 
 
 /* Now associate this config with the levden array where appropriate.  The -1 is because ion[].nlte
@@ -1842,148 +2937,139 @@ is already incremented
 
 */
 
-            if(ions[n].firstlevel < 0)
-            {
-              ions[n].firstlevel = nlevels;
-              ions[n].nlevels = 1;
-            }
-            else
-              ions[n].nlevels++;
-
-
-
-            nlevels++;
+          if(ions[n].firstlevel < 0)
+          {
+            ions[n].firstlevel = nlevels;
+            ions[n].nlevels = 1;
+          }
+          else
+            ions[n].nlevels++;
 
-            if(nlevels > NLEVELS)
-            {
-              logfile
-                ("getatomic_data: file %s line %d: More energy levels than allowed. Increase NLEVELS in atomic.h\n",
-                 file, lineno);
-              return ATOMIC_MAX_LEVELS_ERROR;
-            }
-            break;
+          if(index_config_key(nlevels))
+          {
+            logfile("Get_atomic_data: Unable to allocate memory for the index of levels\n");
+            return ATOMIC_MEMORY_ISSUE_ERROR;
+          }
+          nlevels++;
+          break;
 
-          case 'n':            // Its an "LTE" level
+        case 'n':            // Its an "LTE" level
 
-            if(sscanf(aline, "%*s %d %d %d %le %le\n", &zz, &iistate, &qnum, &gg, &exx) == 5) //IT's KURUCZSTYLE
-            {
-              istate = iistate;
-              z = zz;
-              exx *= EV2ERGS;
-              qqnum = ilv = qnum;
-              lev_type = 0;     // It's a Kurucz-style record
+          if(record_scanf(record, RECORD_LEVEL_KURUCZ, &zz, &iistate, &qnum, &gg, &exx) == 5) //IT's KURUCZSTYLE
+          {
+            istate = iistate;
+            z = zz;
+            exx *= EV2ERGS;
+            qqnum = ilv = qnum;
+            lev_type = 0;     // It's a Kurucz-style record
 
-            }
-            else                // Read an OLDSTYLE level description
-            if(sscanf(aline, "%*s  %d %le %le\n", &qnum, &gg, &exx) == 3)
-            {
-              exx *= EV2ERGS;
-              qqnum = ilv = qnum;
-              lev_type = -2;    // It's an old style record, one which is only here for backward compatibility
-            }
-            else
-            {
-              logfile("get_atomic_data: file %s line %d: Level line incorrectly formatted\n", file, lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-              return ATOMIC_FILE_FORMAT_ERROR;
-            }
+          }
+          else                // Read an OLDSTYLE level description
+          if(record_scanf(record, RECORD_LEVEL_OLD, &qnum, &gg, &exx) == 3)
+          {
+            exx *= EV2ERGS;
+            qqnum = ilv = qnum;
+            lev_type = -2;    // It's an old style record, one which is only here for backward compatibility
+          }
+          else
+          {
+            logfile("get_atomic_data: file %s line %d: Level line incorrectly formatted\n", file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+            return ATOMIC_FILE_FORMAT_ERROR;
+          }
 /* Check whether the ion for this level is known.  If not, skip the level */
 
 // Next section is identical already to case N
-            n = 0;
-            while((ions[n].z != z || ions[n].istate != istate) && n < nions)
-              n++;
-            if(n == nions)
-            {
+          n = ion_index(z, istate);
+          if(n < 0)
+          {
 
-              logfile_error("get_atomic_data: file %s line %d has level for unknown ion \n", file, lineno);
-              break;
+            logfile_error("get_atomic_data: file %s line %d has level for unknown ion \n", file, lineno);
+            break;
 
-            }
+          }
 
-            /* Now either set the type of level that will be used for this ion or set it if
-             * a level type has not been established
-             */
+          /* Now either set the type of level that will be used for this ion or set it if
+           * a level type has not been established
+           */
 
-            if(ions[n].lev_type == (-1))
-            {
-              ions[n].lev_type = lev_type;
-            }
-            else if(ions[n].lev_type != lev_type)
-            {
+          if(ions[n].lev_type == (-1))
+          {
+            ions[n].lev_type = lev_type;
+          }
+          else if(ions[n].lev_type != lev_type)
+          {
 
-              break;
-            }
+            break;
+          }
 //  End section known to be idential to case N
 
 
 /* Check whether this is a macro-ion.  If it is a macro-ion, but the level appears to be described as a
 simple level (i.e without a keyword LeVMacro), then skip it, since a macro-ion has to have all the levels
 described as macro-levels. */
-            if(ions[n].macro_info == 1)
-            {
-              logfile("get_atomic_data: file %s line %d has simple level for ion[%d], which is a macro-ion\n", file,
-                      lineno, n);
-              break;
-            }
+          if(ions[n].macro_info == 1)
+          {
+            logfile("get_atomic_data: file %s line %d has simple level for ion[%d], which is a macro-ion\n", file,
+                    lineno, n);
+            break;
+          }
 /* Check to prevent one from adding simple levels to an ionized that already has some nlte levels.  Note that
-   an ion may have simple levels, i.e. levels with no entries in the plasma structure levden array, but this
-   will only be the case if there are too many of this type of level.
+ an ion may have simple levels, i.e. levels with no entries in the plasma structure levden array, but this
+ will only be the case if there are too many of this type of level.
 */
-            if(ions[n].nlte > 0)
-            {
-              logfile("get_atomic_data:  file %s line %d has simple level for ion[%d], which has non_lte_levels\n",
-                      file, lineno, n);
-              break;
-            }
+          if(ions[n].nlte > 0)
+          {
+            logfile("get_atomic_data:  file %s line %d has simple level for ion[%d], which has non_lte_levels\n",
+                    file, lineno, n);
+            break;
+          }
 
 /*  Check whether we already have too many levels specified for this ion. If so, skip */
-            if(ions[n].nmax == ions[n].nlevels)
-            {
+          if(ion_links[n].nmax == ions[n].nlevels)
+          {
 
-              logfile_error("get_atomic_data: file %s line %d has level exceeding the number allowed for ion[%d]\n",
-                            file, lineno, n);
+            logfile_error("get_atomic_data: file %s line %d has level exceeding the number allowed for ion[%d]\n",
+                          file, lineno, n);
 
-              break;
-            }
+            break;
+          }
 //  So now we know that this level can be associated with an ion
 
-            config[nlevels].z = z;
-            config[nlevels].istate = istate;
-            config[nlevels].isp = islp;
-            config[nlevels].ilv = ilv;
-            config[nlevels].nion = n; //Internal index to ion structure
-            config[nlevels].q_num = qqnum;
-            config[nlevels].g = gg;
-            config[nlevels].ex = exx;
-            if(ions[n].firstlevel < 0)
-            {
-              ions[n].firstlevel = nlevels;
-              ions[n].nlevels = 1;
-            }
-            else
-              ions[n].nlevels++;
+          config[nlevels].z = z;
+          config[nlevels].istate = istate;
+          config[nlevels].isp = islp;
+          config[nlevels].ilv = ilv;
+          config[nlevels].nion = n; //Internal index to ion structure
+          config[nlevels].q_num = qqnum;
+          config[nlevels].g = gg;
+          config[nlevels].ex = exx;
+          if(ions[n].firstlevel < 0)
+          {
+            ions[n].firstlevel = nlevels;
+            ions[n].nlevels = 1;
+          }
+          else
+            ions[n].nlevels++;
 
 
 /* Now declare that this level has no corresponding element in the levden array which is part
-   of the plasma stucture.  To do this set config[].ndent to -1
+ of the plasma stucture.  To do this set config[].ndent to -1
 */
 
-            config[nlevels].nden = -1;
+          config[nlevels].nden = -1;
 
-            config[nlevels].rad_rate = 0.0; // ?? Set emission oscillator strength for the level to zero
+          config[nlevels].rad_rate = 0.0; // ?? Set emission oscillator strength for the level to zero
 
-            nlevels_simple++;
-            nlevels++;
-            if(nlevels > NLEVELS)
-            {
-              logfile
-                ("getatomic_data: file %s line %d: More energy levels than allowed. Increase NLEVELS in atomic.h\n",
-                 file, lineno);
-              return ATOMIC_MAX_LEVELS_ERROR;
-            }
-            break;
+          if(index_config_key(nlevels))
+          {
+            logfile("Get_atomic_data: Unable to allocate memory for the index of levels\n");
+            return ATOMIC_MEMORY_ISSUE_ERROR;
+          }
+          nlevels_simple++;
+          nlevels++;
+          break;
 
 
 
@@ -2066,389 +3152,342 @@ described as macro-levels. */
  *   		one need modify only the higher level elements_ions file
  */
 
-          case 'w':
-            if(strncmp(word, "PhotMacS", 8) == 0)
-            {
-              // It's a Macro atom entry - similar format to TOPBASE - see below (SS)
-              sscanf(aline, "%*s %d %d %d %d %le %d\n", &z, &istate, &levl, &levu, &exx, &np);
-              islp = -1;
-              ilv = -1;
-
-              for(n = 0; n < np; n++)
-              {
-                //Read the photo. records but do nothing with them until verifyina a valid level
-                if(fgets(aline, LINELENGTH, fptr) == NULL)
-                {
-                  logfile("Get_atomic_data: Problem reading topbase photoionization record\n");
-                  logfile("Get_atomic_data: %s\n", aline);
-                  return ATOMIC_ERROR_TODO;
-                }
-                sscanf(aline, "%*s %le %le", &xe[n], &xx[n]);
-                lineno++;
-              }
-
-              // Locate upper state
-              n = 0;
-              while((config[n].z != z || config[n].istate != (istate + 1) //note that the upper config will (SS)
-                     || config[n].ilv != levu) && n < nlevels)  //be the next ion up (istate +1) (SS)
-                n++;
-              if(n == nlevels)
-              {
-                logfile_error("get_atomic_data: No configuration found to match upper state for phot. line %d\n",
-                              lineno);
-                break;          //Need to match the configuration for macro atoms - break if not found.
-              }
-
-
-              // Locate lower state
-              m = 0;
-              while((config[m].z != z || config[m].istate != istate //Now searching for the lower
-                     || config[m].ilv != levl) && m < nlevels)  //configuration (SS)
-                m++;
-              if(m == nlevels)
-              {
-                logfile_error("get_atomic_data: No configuration found to match lower state for phot. line %d\n",
-                              lineno);
-                break;          //Need to match the configuration for macro atoms - break if not found.
-              }
-
-              // Populate upper state info
-              phot_top[ntop_phot].uplev = n;  //store the level in the upper ion (SS)
-              config[n].bfd_jump[config[n].n_bfd_jump] = ntop_phot; //record the line index as a downward bf Macro Atom jump (SS)
-              phot_top[ntop_phot].down_index = config[n].n_bfd_jump;  //record jump index in the photoionization structure
-              config[n].n_bfd_jump += 1;  //note that there is one more downwards bf jump available (SS)
-              if(config[n].n_bfd_jump > NBFJUMPS)
-              {
-                logfile("get_atomic_data: Too many downward b-f jump for ion %d\n", config[n].istate);
-                return ATOMIC_ERROR_TODO;
-              }
-
-
-              // Populate lower state info
-              phot_top[ntop_phot].nlev = m; //store lower configuration then find upper configuration(SS)
-              config[m].bfu_jump[config[m].n_bfu_jump] = ntop_phot; //record the line index as an upward bf Macro Atom jump (SS)
-              phot_top[ntop_phot].up_index = config[m].n_bfu_jump;  //record the jump index in the photoionization structure
-              config[m].n_bfu_jump += 1;  //note that there is one more upwards bf jump available (SS)
-              if(config[m].n_bfu_jump > NBFJUMPS)
-              {
-                logfile("get_atomic_data: Too many upward b-f jump for ion %d\n", config[m].istate);
-                return ATOMIC_ERROR_TODO;
-              }
-
-
-              phot_top[ntop_phot].nion = config[m].nion;
-              phot_top[ntop_phot].z = z;
-              phot_top[ntop_phot].istate = istate;
-              phot_top[ntop_phot].np = np;
-              phot_top[ntop_phot].nlast = -1;
-              phot_top[ntop_phot].macro_info = 1;
-
-              if(ions[config[m].nion].phot_info == -1)
-              {
-                ions[config[m].nion].phot_info = 1; /* Mark this ion as using TOPBASE photo */
-                ions[config[m].nion].ntop_first = ntop_phot;
-              }
-
-              /* next line sees if the topbase level just read in is the ground state -
-                 if it is, the ion structure element ntop_ground is set to that topbase level number
-                 note that m is the lower level here */
-              if(m == config[ions[config[n].nion].first_nlte_level].ilv)
-              {
-                ions[config[n].nion].ntop_ground = ntop_phot;
-              }
-
-              ions[config[m].nion].ntop++;
-
-              // Finish up this section by storing the photionization data properly
+        case 'w':
+          if(record->keyword == KEYWORD_PHOTMACS)
+          {
+            // It's a Macro atom entry - similar format to TOPBASE - see below (SS)
+            record_scanf(record, RECORD_PHOT, &z, &istate, &levl, &levu, &exx, &np);
+            islp = -1;
+            ilv = -1;
 
-              for(n = 0; n < np; n++)
+            for(n = 0; n < np; n++)
+            {
+              //Read the photo. records but do nothing with them until verifyina a valid level
+              if((record = get_next_record(batch)) == NULL)
               {
-                phot_top[ntop_phot].freq[n] = xe[n] * EV2ERGS / H;  // convert from eV to freqency
-                phot_top[ntop_phot].x[n] = xx[n]; // leave cross sections in  CGS
+                logfile("Get_atomic_data: Problem reading topbase photoionization record\n");
+                logfile("Get_atomic_data: %s\n", aline);
+                return ATOMIC_ERROR_TODO;
               }
-              if(phot_freq_min > phot_top[ntop_phot].freq[0])
-                phot_freq_min = phot_top[ntop_phot].freq[0];
+              copy_record_line(record, aline, LINELENGTH);
+              record_scanf(record, RECORD_POINT, &xe[n], &xx[n]);
+              lineno++;
+            }
 
+            // Locate upper state
+            n = find_config(z, istate + 1, levu, -1); //note that the upper config will be the next ion up (istate +1) (SS)
+            if(n < 0)
+            {
+              logfile_error("get_atomic_data: No configuration found to match upper state for phot. line %d\n",
+                            lineno);
+              break;          //Need to match the configuration for macro atoms - break if not found.
+            }
 
-              ntop_phot_macro++;
-              ntop_phot++;
-              nphot_total++;
 
-              if(nphot_total > NTOP_PHOT)
-              {
-                logfile
-                  ("get_atomicdata: More macro photoionization cross sections that NTOP_PHOT (%d).  Increase in atomic.h\n",
-                   NTOP_PHOT);
-                return ATOMIC_ERROR_TODO;
-              }
-              break;
+            // Locate lower state
+            m = find_config(z, istate, levl, -1); //Now searching for the lower configuration (SS)
+            if(m < 0)
+            {
+              logfile_error("get_atomic_data: No configuration found to match lower state for phot. line %d\n",
+                            lineno);
+              break;          //Need to match the configuration for macro atoms - break if not found.
             }
 
+            // Populate upper state info
+            phot_top[ntop_phot].uplev = n;  //store the level in the upper ion (SS)
+            if(add_macro_jump(JUMP_BF_DOWN, n, ntop_phot))  //record the line index as a downward bf Macro Atom jump (SS)
+            {
+              logfile("get_atomic_data: Unable to allocate memory for the Macro Atom jumps\n");
+              return ATOMIC_MEMORY_ISSUE_ERROR;
+            }
+            phot_top[ntop_phot].down_index = config[n].n_bfd_jump;  //record jump index in the photoionization structure
+            config[n].n_bfd_jump += 1;  //note that there is one more downwards bf jump available (SS)
 
 
-            else if(strncmp(word, "PhotTopS", 8) == 0)
+            // Populate lower state info
+            phot_top[ntop_phot].nlev = m; //store lower configuration then find upper configuration(SS)
+            if(add_macro_jump(JUMP_BF_UP, m, ntop_phot)) //record the line index as an upward bf Macro Atom jump (SS)
             {
-              // It's a TOPBASE style photoionization record, beginning with the summary record
-              sscanf(aline, "%*s %d %d %d %d %le %d\n", &z, &istate, &islp, &ilv, &exx, &np);
-              for(n = 0; n < np; n++)
-              {                 //Read the topbase photoionization records
-                if(fgets(aline, LINELENGTH, fptr) == NULL)
-                {
-                  logfile("Get_atomic_data: Problem reading topbase photoionization record\n");
-                  logfile("Get_atomic_data: %s\n", aline);
-                  return ATOMIC_ERROR_TODO;
-                }
-                sscanf(aline, "%*s %le %le", &xe[n], &xx[n]);
-                lineno++;
-
-              }
+              logfile("get_atomic_data: Unable to allocate memory for the Macro Atom jumps\n");
+              return ATOMIC_MEMORY_ISSUE_ERROR;
+            }
+            phot_top[ntop_phot].up_index = config[m].n_bfu_jump;  //record the jump index in the photoionization structure
+            config[m].n_bfu_jump += 1;  //note that there is one more upwards bf jump available (SS)
 
-              n = 0;
 
+            phot_top[ntop_phot].nion = config[m].nion;
+            phot_top[ntop_phot].z = z;
+            phot_top[ntop_phot].istate = istate;
+            phot_top[ntop_phot].np = np;
+            phot_top[ntop_phot].nlast = -1;
+            phot_top[ntop_phot].macro_info = 1;
 
-              /* additional check to assure that records were
-               * only matched with levels whose density was being tracked in levden.  This
-               * is now necesary since a change was made to use topbase levels for calculating
-               * partition functions
-               */
+            if(ions[config[m].nion].phot_info == -1)
+            {
+              ions[config[m].nion].phot_info = 1; /* Mark this ion as using TOPBASE photo */
+              ion_links[config[m].nion].ntop_first = ntop_phot;
+            }
 
-              while((config[n].nden == -1
-                     || config[n].z != z || config[n].istate != istate || config[n].isp != islp
-                     || config[n].ilv != ilv) && n < nlevels)
-                n++;
-              if(n == nlevels)
-              {
+            /* next line sees if the topbase level just read in is the ground state -
+               if it is, the ion structure element ntop_ground is set to that topbase level number
+               note that m is the lower level here */
+            if(m == config[ions[config[n].nion].first_nlte_level].ilv)
+            {
+              ion_links[config[n].nion].ntop_ground = ntop_phot;
+            }
 
-                logfile_error("No level found to match PhotTop data in file %s on line %d. Data ignored.\n", file,
-                              lineno);
-                break;          // There was no pre-existing ion
-              }
-              if(ions[config[n].nion].macro_info == 0)  //this is not a macro atom level (SS)
-              {
-                phot_top[ntop_phot].nlev = n; // level associated with this crossection.
-                phot_top[ntop_phot].nion = config[n].nion;
-                phot_top[ntop_phot].z = z;
-                phot_top[ntop_phot].istate = istate;
-                phot_top[ntop_phot].np = np;
-                phot_top[ntop_phot].nlast = -1;
-                phot_top[ntop_phot].macro_info = 0;
-
-                /* next line sees if the topbase level just read in is the ground state -
-                   if it is, the ion structure element ntop_ground is set to that topbase level number */
-                if(islp == config[ions[config[n].nion].first_nlte_level].isp
-                   && ilv == config[ions[config[n].nion].first_nlte_level].ilv)
-                {
-                  ions[config[n].nion].ntop_ground = ntop_phot;
-                }
+            ions[config[m].nion].ntop++;
 
+            // Finish up this section by storing the photionization data properly
 
-                if(ions[config[n].nion].phot_info == -1)
-                {
-                  ions[config[n].nion].phot_info = 1; /* Mark this ion as using TOPBASE photo */
-                  ions[config[n].nion].ntop_first = ntop_phot;
+            if(add_xsection_points(&phot_top[ntop_phot], np, xe, xx))
+            {
+              logfile("get_atomic_data: There is a problem in allocating memory for the cross section points\n");
+              return ATOMIC_MEMORY_ISSUE_ERROR;
+            }
+            if(phot_freq_min > phot_top[ntop_phot].freq[0])
+              phot_freq_min = phot_top[ntop_phot].freq[0];
 
-                }
-                else if(ions[config[n].nion].phot_info == (0))
-                {
-                  logfile
-                    ("Get_atomic_data: file %s VFKY and Topbase photoionization x-sections in wrong order for nion %d\n",
-                     file, config[n].nion);
-                  logfile("             Read topbase x-sections before VFKY if using both types!!\n");
-                  return ATOMIC_ERROR_TODO;
-                }
-                ions[config[n].nion].ntop++;
-                for(n = 0; n < np; n++)
-                {
-                  phot_top[ntop_phot].freq[n] = xe[n] * EV2ERGS / H;  // convert from eV to freqency
 
-                  phot_top[ntop_phot].x[n] = xx[n]; // leave cross sections in  CGS
-                }
-                if(phot_freq_min > phot_top[ntop_phot].freq[0])
-                  phot_freq_min = phot_top[ntop_phot].freq[0];
+            ntop_phot_macro++;
+            ntop_phot++;
+            nphot_total++;
+            break;
+          }
 
 
-                ntop_phot_simple++;
-                ntop_phot++;
-                nphot_total++;
 
-                /* check to assure we did not exceed the allowed number of photoionization records */
-                if(nphot_total > NTOP_PHOT)
-                {
-                  logfile
-                    ("get_atomicdata: More TopBase photoionization cross sections that NTOP_PHOT (%d).  Increase in atomic.h\n",
-                     NTOP_PHOT);
-                  return ATOMIC_ERROR_TODO;
-                }
-              }
-              else
+          else if(record->keyword == KEYWORD_PHOTTOPS)
+          {
+            // It's a TOPBASE style photoionization record, beginning with the summary record
+            record_scanf(record, RECORD_PHOT, &z, &istate, &islp, &ilv, &exx, &np);
+            for(n = 0; n < np; n++)
+            {                 //Read the topbase photoionization records
+              if((record = get_next_record(batch)) == NULL)
               {
-                logfile
-                  ("Get_atomic_data: photoionisation data ignored since previously read Macro Atom input for the same ion. File: %s line: %d \n",
-                   file, lineno);
+                logfile("Get_atomic_data: Problem reading topbase photoionization record\n");
+                logfile("Get_atomic_data: %s\n", aline);
+                return ATOMIC_ERROR_TODO;
               }
-              break;
-            }
+              copy_record_line(record, aline, LINELENGTH);
+              record_scanf(record, RECORD_POINT, &xe[n], &xx[n]);
+              lineno++;
 
+            }
 
-            /* Check that there is an ion which has the same ionization state as this record
-               otherwise it must be a VFKY style record and so read with that format */
+            /* additional check to assure that records were
+             * only matched with levels whose density was being tracked in levden.  This
+             * is now necesary since a change was made to use topbase levels for calculating
+             * partition functions
+             */
 
-            else if(strncmp(word, "PhotVfkyS", 8) == 0)
+            n = find_config(z, istate, ilv, -1);
+            while(n >= 0 && (config[n].nden == -1 || config[n].isp != islp))
+              n = find_config(z, istate, ilv, n);
+            if(n < 0)
             {
-              // It's a VFKY style photoionization record, beginning with the summary record
-              sscanf(aline, "%*s %d %d %d %d %le %d\n", &z, &istate, &islp, &ilv, &exx, &np);
-              for(n = 0; n < np; n++)
-              {
-                //Read the topbase photoionization records
-                if(fgets(aline, LINELENGTH, fptr) == NULL)
-                {
-                  logfile("Get_atomic_data: Problem reading Vfky photoionization record\n");
-                  logfile("Get_atomic_data: %s\n", aline);
-                  return ATOMIC_ERROR_TODO;
-                }
-                sscanf(aline, "%*s %le %le", &xe[n], &xx[n]);
-                lineno++;
 
-              }
+              logfile_error("No level found to match PhotTop data in file %s on line %d. Data ignored.\n", file,
+                            lineno);
+              break;          // There was no pre-existing ion
+            }
+            if(ions[config[n].nion].macro_info == 0)  //this is not a macro atom level (SS)
+            {
+              phot_top[ntop_phot].nlev = n; // level associated with this crossection.
+              phot_top[ntop_phot].nion = config[n].nion;
+              phot_top[ntop_phot].z = z;
+              phot_top[ntop_phot].istate = istate;
+              phot_top[ntop_phot].np = np;
+              phot_top[ntop_phot].nlast = -1;
+              phot_top[ntop_phot].macro_info = 0;
 
-              for(nion = 0; nion < nions; nion++)
+              /* next line sees if the topbase level just read in is the ground state -
+                 if it is, the ion structure element ntop_ground is set to that topbase level number */
+              if(islp == config[ions[config[n].nion].first_nlte_level].isp
+                 && ilv == config[ions[config[n].nion].first_nlte_level].ilv)
               {
-                if(ions[nion].z == z && ions[nion].istate == istate && ions[nion].macro_info != 1)
-                {
-                  if(ions[nion].phot_info == -1)
-                  {
-                    /* Then there is a match */
-                    phot_top[nphot_total].nlev = ions[nion].firstlevel; // ground state
-                    phot_top[nphot_total].nion = nion;
-                    phot_top[nphot_total].z = z;
-                    phot_top[nphot_total].istate = istate;
-                    phot_top[nphot_total].np = np;
-                    phot_top[nphot_total].nlast = -1;
-                    phot_top[nphot_total].macro_info = 0;
-
-                    ions[nion].phot_info = 0; /* Mark this ion as using VFKY photo */
-                    ions[nion].nxphot = nphot_total;
-
-                    for(n = 0; n < np; n++)
-                    {
-                      phot_top[nphot_total].freq[n] = xe[n] * EV2ERGS / H;  // convert from eV to freqency
-                      phot_top[nphot_total].x[n] = xx[n]; // leave cross sections in  CGS
-                    }
-                    if(phot_freq_min > phot_top[ntop_phot].freq[0])
-                      phot_freq_min = phot_top[ntop_phot].freq[0];
-                    nxphot++;
-                    nphot_total++;
-                  }
-
-                  else if(ions[nion].phot_info == 1 && ions[nion].macro_info != 1)
-                    /* We already have a topbase cross section, but the VFKY
-                       data is superior for the ground state, so we replace that data with the current data
-                       JM 1508 -- don't do this with macro-atoms for the moment */
-                  {
-                    phot_top[ions[nion].ntop_ground].nlev = ions[nion].firstlevel;  // ground state
-                    phot_top[ions[nion].ntop_ground].nion = nion;
-                    phot_top[ions[nion].ntop_ground].z = z;
-                    phot_top[ions[nion].ntop_ground].istate = istate;
-                    phot_top[ions[nion].ntop_ground].np = np;
-                    phot_top[ions[nion].ntop_ground].nlast = -1;
-                    phot_top[ions[nion].ntop_ground].macro_info = 0;
-                    ions[nion].phot_info = 2; //We mark this as having hybrid data - VFKY ground, TB excited, potentially VFKY innershell
-                    for(n = 0; n < np; n++)
-                    {
-                      phot_top[ions[nion].ntop_ground].freq[n] = xe[n] * EV2ERGS / H; // convert from eV to freqency
-                      phot_top[ions[nion].ntop_ground].x[n] = xx[n];  // leave cross sections in  CGS
-                    }
-                    if(phot_freq_min > phot_top[ions[nion].ntop_ground].freq[0])
-                      phot_freq_min = phot_top[ions[nion].ntop_ground].freq[0];
-                    logfile_error
-                      ("Get_atomic_data: file %s  Replacing ground state topbase photoionization for ion %d with VFKY photoionization\n",
-                       file, nion);
-                  }
-                }
+                ion_links[config[n].nion].ntop_ground = ntop_phot;
               }
 
-              if(nxphot > NIONS)
+
+              if(ions[config[n].nion].phot_info == -1)
               {
-                logfile("getatomic_data: file %s line %d: More photoionization edges than IONS.\n", file, lineno);
-                return ATOMIC_ERROR_TODO;
+                ions[config[n].nion].phot_info = 1; /* Mark this ion as using TOPBASE photo */
+                ion_links[config[n].nion].ntop_first = ntop_phot;
+
               }
-              if(nphot_total > NTOP_PHOT)
+              else if(ions[config[n].nion].phot_info == (0))
               {
                 logfile
-                  ("get_atomicdata: More photoionization cross sections that NTOP_PHOT (%d).  Increase in atomic.h\n",
-                   NTOP_PHOT);
+                  ("Get_atomic_data: file %s VFKY and Topbase photoionization x-sections in wrong order for nion %d\n",
+                   file, config[n].nion);
+                logfile("             Read topbase x-sections before VFKY if using both types!!\n");
                 return ATOMIC_ERROR_TODO;
               }
+              ions[config[n].nion].ntop++;
+              if(add_xsection_points(&phot_top[ntop_phot], np, xe, xx))
+              {
+                logfile("get_atomic_data: There is a problem in allocating memory for the cross section points\n");
+                return ATOMIC_MEMORY_ISSUE_ERROR;
+              }
+              if(phot_freq_min > phot_top[ntop_phot].freq[0])
+                phot_freq_min = phot_top[ntop_phot].freq[0];
 
-              break;
+
+              ntop_phot_simple++;
+              ntop_phot++;
+              nphot_total++;
             }
             else
             {
-              logfile("get_atomic_data: file %s line %d: photoionization line incorrectly formatted\n", file, lineno);
-              logfile("Make sure you are using the tabulated verner cross sections (photo_vfky_tabulated.data)\n");
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
+              logfile
+                ("Get_atomic_data: photoionisation data ignored since previously read Macro Atom input for the same ion. File: %s line: %d \n",
+                 file, lineno);
             }
-
-            /* Input inner shell cross section data */
+            break;
+          }
 
 
+          /* Check that there is an ion which has the same ionization state as this record
+             otherwise it must be a VFKY style record and so read with that format */
 
-          case 'I':
-            if(sscanf(aline, "%*s %d %d %d %d %le %d\n", &z, &istate, &in, &il, &exx, &np) != 6)
-            {
-              logfile("Inner shell ionization data incorrectly formatted\n");
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
+          else if(record->keyword == KEYWORD_PHOTVFKYS)
+          {
+            // It's a VFKY style photoionization record, beginning with the summary record
+            record_scanf(record, RECORD_PHOT, &z, &istate, &islp, &ilv, &exx, &np);
             for(n = 0; n < np; n++)
             {
               //Read the topbase photoionization records
-              if(fgets(aline, LINELENGTH, fptr) == NULL)
+              if((record = get_next_record(batch)) == NULL)
               {
-                logfile("Get_atomic_data: Problem reading VY inner shell record\n");
+                logfile("Get_atomic_data: Problem reading Vfky photoionization record\n");
                 logfile("Get_atomic_data: %s\n", aline);
                 return ATOMIC_ERROR_TODO;
               }
-              sscanf(aline, "%*s %le %le", &xe[n], &xx[n]);
+              copy_record_line(record, aline, LINELENGTH);
+              record_scanf(record, RECORD_POINT, &xe[n], &xx[n]);
               lineno++;
+
             }
-            for(nion = 0; nion < nions; nion++)
+
+            nion = ion_index(z, istate);
+            if(nion >= 0 && ions[nion].macro_info != 1)
             {
-              if(ions[nion].z == z && ions[nion].istate == istate && ions[nion].macro_info != 1)
+              if(ions[nion].phot_info == -1)
               {
                 /* Then there is a match */
-                inner_cross[n_inner_tot].nlev = ions[nion].firstlevel;  //All these are for the ground state
-                inner_cross[n_inner_tot].nion = nion;
-                inner_cross[n_inner_tot].np = np;
-                inner_cross[n_inner_tot].z = z;
-                inner_cross[n_inner_tot].istate = istate;
-                inner_cross[n_inner_tot].n = in;
-                inner_cross[n_inner_tot].l = il;
-                inner_cross[n_inner_tot].nlast = -1;
-                ions[nion].n_inner++; /*Increment the number of inner shells */
-                ions[nion].nxinner[ions[nion].n_inner] = n_inner_tot;
-                for(n = 0; n < np; n++)
+                phot_top[nphot_total].nlev = ions[nion].firstlevel; // ground state
+                phot_top[nphot_total].nion = nion;
+                phot_top[nphot_total].z = z;
+                phot_top[nphot_total].istate = istate;
+                phot_top[nphot_total].np = np;
+                phot_top[nphot_total].nlast = -1;
+                phot_top[nphot_total].macro_info = 0;
+
+                ions[nion].phot_info = 0; /* Mark this ion as using VFKY photo */
+                ion_links[nion].nxphot = nphot_total;
+
+                if(add_xsection_points(&phot_top[nphot_total], np, xe, xx))
                 {
-                  inner_cross[n_inner_tot].freq[n] = xe[n] * EV2ERGS / H; // convert from eV to freqency
-                  inner_cross[n_inner_tot].x[n] = xx[n];  // leave cross sections in  CGS
+                  logfile("get_atomic_data: There is a problem in allocating memory for the cross section points\n");
+                  return ATOMIC_MEMORY_ISSUE_ERROR;
                 }
-                if(inner_freq_min > inner_cross[n_inner_tot].freq[0])
-                  inner_freq_min = inner_cross[n_inner_tot].freq[0];
-                n_inner_tot++;
+                if(phot_freq_min > phot_top[ntop_phot].freq[0])
+                  phot_freq_min = phot_top[ntop_phot].freq[0];
+                nxphot++;
+                nphot_total++;
+              }
 
+              else if(ions[nion].phot_info == 1 && ions[nion].macro_info != 1)
+                /* We already have a topbase cross section, but the VFKY
+                   data is superior for the ground state, so we replace that data with the current data
+                   JM 1508 -- don't do this with macro-atoms for the moment */
+              {
+                phot_top[ion_links[nion].ntop_ground].nlev = ions[nion].firstlevel;  // ground state
+                phot_top[ion_links[nion].ntop_ground].nion = nion;
+                phot_top[ion_links[nion].ntop_ground].z = z;
+                phot_top[ion_links[nion].ntop_ground].istate = istate;
+                phot_top[ion_links[nion].ntop_ground].np = np;
+                phot_top[ion_links[nion].ntop_ground].nlast = -1;
+                phot_top[ion_links[nion].ntop_ground].macro_info = 0;
+                ions[nion].phot_info = 2; //We mark this as having hybrid data - VFKY ground, TB excited, potentially VFKY innershell
+                if(add_xsection_points(&phot_top[ion_links[nion].ntop_ground], np, xe, xx))
+                {
+                  logfile("get_atomic_data: There is a problem in allocating memory for the cross section points\n");
+                  return ATOMIC_MEMORY_ISSUE_ERROR;
+                }
+                if(phot_freq_min > phot_top[ion_links[nion].ntop_ground].freq[0])
+                  phot_freq_min = phot_top[ion_links[nion].ntop_ground].freq[0];
+                logfile_error
+                  ("Get_atomic_data: file %s  Replacing ground state topbase photoionization for ion %d with VFKY photoionization\n",
+                   file, nion);
               }
             }
-            if(n_inner_tot > N_INNER * NIONS)
+
+
+            break;
+          }
+          else
+          {
+            logfile("get_atomic_data: file %s line %d: photoionization line incorrectly formatted\n", file, lineno);
+            logfile("Make sure you are using the tabulated verner cross sections (photo_vfky_tabulated.data)\n");
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+
+          /* Input inner shell cross section data */
+
+
+
+        case 'I':
+          if(record_scanf(record, RECORD_INNER, &z, &istate, &in, &il, &exx, &np) != 6)
+          {
+            logfile("Inner shell ionization data incorrectly formatted\n");
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          for(n = 0; n < np; n++)
+          {
+            //Read the topbase photoionization records
+            if((record = get_next_record(batch)) == NULL)
             {
-              logfile("getatomic_data: file %s line %d: Inner edges than we have room for.\n", file, lineno);
+              logfile("Get_atomic_data: Problem reading VY inner shell record\n");
+              logfile("Get_atomic_data: %s\n", aline);
               return ATOMIC_ERROR_TODO;
             }
-            break;
+            copy_record_line(record, aline, LINELENGTH);
+            record_scanf(record, RECORD_POINT, &xe[n], &xx[n]);
+            lineno++;
+          }
+          nion = ion_index(z, istate);
+          if(nion >= 0 && ions[nion].macro_info != 1)
+          {
+            /* Then there is a match */
+            inner_cross[n_inner_tot].nlev = ions[nion].firstlevel;  //All these are for the ground state
+            inner_cross[n_inner_tot].nion = nion;
+            inner_cross[n_inner_tot].np = np;
+            inner_cross[n_inner_tot].z = z;
+            inner_cross[n_inner_tot].istate = istate;
+            inner_cross[n_inner_tot].n = in;
+            inner_cross[n_inner_tot].l = il;
+            inner_cross[n_inner_tot].nlast = -1;
+            ion_links[nion].n_inner++; /*Increment the number of inner shells */
+            ion_links[nion].nxinner[ion_links[nion].n_inner] = n_inner_tot;
+            if(add_xsection_points(&inner_cross[n_inner_tot], np, xe, xx))
+            {
+              logfile("get_atomic_data: There is a problem in allocating memory for the cross section points\n");
+              return ATOMIC_MEMORY_ISSUE_ERROR;
+            }
+            if(inner_freq_min > inner_cross[n_inner_tot].freq[0])
+              inner_freq_min = inner_cross[n_inner_tot].freq[0];
+            n_inner_tot++;
 
+          }
+          break;
 
-            /*Input data for innershell ionization followed by
-               Auger effect */
+
+          /*Input data for innershell ionization followed by
+             Auger effect */
 /**
  * @section Auger
  */
@@ -2631,211 +3670,192 @@ described as macro-levels. */
  *   Basically this was accomplished by checking both the upper and lower level and breaking
  *   out if either was not accounted for.
 */
-          case 'r':
-            if(strncmp(word, "LinMacro", 8) == 0)
-            {                   //It's a macro atoms line(SS)
-              if(mflag != 1)
-              {
-                logfile("get_atomicdata: Can't read macro-line after some simple lines. Reorder the input files!\n");
-                return ATOMIC_ERROR_TODO;
-              }
+        case 'r':
+          if(record->keyword == KEYWORD_LINMACRO)
+          {                   //It's a macro atoms line(SS)
+            if(mflag != 1)
+            {
+              logfile("get_atomicdata: Can't read macro-line after some simple lines. Reorder the input files!\n");
+              return ATOMIC_ERROR_TODO;
+            }
 
-              mflag = 1;        //flag to identify macro atom case (SS)
-              nwords =
-                sscanf(aline, "%*s %d %d %le %le %le %le %le %le %d %d", &z, &istate, &freq, &f, &gl, &gu, &el, &eu,
-                       &levl, &levu);
-              if(nwords != 10)
-              {
-                logfile("get_atomic_data: file %s line %d: LinMacro line incorrectly formatted\n", file, lineno);
-                logfile("Get_atomic_data: %s\n", aline);
-                return ATOMIC_ERROR_TODO;
-              }
+            mflag = 1;        //flag to identify macro atom case (SS)
+            nwords =
+              record_scanf(record, RECORD_LINMACRO, &z, &istate, &freq, &f, &gl, &gu, &el, &eu,
+                           &levl, &levu);
+            if(nwords != 10)
+            {
+              logfile("get_atomic_data: file %s line %d: LinMacro line incorrectly formatted\n", file, lineno);
+              logfile("Get_atomic_data: %s\n", aline);
+              return ATOMIC_ERROR_TODO;
+            }
 
-              el = EV2ERGS * el;
-              eu = EV2ERGS * eu;
-              //need to identify the configurations associated with the upper and lower levels (SS)
-              n = 0;
-              while((config[n].z != z || config[n].istate != istate || config[n].ilv != levl) && n < nlevels)
-                n++;
-              if(n == nlevels)
-              {
-                logfile_error("Get_atomic_data: No configuration found to match lower level of line %d\n", lineno);
-                break;
-              }
+            el = EV2ERGS * el;
+            eu = EV2ERGS * eu;
+            //need to identify the configurations associated with the upper and lower levels (SS)
+            n = find_config(z, istate, levl, -1);
+            if(n < 0)
+            {
+              logfile_error("Get_atomic_data: No configuration found to match lower level of line %d\n", lineno);
+              break;
+            }
 
 
-              m = 0;
-              while((config[m].z != z || config[m].istate != istate || config[m].ilv != levu) && m < nlevels)
-                m++;
-              if(m == nlevels)
-              {
-                logfile_error("Get_atomic_data: No configuration found to match upper level of line %d\n", lineno);
-                break;
-              }
+            m = find_config(z, istate, levu, -1);
+            if(m < 0)
+            {
+              logfile_error("Get_atomic_data: No configuration found to match upper level of line %d\n", lineno);
+              break;
+            }
 
-              /* Now that we know this is a valid transition for the macro atom record the data */
+            /* Now that we know this is a valid transition for the macro atom record the data */
 
-              nconfigl = n;     //record lower configuration (SS)
-              config[n].bbu_jump[config[n].n_bbu_jump] = nlines;  //record the line index as an upward bb Macro Atom jump(SS)
-              line[nlines].down_index = config[n].n_bbu_jump; //record the index for the jump in the line structure
-              config[n].n_bbu_jump += 1;  //note that there is one more upwards jump available (SS)
-              if(config[n].n_bbu_jump > NBBJUMPS)
-              {
-                logfile("get_atomic_data: Too many upward b-b jumps for ion %d\n", config[n].istate);
-                return ATOMIC_ERROR_TODO;
-              }
+            nconfigl = n;     //record lower configuration (SS)
+            if(add_macro_jump(JUMP_BB_UP, n, nlines)) //record the line index as an upward bb Macro Atom jump(SS)
+            {
+              logfile("get_atomic_data: Unable to allocate memory for the Macro Atom jumps\n");
+              return ATOMIC_MEMORY_ISSUE_ERROR;
+            }
+            line_links[nlines].down_index = config[n].n_bbu_jump; //record the index for the jump in the line structure
+            config[n].n_bbu_jump += 1;  //note that there is one more upwards jump available (SS)
 
-              nconfigu = m;     //record upper configuration (SS)
-              config[m].bbd_jump[config[m].n_bbd_jump] = nlines;  //record the line index as a downward bb Macro Atom jump (SS)
-              line[nlines].up_index = config[m].n_bbd_jump; //record jump index in line structure
-              config[m].n_bbd_jump += 1;  //note that there is one more downwards jump available (SS)
-              if(config[m].n_bbd_jump > NBBJUMPS)
-              {
-                logfile("get_atomic_data: Too many downward b-b jumps for ion %d\n", config[m].istate);
-                return ATOMIC_ERROR_TODO;
-              }
+            nconfigu = m;     //record upper configuration (SS)
+            if(add_macro_jump(JUMP_BB_DOWN, m, nlines))  //record the line index as a downward bb Macro Atom jump (SS)
+            {
+              logfile("get_atomic_data: Unable to allocate memory for the Macro Atom jumps\n");
+              return ATOMIC_MEMORY_ISSUE_ERROR;
+            }
+            line_links[nlines].up_index = config[m].n_bbd_jump; //record jump index in line structure
+            config[m].n_bbd_jump += 1;  //note that there is one more downwards jump available (SS)
 
 
-            }
-            else
-            {                   //It's not a macro atom line (SS)
+          }
+          else
+          {                   //It's not a macro atom line (SS)
 // It would have been better to define mflag = 0 since that is what we want to set
 // macro_info to if it is an old-style line, but keep it this way for now.  ksl
-              mflag = -1;       //a flag to mark this as not a macro atom case (SS)
-              nconfigl = -1;
-              nconfigu = -1;
-              nwords =
-                sscanf(aline, "%*s %d %2d %le %le %le %le %le %le %d %d", &z, &istate, &freq, &f, &gl, &gu, &el, &eu,
-                       &levl, &levu);
-              if(nwords == 6)
-              {
-                el = 0.0;
-                eu = H * C / (freq * 1e-8); // Convert Angstroms to ergs
-                levl = -1;
-                levu = -1;
+            mflag = -1;       //a flag to mark this as not a macro atom case (SS)
+            nconfigl = -1;
+            nconfigu = -1;
+            nwords =
+              record_scanf(record, RECORD_LINE, &z, &istate, &freq, &f, &gl, &gu, &el, &eu,
+                           &levl, &levu);
+            if(nwords == 6)
+            {
+              el = 0.0;
+              eu = H * C / (freq * 1e-8); // Convert Angstroms to ergs
+              levl = -1;
+              levu = -1;
 
-              }
-              else if(nwords == 8)
-              {                 // Then the file contains the energy levels of the transitions
+            }
+            else if(nwords == 8)
+            {                 // Then the file contains the energy levels of the transitions
 
-                el = EV2ERGS * el;
-                eu = EV2ERGS * eu;
-                levl = -1;
-                levu = -1;
-              }
-              else if(nwords == 10)
-              {                 // Then the file contains energy levels and level numbers
-                el = EV2ERGS * el;
-                eu = EV2ERGS * eu;
-              }
+              el = EV2ERGS * el;
+              eu = EV2ERGS * eu;
+              levl = -1;
+              levu = -1;
+            }
+            else if(nwords == 10)
+            {                 // Then the file contains energy levels and level numbers
+              el = EV2ERGS * el;
+              eu = EV2ERGS * eu;
+            }
 
-              else
-              {
-                logfile("get_atomic_data: file %s line %d: Resonance line incorrectly formatted\n", file, lineno);
-                logfile("Get_atomic_data: %s\n", aline);
-                return ATOMIC_ERROR_TODO;
-              }
+            else
+            {
+              logfile("get_atomic_data: file %s line %d: Resonance line incorrectly formatted\n", file, lineno);
+              logfile("Get_atomic_data: %s\n", aline);
+              return ATOMIC_ERROR_TODO;
             }
+          }
 
-            if(el > eu)
-              logfile("get_atomic_data: file %s line %d : line has el (%f) > eu (%f)\n", file, lineno, el, eu);
-            for(n = 0; n < nions; n++)
+          if(el > eu)
+            logfile("get_atomic_data: file %s line %d : line has el (%f) > eu (%f)\n", file, lineno, el, eu);
+          n = ion_index(z, istate);
+          if(n >= 0)
+          {                 /* Then there is a match */
+            if(freq == 0 || f <= 0 || gl == 0 || gu == 0)
             {
-              if(ions[n].z == z && ions[n].istate == istate)
-              {                 /* Then there is a match */
-                if(freq == 0 || f <= 0 || gl == 0 || gu == 0)
-                {
-                  logfile_error("getatomic_data: line input incomplete: %s\n", aline);
-                  break;
-                }
-                //
-                //define macro atom case (SS)
+              logfile_error("getatomic_data: line input incomplete: %s\n", aline);
+              break;
+            }
+            //
+            //define macro atom case (SS)
 /* XXXX  04 April ksl -- Right now have enforced a clean separation between macro-ions and simple-ions
 but this is proably not what we want if we move all bf & fb transitions to macro-ion approach.  We
 would like to have simple lines for macro-ions */
-                if(ions[n].macro_info == 1 && mflag == -1)
-                {
-                  /* count how many times this happens to report to user */
-                  simple_line_ignore[n] += 1;
-                  break;
-                }
-
-                if(ions[n].macro_info == -1 && mflag == 1)
-                {
-                  logfile
-                    ("Getatomic_data: Macro Atom line data supplied for ion %d\n but there is no suitable level data\n",
-                     n);
-                  return ATOMIC_ERROR_TODO;
-                }
-                line[nlines].nion = n;
-                line[nlines].z = z;
-                line[nlines].istate = istate;
-                line[nlines].freq = C / (freq * 1e-8);  /* convert Angstroms to frequency */
-                line[nlines].f = f;
-                line[nlines].gl = gl;
-                line[nlines].gu = gu;
-                line[nlines].levl = levl;
-                line[nlines].levu = levu;
-                line[nlines].el = el;
-                line[nlines].eu = eu;
-                line[nlines].nconfigl = nconfigl;
-                line[nlines].nconfigu = nconfigu;
-                line[nlines].coll_index = -999; //Tokick off with we assume there is no collisional strength data
-                if(mflag == -1)
-                {
-                  line[nlines].macro_info = 0;  // It's an old-style line`
-                  nlines_simple++;
-                }
-                else
-                {
-                  line[nlines].macro_info = 1;  //It's a macro line
-                  nlines_macro++;
-                }
-                nlines++;
-              }
+            if(ions[n].macro_info == 1 && mflag == -1)
+            {
+              /* count how many times this happens to report to user */
+              simple_line_ignore[n] += 1;
+              break;
             }
-            if(nlines > NLINES)
+
+            if(ions[n].macro_info == -1 && mflag == 1)
             {
-              logfile("getatomic_data: file %s line %d: More lines than allowed. Increase NLINES in atomic.h\n", file,
-                      lineno);
+              logfile
+                ("Getatomic_data: Macro Atom line data supplied for ion %d\n but there is no suitable level data\n",
+                 n);
               return ATOMIC_ERROR_TODO;
             }
-            break;
+            line[nlines].nion = n;
+            line[nlines].z = z;
+            line[nlines].istate = istate;
+            line[nlines].freq = C / (freq * 1e-8);  /* convert Angstroms to frequency */
+            line[nlines].f = f;
+            line[nlines].gl = gl;
+            line[nlines].gu = gu;
+            line[nlines].levl = levl;
+            line[nlines].levu = levu;
+            line[nlines].el = el;
+            line[nlines].eu = eu;
+            line[nlines].nconfigl = nconfigl;
+            line[nlines].nconfigu = nconfigu;
+            line_links[nlines].coll_index = -999; //Tokick off with we assume there is no collisional strength data
+            if(mflag == -1)
+            {
+              line[nlines].macro_info = 0;  // It's an old-style line`
+              nlines_simple++;
+            }
+            else
+            {
+              line[nlines].macro_info = 1;  //It's a macro line
+              nlines_macro++;
+            }
+            nlines++;
+          }
+          break;
 
 /** @section Ground state fractions
  */
-          case 'f':
-            if(sscanf
-               (aline,
-                "%*s %d %d %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le",
-                &z, &istate, &the_ground_frac[0], &the_ground_frac[1],
-                &the_ground_frac[2], &the_ground_frac[3],
-                &the_ground_frac[4], &the_ground_frac[5],
-                &the_ground_frac[6], &the_ground_frac[7],
-                &the_ground_frac[8], &the_ground_frac[9],
-                &the_ground_frac[10], &the_ground_frac[11],
-                &the_ground_frac[12], &the_ground_frac[13],
-                &the_ground_frac[14], &the_ground_frac[15],
-                &the_ground_frac[16], &the_ground_frac[17], &the_ground_frac[18], &the_ground_frac[19]) != 22)
-            {
-              logfile("get_atomic_data: file %s line %d ground state fracs   frac table incorrectly formatted\n", file,
-                      lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
-            for(n = 0; n < nions; n++)
+        case 'f':
+          if(record_scanf(record, RECORD_FRAC, &z, &istate, &the_ground_frac[0], &the_ground_frac[1],
+                          &the_ground_frac[2], &the_ground_frac[3],
+                          &the_ground_frac[4], &the_ground_frac[5],
+                          &the_ground_frac[6], &the_ground_frac[7],
+                          &the_ground_frac[8], &the_ground_frac[9],
+                          &the_ground_frac[10], &the_ground_frac[11],
+                          &the_ground_frac[12], &the_ground_frac[13],
+                          &the_ground_frac[14], &the_ground_frac[15],
+                          &the_ground_frac[16], &the_ground_frac[17], &the_ground_frac[18], &the_ground_frac[19]) != 22)
+          {
+            logfile("get_atomic_data: file %s line %d ground state fracs   frac table incorrectly formatted\n", file,
+                    lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          n = ion_index(z, istate);
+          if(n >= 0)
+          {                 /* Then there is a match */
+            ground_frac[n].z = z;
+            ground_frac[n].istate = istate;
+            for(j = 0; j < 20; j++)
             {
-              if(ions[n].z == z && ions[n].istate == istate)
-              {                 /* Then there is a match */
-                ground_frac[n].z = z;
-                ground_frac[n].istate = istate;
-                for(j = 0; j < 20; j++)
-                {
-                  ground_frac[n].frac[j] = the_ground_frac[j];
-                }
-              }
+              ground_frac[n].frac[j] = the_ground_frac[j];
             }
-            break;
+          }
+          break;
 
 
 
@@ -2858,57 +3878,55 @@ would like to have simple lines for macro-ions */
  *
  */
 
-          case 'D':            /* Dielectronic recombination data read in. */
-            nparam = sscanf(aline, "%*s %s %d %d %le %le %le %le %le %le %le %le %le", &drflag, &z, &ne, &drp[0], &drp[1], &drp[2], &drp[3], &drp[4], &drp[5], &drp[6], &drp[7], &drp[8]);  //split and assign the line
-            nparam -= 3;        //take 4 off the nparam to give the number of actual parameters
-            if(nparam > 9 || nparam < 1)  //     trap errors - not as robust as usual because there are a varaible number of parameters...
-            {
-              logfile("Something wrong with dielectronic recombination data\n", file, lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
+        case 'D':            /* Dielectronic recombination data read in. */
+          nparam = record_scanf(record, RECORD_DR_BADNL, drflag, &z, &ne, &drp[0], &drp[1], &drp[2], &drp[3], &drp[4], &drp[5], &drp[6], &drp[7], &drp[8]);  //split and assign the line
+          nparam -= 3;        //take 4 off the nparam to give the number of actual parameters
+          if(nparam > 9 || nparam < 1)  //     trap errors - not as robust as usual because there are a varaible number of parameters...
+          {
+            logfile("Something wrong with dielectronic recombination data\n", file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
 
-            istate = ne;        //         get the ionisation state we are recombining from
+          istate = ne;        //         get the ionisation state we are recombining from
 
-            for(n = 0; n < nions; n++)  //Loop over ions to find the correct place to put the data
+          n = ion_index(z, istate);  //Look up the ion to put the data in
+          if(n >= 0)  // this works out which ion we are dealing with
+          {
+            if(ion_links[n].drflag == 0) //This is the first time we have dealt with this ion
             {
-              if(ions[n].z == z && ions[n].istate == istate)  // this works out which ion we are dealing with
-              {
-                if(ions[n].drflag == 0) //This is the first time we have dealt with this ion
-                {
-                  drecomb[ndrecomb].nion = n; //put the ion number into the DR structure
-                  drecomb[ndrecomb].nparam = nparam;  //Put the number of parameters we ware going to read in, into the DR structure so we know what to iterate over later
-                  ions[n].nxdrecomb = ndrecomb; //put the number of the DR into the ion
-                  drecomb[ndrecomb].type = DRTYPE_BADNELL;  //define the type of data
-                  ndrecomb++;   //increment the counter of number of dielectronic recombination parameter sets
-                  ions[n].drflag++; //increment the flag by 1. We will do this rather than simply setting it to 1 so we will get errors if we do this more than once....
+              drecomb[ndrecomb].nion = n; //put the ion number into the DR structure
+              drecomb[ndrecomb].nparam = nparam;  //Put the number of parameters we ware going to read in, into the DR structure so we know what to iterate over later
+              ion_links[n].nxdrecomb = ndrecomb; //put the number of the DR into the ion
+              drecomb[ndrecomb].type = DRTYPE_BADNELL;  //define the type of data
+              ndrecomb++;   //increment the counter of number of dielectronic recombination parameter sets
+              ion_links[n].drflag++; //increment the flag by 1. We will do this rather than simply setting it to 1 so we will get errors if we do this more than once....
 
-                }
-                if(drflag == 'E') // this ion has no parameters, so it must be the first time through
-                {
+            }
+            if(drflag[0] == 'E') // this ion has no parameters, so it must be the first time through
+            {
 
-                  n1 = ions[n].nxdrecomb; //     Get the pointer to the correct bit of the recombination coefficient array. This should already be set from the first time through
-                  for(n2 = 0; n2 < nparam; n2++)
-                  {
-                    drecomb[n1].e[n2] = drp[n2];  //we are getting e parameters
-                  }
+              n1 = ion_links[n].nxdrecomb; //     Get the pointer to the correct bit of the recombination coefficient array. This should already be set from the first time through
+              for(n2 = 0; n2 < nparam; n2++)
+              {
+                drecomb[n1].e[n2] = drp[n2];  //we are getting e parameters
+              }
 
 
-                }
-                else if(drflag == 'C')  //                  must be the second time though, so no need to read in all the other things
-                {
-                  n1 = ions[n].nxdrecomb; //     Get the pointer to the correct bit of the recombination coefficient array. This should already be set from the first time through
-                  for(n2 = 0; n2 < nparam; n2++)
-                  {
-                    drecomb[n1].c[n2] = drp[n2];  //           we are getting e parameters
-                  }
-                }
+            }
+            else if(drflag[0] == 'C')  //                  must be the second time though, so no need to read in all the other things
+            {
+              n1 = ion_links[n].nxdrecomb; //     Get the pointer to the correct bit of the recombination coefficient array. This should already be set from the first time through
+              for(n2 = 0; n2 < nparam; n2++)
+              {
+                drecomb[n1].c[n2] = drp[n2];  //           we are getting e parameters
+              }
+            }
 
-              }                 //close if statement that selects appropriate ion to add data to
-            }                   //close loop over ions
+          }                 //close if statement that selects appropriate ion to add data to
 
 
-            break;
+          break;
 
 /** @section Dielectronic Recombination - type 2
  * This section reads in type 2 dielectronic recombination rates.
@@ -2928,40 +3946,38 @@ would like to have simple lines for macro-ions */
 
 
 
-          case 'S':
-            nparam = sscanf(aline, "%*s %d %d %le %le %le %le ", &z, &ne, &drp[0], &drp[1], &drp[2], &drp[3]);  //split and assign the line
-            nparam -= 2;        //take 4 off the nparam to give the number of actual parameters
-            if(nparam > 4 || nparam < 1)  //     trap errors - not as robust as usual because there are a varaible number of parameters...
-            {
-              logfile("Something wrong with dielectronic recombination data\n", file, lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
+        case 'S':
+          nparam = record_scanf(record, RECORD_DR_SHULL, &z, &ne, &drp[0], &drp[1], &drp[2], &drp[3]);  //split and assign the line
+          nparam -= 2;        //take 4 off the nparam to give the number of actual parameters
+          if(nparam > 4 || nparam < 1)  //     trap errors - not as robust as usual because there are a varaible number of parameters...
+          {
+            logfile("Something wrong with dielectronic recombination data\n", file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
 
-            istate = ne;        //         get the ionisation state we are recombining from
+          istate = ne;        //         get the ionisation state we are recombining from
 
-            for(n = 0; n < nions; n++)  //Loop over ions to find the correct place to put the data
+          n = ion_index(z, istate);  //Look up the ion to put the data in
+          if(n >= 0)  // this works out which ion we are dealing with
+          {
+            if(ion_links[n].drflag == 0) //This is the first time we have dealt with this ion
             {
-              if(ions[n].z == z && ions[n].istate == istate)  // this works out which ion we are dealing with
-              {
-                if(ions[n].drflag == 0) //This is the first time we have dealt with this ion
-                {
-                  drecomb[ndrecomb].nion = n; //put the ion number into the DR structure
-                  drecomb[ndrecomb].nparam = nparam;  //Put the number of parameters we ware going to read in, into the DR structure so we know what to iterate over later
-                  ions[n].nxdrecomb = ndrecomb; //put the number of the DR into the ion
-                  drecomb[ndrecomb].type = DRTYPE_SHULL;  //define the type of data
-                  ndrecomb++;   //increment the counter of number of dielectronic recombination parameter sets
-                  ions[n].drflag++; //increment the flag by 1. We will do this rather than simply setting it to 1 so we will get errors if we do this more than once....
+              drecomb[ndrecomb].nion = n; //put the ion number into the DR structure
+              drecomb[ndrecomb].nparam = nparam;  //Put the number of parameters we ware going to read in, into the DR structure so we know what to iterate over later
+              ion_links[n].nxdrecomb = ndrecomb; //put the number of the DR into the ion
+              drecomb[ndrecomb].type = DRTYPE_SHULL;  //define the type of data
+              ndrecomb++;   //increment the counter of number of dielectronic recombination parameter sets
+              ion_links[n].drflag++; //increment the flag by 1. We will do this rather than simply setting it to 1 so we will get errors if we do this more than once....
 
-                }
-                n1 = ions[n].nxdrecomb; //     Get the pointer to the correct bit of the recombination coefficient array. This should already be set from the first time through
-                for(n2 = 0; n2 < nparam; n2++)
-                {
-                  drecomb[n1].shull[n2] = drp[n2];  //we are getting e parameters
-                }
-              }
             }
-            break;
+            n1 = ion_links[n].nxdrecomb; //     Get the pointer to the correct bit of the recombination coefficient array. This should already be set from the first time through
+            for(n2 = 0; n2 < nparam; n2++)
+            {
+              drecomb[n1].shull[n2] = drp[n2];  //we are getting e parameters
+            }
+          }
+          break;
 
 /**
  * @section total radiative Recombination rates from Chianti - type 1 and 2
@@ -2984,52 +4000,50 @@ would like to have simple lines for macro-ions */
  * @endverbatim
  * */
 
-          case 'T':            /*Badnell type total raditive rate coefficients read in */
+        case 'T':            /*Badnell type total raditive rate coefficients read in */
+
+          nparam = record_scanf(record, RECORD_RR_BADNL, &z, &ne, &w, &btrr[0], &btrr[1], &btrr[2], &btrr[3], &btrr[4], &btrr[5]);  //split and assign the line
+          nparam -= 3;        //take 4 off the nparam to give the number of actual parameters
+          if(nparam > 6 || nparam < 1)  //     trap errors - not as robust as usual because there are a varaible number of parameters...
+          {
+            logfile("Something wrong with badnell total RR data\n", file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
 
-            nparam = sscanf(aline, "%*s %d %d %d %le %le %le %le %le %le", &z, &ne, &w, &btrr[0], &btrr[1], &btrr[2], &btrr[3], &btrr[4], &btrr[5]);  //split and assign the line
-            nparam -= 3;        //take 4 off the nparam to give the number of actual parameters
-            if(nparam > 6 || nparam < 1)  //     trap errors - not as robust as usual because there are a varaible number of parameters...
+          istate = ne;        //         get the traditional ionisation state
+          n = ion_index(z, istate);  //Look up the ion to put the data in
+          if(n >= 0)  // this works out which ion we are dealing with
+          {
+            if(ion_links[n].total_rrflag == 0) // this ion has no parameters, so it must be the first time through
+            {
+              total_rr[n_total_rr].nion = n;  //put the ion number into the bad_t_rr structure
+              ion_links[n].nxtotalrr = n_total_rr; /*put the number of the bad_t_rr into the ion
+                                                 structure so we can go either way. */
+              total_rr[n_total_rr].type = RRTYPE_BADNELL;
+              for(n1 = 0; n1 < nparam; n1++)
+              {
+                total_rr[n_total_rr].params[n1] = btrr[n1]; //we are getting  parameters
+              }
+              ion_links[n].total_rrflag++; //increment the flag by 1. We will do this rather than simply setting it to 1 so we will get errors if we do this more than once....
+              n_total_rr++; //increment the counter of number of dielectronic recombination parameter sets
+            }
+            else if(ion_links[n].total_rrflag > 0) //       unexpected second line matching z and charge
             {
-              logfile("Something wrong with badnell total RR data\n", file, lineno);
+              logfile("More than one badnell total RR rate for ion %i\n", n);
               logfile("Get_atomic_data: %s\n", aline);
               return ATOMIC_ERROR_TODO;
             }
-
-            istate = ne;        //         get the traditional ionisation state
-            for(n = 0; n < nions; n++)  //Loop over ions to find the correct place to put the data
+            else            //if flag is not a positive number, we have a problem
             {
-              if(ions[n].z == z && ions[n].istate == istate)  // this works out which ion we are dealing with
-              {
-                if(ions[n].total_rrflag == 0) // this ion has no parameters, so it must be the first time through
-                {
-                  total_rr[n_total_rr].nion = n;  //put the ion number into the bad_t_rr structure
-                  ions[n].nxtotalrr = n_total_rr; /*put the number of the bad_t_rr into the ion
-                                                     structure so we can go either way. */
-                  total_rr[n_total_rr].type = RRTYPE_BADNELL;
-                  for(n1 = 0; n1 < nparam; n1++)
-                  {
-                    total_rr[n_total_rr].params[n1] = btrr[n1]; //we are getting  parameters
-                  }
-                  ions[n].total_rrflag++; //increment the flag by 1. We will do this rather than simply setting it to 1 so we will get errors if we do this more than once....
-                  n_total_rr++; //increment the counter of number of dielectronic recombination parameter sets
-                }
-                else if(ions[n].total_rrflag > 0) //       unexpected second line matching z and charge
-                {
-                  logfile("More than one badnell total RR rate for ion %i\n", n);
-                  logfile("Get_atomic_data: %s\n", aline);
-                  return ATOMIC_ERROR_TODO;
-                }
-                else            //if flag is not a positive number, we have a problem
-                {
-                  logfile("Total radiative recombination flag giving odd results\n");
-                  return ATOMIC_ERROR_TODO;
-                }
-              }                 //close if statement that selects appropriate ion to add data to
-            }                   //close loop over ions
+              logfile("Total radiative recombination flag giving odd results\n");
+              return ATOMIC_ERROR_TODO;
+            }
+          }                 //close if statement that selects appropriate ion to add data to
 
 
 
-            break;
+          break;
 
 /**
  * @section Total radiative recombination - type 3
@@ -3048,48 +4062,46 @@ would like to have simple lines for macro-ions */
 
 
 
-          case 's':
-            nparam = sscanf(aline, "%*s %d %d %le %le ", &z, &ne, &btrr[0], &btrr[1]);  //split and assign the line
-            nparam -= 2;        //take 4 off the nparam to give the number of actual parameters
-            if(nparam > 6 || nparam < 1)  //     trap errors - not as robust as usual because there are a varaible number of parameters...
+        case 's':
+          nparam = record_scanf(record, RECORD_RR_SHULL, &z, &ne, &btrr[0], &btrr[1]);  //split and assign the line
+          nparam -= 2;        //take 4 off the nparam to give the number of actual parameters
+          if(nparam > 6 || nparam < 1)  //     trap errors - not as robust as usual because there are a varaible number of parameters...
+          {
+            logfile("Something wrong with shull total RR data\n", file, lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+
+          istate = ne;        //         get the traditional ionisation state
+          n = ion_index(z, istate);  //Look up the ion to put the data in
+          if(n >= 0)  // this works out which ion we are dealing with
+          {
+            if(ion_links[n].total_rrflag == 0) // this ion has no parameters, so it must be the first time through
+            {
+              total_rr[n_total_rr].nion = n;  //put the ion number into the bad_t_rr structure
+              ion_links[n].nxtotalrr = n_total_rr; /*put the number of the bad_t_rr into the ion
+                                                 structure so we can go either way. */
+              total_rr[n_total_rr].type = RRTYPE_SHULL;
+              for(n1 = 0; n1 < nparam; n1++)
+              {
+                total_rr[n_total_rr].params[n1] = btrr[n1]; //we are getting  parameters
+              }
+              ion_links[n].total_rrflag++; //increment the flag by 1. We will do this rather than simply setting it to 1 so we will get errors if we do this more than once....
+              n_total_rr++; //increment the counter of number of dielectronic recombination parameter sets
+            }
+            else if(ion_links[n].total_rrflag > 0) //       unexpected second line matching z and charge
             {
-              logfile("Something wrong with shull total RR data\n", file, lineno);
+              logfile("More than one total RR rate for ion %i\n", n);
               logfile("Get_atomic_data: %s\n", aline);
               return ATOMIC_ERROR_TODO;
             }
-
-            istate = ne;        //         get the traditional ionisation state
-            for(n = 0; n < nions; n++)  //Loop over ions to find the correct place to put the data
+            else            //if flag is not a positive number, we have a problem
             {
-              if(ions[n].z == z && ions[n].istate == istate)  // this works out which ion we are dealing with
-              {
-                if(ions[n].total_rrflag == 0) // this ion has no parameters, so it must be the first time through
-                {
-                  total_rr[n_total_rr].nion = n;  //put the ion number into the bad_t_rr structure
-                  ions[n].nxtotalrr = n_total_rr; /*put the number of the bad_t_rr into the ion
-                                                     structure so we can go either way. */
-                  total_rr[n_total_rr].type = RRTYPE_SHULL;
-                  for(n1 = 0; n1 < nparam; n1++)
-                  {
-                    total_rr[n_total_rr].params[n1] = btrr[n1]; //we are getting  parameters
-                  }
-                  ions[n].total_rrflag++; //increment the flag by 1. We will do this rather than simply setting it to 1 so we will get errors if we do this more than once....
-                  n_total_rr++; //increment the counter of number of dielectronic recombination parameter sets
-                }
-                else if(ions[n].total_rrflag > 0) //       unexpected second line matching z and charge
-                {
-                  logfile("More than one total RR rate for ion %i\n", n);
-                  logfile("Get_atomic_data: %s\n", aline);
-                  return ATOMIC_ERROR_TODO;
-                }
-                else            //if flag is not a positive number, we have a problem
-                {
-                  logfile("Total radiative recombination flag giving odd results\n");
-                  return ATOMIC_ERROR_TODO;
-                }
-              }                 //close if statement that selects appropriate ion to add data to
-            }                   //close loop over ions
-            break;
+              logfile("Total radiative recombination flag giving odd results\n");
+              return ATOMIC_ERROR_TODO;
+            }
+          }                 //close if statement that selects appropriate ion to add data to
+          break;
 
 
 /**
@@ -3110,84 +4122,82 @@ would like to have simple lines for macro-ions */
 
  */
 
-          case 'G':
-            nparam = sscanf(aline, "%*s %s %d %d %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le", &gsflag, &z, &ne, &gstemp[0], &gstemp[1], &gstemp[2], &gstemp[3], &gstemp[4], &gstemp[5], &gstemp[6], &gstemp[7], &gstemp[8], &gstemp[9], &gstemp[10], &gstemp[11], &gstemp[12], &gstemp[13], &gstemp[14], &gstemp[15], &gstemp[16], &gstemp[17], &gstemp[18]);  //split and assign the line
-            nparam -= 3;        //take 4 off the nparam to give the number of actual parameters
-            if(nparam > 19 || nparam < 1) //     trap errors - not as robust as usual because there are a varaible number of parameters...
+        case 'G':
+          nparam = record_scanf(record, RECORD_BAD_GS_RR, gsflag, &z, &ne, &gstemp[0], &gstemp[1], &gstemp[2], &gstemp[3], &gstemp[4], &gstemp[5], &gstemp[6], &gstemp[7], &gstemp[8], &gstemp[9], &gstemp[10], &gstemp[11], &gstemp[12], &gstemp[13], &gstemp[14], &gstemp[15], &gstemp[16], &gstemp[17], &gstemp[18]);  //split and assign the line
+          nparam -= 3;        //take 4 off the nparam to give the number of actual parameters
+          if(nparam > 19 || nparam < 1) //     trap errors - not as robust as usual because there are a varaible number of parameters...
+          {
+            logfile("Something wrong with badnell GS RR data\n");
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          istate = z - ne + 1;  //         get the traditional ionisation state
+          n = ion_index(z, istate);  //Look up the ion to put the data in
+          if(n >= 0)  // this works out which ion we are dealing with
+          {
+            if(ion_links[n].bad_gs_rr_t_flag == 0 && ion_links[n].bad_gs_rr_r_flag == 0)  //This is first set of this type of data for this ion
             {
-              logfile("Something wrong with badnell GS RR data\n");
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
+              bad_gs_rr[n_bad_gs_rr].nion = n;  //put the ion number into the bad_t_rr structure
+              ion_links[n].nxbadgsrr = n_bad_gs_rr;  //put the number of the bad_t_rr into the ion structure so we can go either way.
+              n_bad_gs_rr++;  //increment the counter of number of ground state RR
             }
-            istate = z - ne + 1;  //         get the traditional ionisation state
-            for(n = 0; n < nions; n++)  //Loop over ions to find the correct place to put the data
+            /*Now work out what type of line it is, and where it needs to go */
+            if(gsflag[0] == 'T') //it is a temperature line
             {
-              if(ions[n].z == z && ions[n].istate == istate)  // this works out which ion we are dealing with
+              if(ion_links[n].bad_gs_rr_t_flag == 0) //and we need a temp line for this ion
               {
-                if(ions[n].bad_gs_rr_t_flag == 0 && ions[n].bad_gs_rr_r_flag == 0)  //This is first set of this type of data for this ion
-                {
-                  bad_gs_rr[n_bad_gs_rr].nion = n;  //put the ion number into the bad_t_rr structure
-                  ions[n].nxbadgsrr = n_bad_gs_rr;  //put the number of the bad_t_rr into the ion structure so we can go either way.
-                  n_bad_gs_rr++;  //increment the counter of number of ground state RR
-                }
-                /*Now work out what type of line it is, and where it needs to go */
-                if(gsflag == 'T') //it is a temperature line
-                {
-                  if(ions[n].bad_gs_rr_t_flag == 0) //and we need a temp line for this ion
-                  {
-                    if(gstemp[0] > gstmin)
-                      gstmin = gstemp[0];
-                    if(gstemp[18] < gstmax)
-                      gstmax = gstemp[18];
-                    ions[n].bad_gs_rr_t_flag = 1; //set the flag
-                    for(n1 = 0; n1 < nparam; n1++)
-                    {
-                      bad_gs_rr[ions[n].nxbadgsrr].temps[n1] = gstemp[n1];
-                    }
-                  }
-                  else if(ions[n].bad_gs_rr_t_flag == 1)  //we already have a temp line for this ion
-                  {
-                    logfile("More than one temp line for badnell GS RR rate for ion %i\n", n);
-                    logfile("Get_atomic_data: %s\n", aline);
-                    return ATOMIC_ERROR_TODO;
-                  }
-                  else          //some other odd thing had happened
-                  {
-                    logfile("Get_atomic_data: %s\n", aline);
-                    return ATOMIC_ERROR_TODO;
-                  }
-                }
-                else if(gsflag == 'R')  //it is a rate line
+                if(gstemp[0] > gstmin)
+                  gstmin = gstemp[0];
+                if(gstemp[18] < gstmax)
+                  gstmax = gstemp[18];
+                ion_links[n].bad_gs_rr_t_flag = 1; //set the flag
+                for(n1 = 0; n1 < nparam; n1++)
                 {
-                  if(ions[n].bad_gs_rr_r_flag == 0) //and we need a rate line for this ion
-                  {
-                    ions[n].bad_gs_rr_r_flag = 1; //set the flag
-                    for(n1 = 0; n1 < nparam; n1++)
-                    {
-                      bad_gs_rr[ions[n].nxbadgsrr].rates[n1] = gstemp[n1];
-                    }
-                  }
-                  else if(ions[n].bad_gs_rr_r_flag == 1)  //we already have a rate line for this ion
-                  {
-                    logfile("More than one rate line for badnell GS RR rate for ion %i\n", n);
-                    logfile("Get_atomic_data: %s\n", aline);
-                    return ATOMIC_ERROR_TODO;
-                  }
-                  else          //some other odd thing had happened
-                  {
-                    logfile("Get_atomic_data: %s\n", aline);
-                    return ATOMIC_ERROR_TODO;
-                  }
+                  bad_gs_rr[ion_links[n].nxbadgsrr].temps[n1] = gstemp[n1];
                 }
-                else            //We have some problem with this line
+              }
+              else if(ion_links[n].bad_gs_rr_t_flag == 1)  //we already have a temp line for this ion
+              {
+                logfile("More than one temp line for badnell GS RR rate for ion %i\n", n);
+                logfile("Get_atomic_data: %s\n", aline);
+                return ATOMIC_ERROR_TODO;
+              }
+              else          //some other odd thing had happened
+              {
+                logfile("Get_atomic_data: %s\n", aline);
+                return ATOMIC_ERROR_TODO;
+              }
+            }
+            else if(gsflag[0] == 'R')  //it is a rate line
+            {
+              if(ion_links[n].bad_gs_rr_r_flag == 0) //and we need a rate line for this ion
+              {
+                ion_links[n].bad_gs_rr_r_flag = 1; //set the flag
+                for(n1 = 0; n1 < nparam; n1++)
                 {
-                  logfile("Get_atomic_data: %s\n", aline);
-                  return ATOMIC_ERROR_TODO;
+                  bad_gs_rr[ion_links[n].nxbadgsrr].rates[n1] = gstemp[n1];
                 }
-              }                 //end of loop over dealing with data for a discovered ion
-            }                   //end of loop over ions
+              }
+              else if(ion_links[n].bad_gs_rr_r_flag == 1)  //we already have a rate line for this ion
+              {
+                logfile("More than one rate line for badnell GS RR rate for ion %i\n", n);
+                logfile("Get_atomic_data: %s\n", aline);
+                return ATOMIC_ERROR_TODO;
+              }
+              else          //some other odd thing had happened
+              {
+                logfile("Get_atomic_data: %s\n", aline);
+                return ATOMIC_ERROR_TODO;
+              }
+            }
+            else            //We have some problem with this line
+            {
+              logfile("Get_atomic_data: %s\n", aline);
+              return ATOMIC_ERROR_TODO;
+            }
+          }                 //end of loop over dealing with data for a discovered ion
 
-            break;
+          break;
 
 /**
  * @section gaunt factor
@@ -3207,33 +4217,33 @@ would like to have simple lines for macro-ions */
 * @endverbatim
 
  */
-          case 'g':
-            nparam = sscanf(aline, "%*s %le %le %le %le %le", &gsqrdtemp, &gfftemp, &s1temp, &s2temp, &s3temp); //split and assign the line
-            if(nparam > 5 || nparam < 1)  //     trap errors
-            {
-              logfile("Something wrong with sutherland gaunt data\n");
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
-            if(gaunt_n_gsqrd == 0 || gsqrdtemp > gaunt_total[gaunt_n_gsqrd - 1].log_gsqrd)  //We will use it if it's our first piece of data or is in order
-            {
-              gaunt_total[gaunt_n_gsqrd].log_gsqrd = gsqrdtemp; //The scaled electron temperature squared for this array
-              gaunt_total[gaunt_n_gsqrd].gff = gfftemp;
-              gaunt_total[gaunt_n_gsqrd].s1 = s1temp;
-              gaunt_total[gaunt_n_gsqrd].s2 = s2temp;
-              gaunt_total[gaunt_n_gsqrd].s3 = s3temp;
-              gaunt_n_gsqrd++;
-            }
-            else
-            {
-              logfile("Something wrong with gaunt data\n");
-              logfile("Get_atomic_data %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
+        case 'g':
+          nparam = record_scanf(record, RECORD_FF_GAUNT, &gsqrdtemp, &gfftemp, &s1temp, &s2temp, &s3temp); //split and assign the line
+          if(nparam > 5 || nparam < 1)  //     trap errors
+          {
+            logfile("Something wrong with sutherland gaunt data\n");
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          if(gaunt_n_gsqrd == 0 || gsqrdtemp > gaunt_total[gaunt_n_gsqrd - 1].log_gsqrd)  //We will use it if it's our first piece of data or is in order
+          {
+            gaunt_total[gaunt_n_gsqrd].log_gsqrd = gsqrdtemp; //The scaled electron temperature squared for this array
+            gaunt_total[gaunt_n_gsqrd].gff = gfftemp;
+            gaunt_total[gaunt_n_gsqrd].s1 = s1temp;
+            gaunt_total[gaunt_n_gsqrd].s2 = s2temp;
+            gaunt_total[gaunt_n_gsqrd].s3 = s3temp;
+            gaunt_n_gsqrd++;
+          }
+          else
+          {
+            logfile("Something wrong with gaunt data\n");
+            logfile("Get_atomic_data %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
 
 
 
-            break;
+          break;
 /**
  * @section direct (collisional) ionization data from Dere 07.
  * #Title: Ionization rate coefficients for elements H to Zn (Dere+, 2007)
@@ -3247,42 +4257,40 @@ would like to have simple lines for macro-ions */
  * #Column x1-X20      (F7.4)  Scaled temperature 1 (1)        [ucd=phys.temperature]
  * #Column rho1 -rho20   (F8.4)  ? Scaled rate coefficient 1 (2) [ucd=arith.rate;phys.atmol.collisional]
  */
-          case 'd':
-            nparam = sscanf(aline, "%*s %d %d %d %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le", &z, &istate, &nspline, &et, &tmin, &temp[0], &temp[1], &temp[2], &temp[3], &temp[4], &temp[5], &temp[6], &temp[7], &temp[8], &temp[9], &temp[10], &temp[11], &temp[12], &temp[13], &temp[14], &temp[15], &temp[16], &temp[17], &temp[18], &temp[19], &temp[20], &temp[21], &temp[22], &temp[23], &temp[24], &temp[25], &temp[26], &temp[27], &temp[28], &temp[29], &temp[30], &temp[31], &temp[32], &temp[33], &temp[34], &temp[35], &temp[36], &temp[37], &temp[38], &temp[39]);  //split and assign the line
+        case 'd':
+          nparam = record_scanf(record, RECORD_DI_DERE, &z, &istate, &nspline, &et, &tmin, &temp[0], &temp[1], &temp[2], &temp[3], &temp[4], &temp[5], &temp[6], &temp[7], &temp[8], &temp[9], &temp[10], &temp[11], &temp[12], &temp[13], &temp[14], &temp[15], &temp[16], &temp[17], &temp[18], &temp[19], &temp[20], &temp[21], &temp[22], &temp[23], &temp[24], &temp[25], &temp[26], &temp[27], &temp[28], &temp[29], &temp[30], &temp[31], &temp[32], &temp[33], &temp[34], &temp[35], &temp[36], &temp[37], &temp[38], &temp[39]);  //split and assign the line
 
-            if(nparam != 5 + (nspline * 2)) //     trap errors
-            {
-              logfile("Something wrong with Dere DI data\n");
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
-            for(n = 0; n < nions; n++)  //Loop over ions to find the correct place to put the data
+          if(nparam != 5 + (nspline * 2)) //     trap errors
+          {
+            logfile("Something wrong with Dere DI data\n");
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          n = ion_index(z, istate);  //Look up the ion to put the data in
+          if(n >= 0)  // this works out which ion we are dealing with
+          {
+            if(ion_links[n].dere_di_flag == 0) //This is first set of this type of data for this ion
             {
-              if(ions[n].z == z && ions[n].istate == istate)  // this works out which ion we are dealing with
+              ion_links[n].dere_di_flag = 1;
+              dere_di_rate[n_dere_di_rate].nion = n;  //put the ion number into the dere_di_rate structure
+              ion_links[n].nxderedi = n_dere_di_rate;  //put the number of the dere_di_rate into the ion structure so we can go either way.
+              dere_di_rate[n_dere_di_rate].xi = et;
+              dere_di_rate[n_dere_di_rate].min_temp = tmin;
+              dere_di_rate[n_dere_di_rate].nspline = nspline;
+              for(n1 = 0; n1 < nspline; n1++)
               {
-                if(ions[n].dere_di_flag == 0) //This is first set of this type of data for this ion
-                {
-                  ions[n].dere_di_flag = 1;
-                  dere_di_rate[n_dere_di_rate].nion = n;  //put the ion number into the dere_di_rate structure
-                  ions[n].nxderedi = n_dere_di_rate;  //put the number of the dere_di_rate into the ion structure so we can go either way.
-                  dere_di_rate[n_dere_di_rate].xi = et;
-                  dere_di_rate[n_dere_di_rate].min_temp = tmin;
-                  dere_di_rate[n_dere_di_rate].nspline = nspline;
-                  for(n1 = 0; n1 < nspline; n1++)
-                  {
-                    dere_di_rate[n_dere_di_rate].temps[n1] = temp[n1];
-                    dere_di_rate[n_dere_di_rate].rates[n1] = temp[n1 + nspline] * 1e-6;
-
-                  }
-                  n_dere_di_rate++; //increment the counter of number of ground state RR
-                }
-                else
-                {
-                  logfile("Get_atomic_data: More than one Dere DI rate for ion %i\n", n);
-                }
+                dere_di_rate[n_dere_di_rate].temps[n1] = temp[n1];
+                dere_di_rate[n_dere_di_rate].rates[n1] = temp[n1 + nspline] * 1e-6;
+
               }
+              n_dere_di_rate++; //increment the counter of number of ground state RR
             }
-            break;
+            else
+            {
+              logfile("Get_atomic_data: More than one Dere DI rate for ion %i\n", n);
+            }
+          }
+          break;
 
 /**
  * @section Electron yield - goes with auger ionization rates
@@ -3298,47 +4306,45 @@ would like to have simple lines for macro-ions */
 
 */
 
-          case 'K':
-            nparam =
-              sscanf(aline,
-                     "%*s %d %d %d %d %le %le %le %le %le %le %le %le %le %le %le %le",
-                     &z, &istate, &in, &il, &I, &Ea, &temp[0],
-                     &temp[1], &temp[2], &temp[3], &temp[4], &temp[5], &temp[6], &temp[7], &temp[8], &temp[9]);
-            if(nparam != 16)
-            {
-              logfile("Something wrong with electron yield data\n");
-              logfile("Get_atomic_data %s\n", aline);
-              return ATOMIC_ERROR_TODO;
-            }
-            for(n = 0; n < n_inner_tot; n++)
+        case 'K':
+          nparam =
+            record_scanf(record, RECORD_KELECYIELD, &z, &istate, &in, &il, &I, &Ea, &temp[0],
+                         &temp[1], &temp[2], &temp[3], &temp[4], &temp[5], &temp[6], &temp[7], &temp[8], &temp[9]);
+          if(nparam != 16)
+          {
+            logfile("Something wrong with electron yield data\n");
+            logfile("Get_atomic_data %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          for(n = 0; n < n_inner_tot; n++)
+          {
+            if(inner_cross[n].z == z && inner_cross[n].istate == istate && inner_cross[n].n == in
+               && inner_cross[n].l == il)
             {
-              if(inner_cross[n].z == z && inner_cross[n].istate == istate && inner_cross[n].n == in
-                 && inner_cross[n].l == il)
+              if(inner_cross[n].n_elec_yield == -1) /*This is the first yield data for this vacancy */
               {
-                if(inner_cross[n].n_elec_yield == -1) /*This is the first yield data for this vacancy */
-                {
-                  inner_elec_yield[n_elec_yield_tot].nion = n;  /*This yield refers to this ion */
-                  inner_cross[n].n_elec_yield = n_elec_yield_tot;
-                  inner_elec_yield[n_elec_yield_tot].z = z;
-                  inner_elec_yield[n_elec_yield_tot].istate = istate;
-                  inner_elec_yield[n_elec_yield_tot].n = in;
-                  inner_elec_yield[n_elec_yield_tot].l = il;
-                  inner_elec_yield[n_elec_yield_tot].I = I * EV2ERGS;
-                  inner_elec_yield[n_elec_yield_tot].Ea = Ea * EV2ERGS;
-                  for(n1 = 0; n1 < 10; n1++)
-                  {
-                    inner_elec_yield[n_elec_yield_tot].prob[n1] = temp[n1] / 10000.0;
-                  }
-                  n_elec_yield_tot++;
-                }
-                else
+                inner_elec_yield[n_elec_yield_tot].nion = n;  /*This yield refers to this ion */
+                inner_cross[n].n_elec_yield = n_elec_yield_tot;
+                inner_elec_yield[n_elec_yield_tot].z = z;
+                inner_elec_yield[n_elec_yield_tot].istate = istate;
+                inner_elec_yield[n_elec_yield_tot].n = in;
+                inner_elec_yield[n_elec_yield_tot].l = il;
+                inner_elec_yield[n_elec_yield_tot].I = I * EV2ERGS;
+                inner_elec_yield[n_elec_yield_tot].Ea = Ea * EV2ERGS;
+                for(n1 = 0; n1 < 10; n1++)
                 {
-                  logfile("Get_atomic_data: more than one electron yield record for inner_cross %i z=%i istate=%i\n", n,
-                          z, istate);
+                  inner_elec_yield[n_elec_yield_tot].prob[n1] = temp[n1] / 10000.0;
                 }
+                n_elec_yield_tot++;
+              }
+              else
+              {
+                logfile("Get_atomic_data: more than one electron yield record for inner_cross %i z=%i istate=%i\n", n,
+                        z, istate);
               }
             }
-            break;
+          }
+          break;
 /**
  * @section Fluorescent photon yield from inner shell ionization - not currently used but read in.
 		  now not read in - see #499
@@ -3353,37 +4359,37 @@ would like to have simple lines for macro-ions */
  * Kphotyield 5 1 1 0 1.690e+01 7.129e-01
  * @endverbatim
 
-        case 'F':
-          nparam = sscanf (aline, "%*s %d %d %d %d %le %le ", &z, &istate, &in, &il, &energy, &yield);
-          if (nparam != 6)
-          {
-            Log ("Something wrong with fluorescent yield data\n");
-            Log ("Get_atomic_data %s\n", aline);
-            return ATOMIC_ERROR_TODO;
-          }
-          for (n = 0; n < n_inner_tot; n++)
+      case 'F':
+        nparam = sscanf (aline, "%*s %d %d %d %d %le %le ", &z, &istate, &in, &il, &energy, &yield);
+        if (nparam != 6)
+        {
+          Log ("Something wrong with fluorescent yield data\n");
+          Log ("Get_atomic_data %s\n", aline);
+          return ATOMIC_ERROR_TODO;
+        }
+        for (n = 0; n < n_inner_tot; n++)
+        {
+          if (inner_cross[n].z == z && inner_cross[n].istate == istate && inner_cross[n].n == in && inner_cross[n].l == il)
           {
-            if (inner_cross[n].z == z && inner_cross[n].istate == istate && inner_cross[n].n == in && inner_cross[n].l == il)
+            if (inner_cross[n].n_fluor_yield == -1)   //This is the first yield data for this vacancy
             {
-              if (inner_cross[n].n_fluor_yield == -1)   //This is the first yield data for this vacancy
-              {
-                inner_fluor_yield[n_fluor_yield_tot].nion = n;  //This yield refers to this ion
-                inner_cross[n].n_fluor_yield = n_fluor_yield_tot;
-                inner_fluor_yield[n_fluor_yield_tot].z = z;
-                inner_fluor_yield[n_fluor_yield_tot].istate = istate;
-                inner_fluor_yield[n_fluor_yield_tot].n = in;
-                inner_fluor_yield[n_fluor_yield_tot].l = il;
-                inner_fluor_yield[n_fluor_yield_tot].freq = energy / HEV;
-                inner_fluor_yield[n_fluor_yield_tot].yield = yield;
-                n_fluor_yield_tot++;
-              }
-              else
-              {
-                Log ("Get_atomic_data: more than one fluorescent yield record for inner_cross %i\n", n);
-              }
+              inner_fluor_yield[n_fluor_yield_tot].nion = n;  //This yield refers to this ion
+              inner_cross[n].n_fluor_yield = n_fluor_yield_tot;
+              inner_fluor_yield[n_fluor_yield_tot].z = z;
+              inner_fluor_yield[n_fluor_yield_tot].istate = istate;
+              inner_fluor_yield[n_fluor_yield_tot].n = in;
+              inner_fluor_yield[n_fluor_yield_tot].l = il;
+              inner_fluor_yield[n_fluor_yield_tot].freq = energy / HEV;
+              inner_fluor_yield[n_fluor_yield_tot].yield = yield;
+              n_fluor_yield_tot++;
+            }
+            else
+            {
+              Log ("Get_atomic_data: more than one fluorescent yield record for inner_cross %i\n", n);
             }
           }
-          break;
+        }
+        break;
 		  */
 
 /**
@@ -3409,120 +4415,121 @@ SCUPS    1.132e-01   2.708e-01   5.017e-01   8.519e-01   1.478e+00
 
  *		  */
 
-          case 'C':
-            nparam =
-              (sscanf
-               (aline,
-                "%*s %*s %d %2d %le %le %le %le %le %le %d %d %d %d %le %le %le %d %d %le",
-                &z, &istate, &freq, &f, &gl, &gu, &el, &eu, &levl, &levu, &c_l, &c_u, &en, &gf, &hlt, &np, &type, &sp));
-            if(nparam != 18)
+        case 'C':
+          nparam =
+            (record_scanf(record, RECORD_CSTREN, &z, &istate, &freq, &f, &gl, &gu, &el, &eu, &levl, &levu, &c_l, &c_u, &en, &gf, &hlt, &np, &type, &sp));
+          if(nparam != 18)
+          {
+            logfile("Get_atomic_data: file %s line %d: Collision strength line incorrectly formatted\n", file,
+                    lineno);
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
+          /* Look the line up in the hash index of the lines, which is rebuilt if lines have been read since */
+
+          if(line_key_head == NULL || line_key_nindexed != nlines)
+          {
+            if(index_line_keys())
             {
-              logfile("Get_atomic_data: file %s line %d: Collision strength line incorrectly formatted\n", file,
-                      lineno);
-              logfile("Get_atomic_data: %s\n", aline);
-              return ATOMIC_ERROR_TODO;
+              logfile("Get_atomic_data: Unable to allocate memory for the index of lines\n");
+              return ATOMIC_MEMORY_ISSUE_ERROR;
             }
-            match = 0;
-            for(n = 0; n < nlines; n++) //loop over all the lines we have read in - look for a match
-            {
-              if(line[n].z == z && line[n].istate == istate
-                 && line[n].levl == levl && line[n].levu == levu && line[n].gl == gl && line[n].gu == gu
-                 && line[n].f == f)
-              {
-                if(line[n].coll_index > -1) //We already have a collision strength record from this line - throw an error and quit
-                {
-                  logfile("Get_atomic_data More than one collision strength record for line %i\n", n);
-                  return ATOMIC_ERROR_TODO;
-                }
-                match = 1;
-                coll_stren[n_coll_stren].n = n_coll_stren;
-                coll_stren[n_coll_stren].lower = c_l;
-                coll_stren[n_coll_stren].upper = c_u;
-                coll_stren[n_coll_stren].energy = en;
-                coll_stren[n_coll_stren].gf = gf;
-                coll_stren[n_coll_stren].hi_t_lim = hlt;
-                coll_stren[n_coll_stren].n_points = np;
-                coll_stren[n_coll_stren].type = type;
-                coll_stren[n_coll_stren].scaling_param = sp;
-
-                line[n].coll_index = n_coll_stren;  //point the line to its matching collision strength
-
-                //We now read in two lines of fitting data
-                if(fgets(aline, LINELENGTH, fptr) == NULL)
-                {
-                  logfile("Get_atomic_data: Problem reading collision strength record\n");
-                  logfile("Get_atomic_data: %s\n", aline);
-                  return ATOMIC_ERROR_TODO;
-                }
+          }
+
+          n = find_coll_stren_line(z, istate, levl, levu, gl, gu, f, &match);
+
+          if(match > 1)
+          {
+            logfile("Get_atomic_data: file %s line %d: Collision strength record matches %d lines, using line %d\n",
+                    file, lineno, match, n);
+          }
+
+          if(n >= 0 && line_links[n].coll_index > -1)  //We already have a collision strength record for this line - ignore this one
+          {
+            logfile("Get_atomic_data: file %s line %d: More than one collision strength record for line %i\n", file,
+                    lineno, n);
+            cstren_duplicate++;
+            get_next_record(batch);
+            get_next_record(batch);
+            break;
+          }
+
+          if(n < 0)           //Fix for an error where a line match isn't found - this then causes the next two lines to be skipped
+          {
+            get_next_record(batch);
+            get_next_record(batch);
+            cstren_no_line++;
+            break;
+          }
+
+          coll_stren[n_coll_stren].n = n_coll_stren;
+          coll_stren[n_coll_stren].lower = c_l;
+          coll_stren[n_coll_stren].upper = c_u;
+          coll_stren[n_coll_stren].energy = en;
+          coll_stren[n_coll_stren].gf = gf;
+          coll_stren[n_coll_stren].hi_t_lim = hlt;
+          coll_stren[n_coll_stren].n_points = np;
+          coll_stren[n_coll_stren].type = type;
+          coll_stren[n_coll_stren].scaling_param = sp;
+
+          line_links[n].coll_index = n_coll_stren;  //point the line to its matching collision strength
+
+          //We now read in two lines of fitting data
+          if((record = get_next_record(batch)) == NULL)
+          {
+            logfile("Get_atomic_data: Problem reading collision strength record\n");
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
 
-                /* JM 1709 -- increased number of entries read up to max of 20 */
-                nparam =
-                  sscanf(aline,
-                         "%*s %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le",
-                         &temp[0], &temp[1], &temp[2], &temp[3],
+          /* JM 1709 -- increased number of entries read up to max of 20 */
+          nparam =
+            record_scanf(record, RECORD_CSTREN_SPLINE, &temp[0], &temp[1], &temp[2], &temp[3],
                          &temp[4], &temp[5], &temp[6], &temp[7],
                          &temp[8], &temp[9], &temp[10], &temp[11],
                          &temp[12], &temp[13], &temp[14], &temp[15], &temp[16], &temp[17], &temp[18], &temp[19]);
 
-                for(nn = 0; nn < np; nn++)
-                {
-                  coll_stren[n_coll_stren].sct[nn] = temp[nn];
-                }
-                if(fgets(aline, LINELENGTH, fptr) == NULL)
-                {
-                  logfile("Get_atomic_data: Problem reading collision strength record\n");
-                  logfile("Get_atomic_data: %s\n", aline);
-                  return ATOMIC_ERROR_TODO;
-                }
+          for(nn = 0; nn < np; nn++)
+          {
+            coll_stren[n_coll_stren].sct[nn] = temp[nn];
+          }
+          if((record = get_next_record(batch)) == NULL)
+          {
+            logfile("Get_atomic_data: Problem reading collision strength record\n");
+            logfile("Get_atomic_data: %s\n", aline);
+            return ATOMIC_ERROR_TODO;
+          }
 
-                nparam =
-                  sscanf(aline,
-                         "%*s %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le %le",
-                         &temp[0], &temp[1], &temp[2], &temp[3],
+          nparam =
+            record_scanf(record, RECORD_CSTREN_SPLINE, &temp[0], &temp[1], &temp[2], &temp[3],
                          &temp[4], &temp[5], &temp[6], &temp[7],
                          &temp[8], &temp[9], &temp[10], &temp[11],
                          &temp[12], &temp[13], &temp[14], &temp[15], &temp[16], &temp[17], &temp[18], &temp[19]);
 
-                for(nn = 0; nn < np; nn++)
-                {
-                  coll_stren[n_coll_stren].scups[nn] = temp[nn];
-                }
-                n_coll_stren++;
-              }
-            }
-            if(match == 0)      //Fix for an error where a line match isn't found - this then causes the next two lines to be skipped
-            {
-              char *ret1 = fgets(aline, LINELENGTH, fptr);
-              char *ret2 = fgets(aline, LINELENGTH, fptr);
-              if(ret1 == NULL || ret2 == NULL)  // Lazy solution to avoid compiler warnings
-              {
-                ;
-              }
-              cstren_no_line++;
-            }
-            break;
-
-          case 'c':            /* It was a comment line so do nothing */
-            break;
-          case 'z':
-          default:
-            logfile("get_atomicdata: Could not interpret line %d in file %s: %s\n", lineno, file, aline);
-            break;
-        }
+          for(nn = 0; nn < np; nn++)
+          {
+            coll_stren[n_coll_stren].scups[nn] = temp[nn];
+          }
+          n_coll_stren++;
+          break;
 
-        strcpy(aline, "");
+        case 'c':            /* It was a comment line so do nothing */
+          break;
+        case 'z':
+        default:
+          logfile("get_atomicdata: Could not interpret line %d in file %s: %s\n", lineno, file, aline);
+          break;
       }
 
-      fclose(fptr);
     }
-    /*End of do loop for reading a particular file of data */
+    /*End of do loop for processing the records of a particular file of data */
   }
 
-/* End of main do loop for reading all of the the data. At this point we can close
-   the masterfile
- */
+/* End of main do loop for reading all of the the data. The records and the index of lines are no longer needed */
+
+  free_atomic_data_batches();
+  free_line_key_index();
 
-  fclose(mptr);
 /* OK now summarize the data that has been read*/
 
   n_elec_yield_tot = 0;         //Reset this numnber, we are now going to use it to check we have yields for all inner shells
@@ -3556,7 +4563,7 @@ SCUPS    1.132e-01   2.708e-01   5.017e-01   8.519e-01   1.478e+00
   atomic_summary_add("The minimum frequency for inner shell ionization is %8.2e", inner_freq_min);
 
   /* report ignored simple lines for macro-ions */
-  for(n = 0; n < NIONS; n++)
+  for(n = 0; n < nions; n++)
   {
     if(simple_line_ignore[n] > 0)
       atomic_summary_add("Ignored %d simple lines for macro-ion %d", simple_line_ignore[n], n);
@@ -3565,6 +4572,8 @@ SCUPS    1.132e-01   2.708e-01   5.017e-01   8.519e-01   1.478e+00
   /* report ignored collision strengths */
   if(cstren_no_line > 0)
     atomic_summary_add("Ignored %d collision strengths with no matching line transition", cstren_no_line);
+  if(cstren_duplicate > 0)
+    atomic_summary_add("Ignored %d collision strengths for line transitions which already had one", cstren_duplicate);
   if(inner_no_e_yield > 0)
     atomic_summary_add("Ignored %d inner shell cross sections because no matching yields", inner_no_e_yield);
 
@@ -3638,18 +4647,14 @@ a total emission oscillator strength for the level....really ought to be radiati
       mstart = ions[line[n].nion].firstlevel;
       mstop = mstart + ions[line[n].nion].nlevels;
 
-      m = mstart;
-      while(config[m].ilv != line[n].levl && m < mstop)
-        m++;
-      if(m < mstop)
+      m = find_ion_level(line[n].z, line[n].istate, line[n].levl, mstart, mstop);
+      if(m >= 0)
         line[n].nconfigl = m;
       else
         line[n].nconfigl = -9999;
 
-      m = mstart;
-      while(config[m].ilv != line[n].levu && m < mstop)
-        m++;
-      if(m < mstop)
+      m = find_ion_level(line[n].z, line[n].istate, line[n].levu, mstart, mstop);
+      if(m >= 0)
       {
         line[n].nconfigu = m;
         config[m].rad_rate += a21(&line[n]);
@@ -3659,6 +4664,8 @@ a total emission oscillator strength for the level....really ought to be radiati
     }
   }
 
+  free_config_key_index();       // The levels have all been linked, so the index of them is no longer needed
+
 /* Check that all of the macro_info variables are initialized to 1
 or zero so that simple checks of true and false can be used for them */
 
@@ -3699,16 +4706,28 @@ or zero so that simple checks of true and false can be used for them */
     }
   }
 
+/* Group the Macro Atom jumps by configuration, now that they have all been read in */
+
+  if(build_macro_jumps())
+  {
+    logfile("get_atomic_data: Unable to allocate memory for the Macro Atom jumps\n");
+    return ATOMIC_MEMORY_ISSUE_ERROR;
+  }
+
 /* Finally evaluate how close we are to limits set in the structures */
 
   atomic_summary_add("get_atomic_data: Evaluation:  There are %6d elements     while %6d are currently allowed",
                      nelements, NELEMENTS);
-  atomic_summary_add("get_atomic_data: Evaluation:  There are %6d ions         while %6d are currently allowed", nions,
-                     NIONS);
-  atomic_summary_add("get_atomic_data: Evaluation:  There are %6d levels       while %6d are currently allowed",
-                     nlevels, NLEVELS);
-  atomic_summary_add("get_atomic_data: Evaluation:  There are %6d lines        while %6d are currently allowed", nlines,
-                     NLINES);
+  atomic_summary_add("get_atomic_data: Evaluation:  There are %6d ions         while %6d are currently allocated", nions,
+                     nions_max);
+  atomic_summary_add("get_atomic_data: Evaluation:  There are %6d levels       while %6d are currently allocated",
+                     nlevels, nlevels_max);
+  atomic_summary_add("get_atomic_data: Evaluation:  There are %6d lines        while %6d are currently allocated", nlines,
+                     nlines_max);
+  atomic_summary_add("get_atomic_data: Evaluation:  There are %6d coll strens  while %6d are currently allocated",
+                     n_coll_stren, n_coll_stren_max);
+  atomic_summary_add("get_atomic_data: Evaluation:  There are %6d phot x-secs  while %6d are currently allocated",
+                     nphot_total, nphot_max);
   atomic_summary_add("get_atomic_data: Evaluation:  There are %6d macro levels while %6d are currently allowed",
                      nlevels_macro, NLEVELS_MACRO);
 
@@ -3727,10 +4746,10 @@ or zero so that simple checks of true and false can be used for them */
       bf_max = config[i].n_bfd_jump;
   }
 
-  atomic_summary_add("get_atomic_data: Evaluation:  The maximum value bb jumps is %d while %d are currently allowed",
-                     bb_max, NBBJUMPS);
-  atomic_summary_add("get_atomic_data: Evaluation:  The maximum value bf jumps is %d while %d are currently allowed",
-                     bb_max, NBBJUMPS);
+  atomic_summary_add("get_atomic_data: Evaluation:  The maximum value bb jumps is %d, with %d in total", bb_max,
+                     nmacro_jumps[JUMP_BB_UP] + nmacro_jumps[JUMP_BB_DOWN]);
+  atomic_summary_add("get_atomic_data: Evaluation:  The maximum value bf jumps is %d, with %d in total", bf_max,
+                     nmacro_jumps[JUMP_BF_UP] + nmacro_jumps[JUMP_BF_DOWN]);
 
 /* Now, write the data to a file so you can check it later if you wish */
 /* this is controlled by one of the -d flag modes, defined in atomic.h */
@@ -3790,7 +4809,7 @@ or zero so that simple checks of true and false can be used for them */
     /* Write the ground fraction data to the file */
     fprintf(fptr, "Ground frac data (just first and last fracs here as a check):\n");
 
-    for(n = 0; n < NIONS; n++)
+    for(n = 0; n < nions; n++)
     {
       fprintf(fptr, "%3d %3d %6.3f %6.3f\n", ground_frac[n].z, ground_frac[n].istate, ground_frac[n].frac[0],
               ground_frac[n].frac[19]);
@@ -3801,26 +4820,46 @@ or zero so that simple checks of true and false can be used for them */
 
 
 
+  /* All of the cross sections have been read in, so the pools of cross section points can be trimmed to size */
+
+  if(resize_xsection_points(nxsection_points))
+  {
+    logfile("There is a problem in allocating memory for the cross section points\n");
+    return ATOMIC_MEMORY_ISSUE_ERROR;
+  }
+  logfile("Allocated %10d bytes for each of %6d cross section points totaling %10.1f Mb \n",
+          (int) (2 * sizeof(double)), nxsection_points, 1.e-6 * nxsection_points * 2 * sizeof(double));
+
   /* Finally create frequency ordered pointers to the various portions
    * of the atomic data
    */
 
-  /* Index the lines */
-  index_lines();
-
-/* Index the topbase photoionization structure by threshold freqeuncy */
-  if(ntop_phot + nxphot > 0)
-    index_phot_top();
-/* Index the topbase photoionization structure by threshold freqeuncy */
-  if(n_inner_tot > 0)
-    index_inner_cross();
+  /* Index the lines, and the topbase and inner shell photoionization structures by threshold frequency */
+  if(index_frequency_order() || build_line_columns() || build_posting_lists() || build_species_stats() ||
+     build_strongest_index() || build_coverage_index() || build_lower_level_index() || build_level_links())
+  {
+    logfile("There is a problem in allocating memory to sort the atomic data into frequency order\n");
+    return ATOMIC_MEMORY_ISSUE_ERROR;
+  }
 
 
   check_xsections();            // add_error_to_log routine, only prints if verbosity > 4
 
+  save_atomic_snapshot(atomic_data_file_path, use_relative, first_summary);
+
   free(sub_atomic_data_file_path);
   free(atomic_data_file_path);
 
+  /* The snapshot keeps the cross sections in full, so they are only stored compactly once it has been saved */
+
+  if(compact_xsections(AtomixConfiguration.xsection_error))
+  {
+    logfile("There is a problem in allocating memory to store the cross sections compactly\n");
+    return ATOMIC_MEMORY_ISSUE_ERROR;
+  }
+
+  mark_static_tables();
+  memory_summary();
   AtomixConfiguration.atomic_data_loaded = TRUE;
 
   return (0);
@@ -36,6 +36,7 @@ typedef struct Config_t
   int rows, cols;
   int current_line, current_col;
   int atomic_data_loaded;
+  double xsection_error;        /* The relative error allowed when storing x-sections compactly, or 0 for none */
   char atomic_data[LINELEN];
   char status_message[LINELEN];
   Screens current_screen;
@@ -167,6 +168,177 @@ typedef struct Display_t
 Display_t ATOMIC_BUFFER;
 Display_t DISPLAY_BUFFER;
 
+/* ****************************************************************************
+ * Atomic data records
+ * ************************************************************************** */
+
+#define RECORD_MAX_FIELDS 45
+#define RECORD_CHARS_LEN 15
+#define RECORD_STRING_LEN 19
+
+/*
+ * The schema of each kind of record, as the list of fields in a line. Each
+ * field is one of: skip, a word which is not stored; integer; integer2, an
+ * integer of at most two characters; real; string, a word of at most
+ * RECORD_STRING_LEN characters; or chars, RECORD_CHARS_LEN characters. As
+ * with %19s and %15c, a string is stored with a terminator and chars are not.
+ * Whitespace before each field is skipped. A parser for each kind of record is
+ * generated from these in records.c, so a new kind of record only needs a
+ * schema and an entry in RECORD_SCHEMAS.
+ */
+
+#define RECORD_ELEMENT_SCHEMA(F) F(skip) F(integer) F(string) F(real)
+#define RECORD_ION_SCHEMA(F) F(skip) F(skip) F(integer) F(integer) F(real) F(real) F(integer) F(integer)
+#define RECORD_LEVTOP_SCHEMA(F) F(skip) F(integer) F(integer) F(integer) F(integer) F(real) F(real) F(real) \
+  F(real) F(real) F(chars)
+#define RECORD_LEVMACRO_SCHEMA(F) F(skip) F(integer) F(integer) F(integer) F(real) F(real) F(real) F(real) \
+  F(chars)
+#define RECORD_LEVEL_KURUCZ_SCHEMA(F) F(skip) F(integer) F(integer) F(integer) F(real) F(real)
+#define RECORD_LEVEL_OLD_SCHEMA(F) F(skip) F(integer) F(real) F(real)
+#define RECORD_PHOT_SCHEMA(F) F(skip) F(integer) F(integer) F(integer) F(integer) F(real) F(integer)
+#define RECORD_INNER_SCHEMA(F) F(skip) F(integer) F(integer) F(integer) F(integer) F(real) F(integer)
+#define RECORD_POINT_SCHEMA(F) F(skip) F(real) F(real)
+#define RECORD_LINMACRO_SCHEMA(F) F(skip) F(integer) F(integer) F(real) F(real) F(real) F(real) F(real) F(real) \
+  F(integer) F(integer)
+#define RECORD_LINE_SCHEMA(F) F(skip) F(integer) F(integer2) F(real) F(real) F(real) F(real) F(real) F(real) \
+  F(integer) F(integer)
+#define RECORD_FRAC_SCHEMA(F) F(skip) F(integer) F(integer) RECORD_REALS_10(F) RECORD_REALS_10(F)
+#define RECORD_DR_BADNL_SCHEMA(F) F(skip) F(string) F(integer) F(integer) RECORD_REALS_5(F) F(real) F(real) \
+  F(real) F(real)
+#define RECORD_DR_SHULL_SCHEMA(F) F(skip) F(integer) F(integer) F(real) F(real) F(real) F(real)
+#define RECORD_RR_BADNL_SCHEMA(F) F(skip) F(integer) F(integer) F(integer) RECORD_REALS_5(F) F(real)
+#define RECORD_RR_SHULL_SCHEMA(F) F(skip) F(integer) F(integer) F(real) F(real)
+#define RECORD_BAD_GS_RR_SCHEMA(F) F(skip) F(string) F(integer) F(integer) RECORD_REALS_10(F) RECORD_REALS_5(F) \
+  F(real) F(real) F(real) F(real)
+#define RECORD_FF_GAUNT_SCHEMA(F) F(skip) RECORD_REALS_5(F)
+#define RECORD_DI_DERE_SCHEMA(F) F(skip) F(integer) F(integer) F(integer) RECORD_REALS_10(F) RECORD_REALS_10(F) \
+  RECORD_REALS_10(F) RECORD_REALS_10(F) F(real) F(real)
+#define RECORD_KELECYIELD_SCHEMA(F) F(skip) F(integer) F(integer) F(integer) F(integer) RECORD_REALS_10(F) \
+  F(real) F(real)
+#define RECORD_CSTREN_SCHEMA(F) F(skip) F(skip) F(integer) F(integer2) RECORD_REALS_5(F) F(real) F(integer) \
+  F(integer) F(integer) F(integer) F(real) F(real) F(real) F(integer) F(integer) F(real)
+#define RECORD_CSTREN_SPLINE_SCHEMA(F) F(skip) RECORD_REALS_10(F) RECORD_REALS_10(F)
+
+#define RECORD_REALS_5(F) F(real) F(real) F(real) F(real) F(real)
+#define RECORD_REALS_10(F) RECORD_REALS_5(F) RECORD_REALS_5(F)
+
+#define RECORD_SCHEMAS(X) \
+  X(RECORD_ELEMENT) \
+  X(RECORD_ION) \
+  X(RECORD_LEVTOP) \
+  X(RECORD_LEVMACRO) \
+  X(RECORD_LEVEL_KURUCZ) \
+  X(RECORD_LEVEL_OLD) \
+  X(RECORD_PHOT) \
+  X(RECORD_INNER) \
+  X(RECORD_POINT) \
+  X(RECORD_LINMACRO) \
+  X(RECORD_LINE) \
+  X(RECORD_FRAC) \
+  X(RECORD_DR_BADNL) \
+  X(RECORD_DR_SHULL) \
+  X(RECORD_RR_BADNL) \
+  X(RECORD_RR_SHULL) \
+  X(RECORD_BAD_GS_RR) \
+  X(RECORD_FF_GAUNT) \
+  X(RECORD_DI_DERE) \
+  X(RECORD_KELECYIELD) \
+  X(RECORD_CSTREN) \
+  X(RECORD_CSTREN_SPLINE)
+
+#define RECORD_KIND_ENUM(kind) kind,
+
+typedef enum RecordKinds
+{
+  RECORD_NONE = -1,
+  RECORD_SCHEMAS(RECORD_KIND_ENUM)
+  RECORD_NKINDS
+} RecordKinds;
+
+/*
+ * The keyword at the start of each kind of line, and the choice of record in
+ * get_atomic_data() which handles it. Keywords are matched on the whole of the
+ * first word of a line, so the order of this list does not matter. Any other
+ * word is an unknown record, apart from blank lines and words starting with
+ * # or !, which are comments, and words starting with *, which continue the
+ * previous record.
+ */
+
+#define RECORD_KEYWORDS(X) \
+  X(KEYWORD_ELEMENT, "Element", 'e') \
+  X(KEYWORD_ION, "Ion", 'i') \
+  X(KEYWORD_IONV, "IonV", 'i') \
+  X(KEYWORD_IONM, "IonM", 'i') \
+  X(KEYWORD_LEVTOP, "LevTop", 'N') \
+  X(KEYWORD_LEVMACRO, "LevMacro", 'N') \
+  X(KEYWORD_LEVEL, "Level", 'n') \
+  X(KEYWORD_PHOTMACS, "PhotMacS", 'w') \
+  X(KEYWORD_PHOTMAC, "PhotMac", 'w') \
+  X(KEYWORD_PHOTTOPS, "PhotTopS", 'w') \
+  X(KEYWORD_PHOTTOP, "PhotTop", 'w') \
+  X(KEYWORD_PHOTVFKYS, "PhotVfkyS", 'w') \
+  X(KEYWORD_PHOTVFKY, "PhotVfky", 'w') \
+  X(KEYWORD_LINE, "Line", 'r') \
+  X(KEYWORD_LINMACRO, "LinMacro", 'r') \
+  X(KEYWORD_FRAC, "Frac", 'f') \
+  X(KEYWORD_INNERVYS, "InnerVYS", 'I') \
+  X(KEYWORD_DR_BADNL, "DR_BADNL", 'D') \
+  X(KEYWORD_DR_SHULL, "DR_SHULL", 'S') \
+  X(KEYWORD_RR_BADNL, "RR_BADNL", 'T') \
+  X(KEYWORD_RR_SHULL, "RR_SHULL", 's') \
+  X(KEYWORD_BAD_GS_RR, "BAD_GS_RR", 'G') \
+  X(KEYWORD_DI_DERE, "DI_DERE", 'd') \
+  X(KEYWORD_FF_GAUNT, "FF_GAUNT", 'g') \
+  X(KEYWORD_KELECYIELD, "Kelecyield", 'K') \
+  X(KEYWORD_CSTREN, "CSTREN", 'C')
+
+#define RECORD_KEYWORD_ENUM(keyword, name, choice) keyword,
+
+typedef enum RecordKeywords
+{
+  KEYWORD_NONE = -1,
+  RECORD_KEYWORDS(RECORD_KEYWORD_ENUM)
+  RECORD_NKEYWORDS
+} RecordKeywords;
+
+typedef struct FieldText_t
+{
+  const char *start;
+  int len;
+} FieldText_t;
+
+typedef union Field_t
+{
+  int i;
+  double d;
+  FieldText_t text;
+} Field_t;
+
+typedef struct Record_t
+{
+  const char *line;
+  int len;
+  char choice;
+  int keyword;
+  int kind;
+  int nfields;
+  Field_t *fields;
+} Record_t;
+
+typedef struct Batch_t
+{
+  char file[LINELEN * 4];
+  char path[LINELEN * 4];
+  int error;
+  int nrecords, next;
+  int nlong;
+  Record_t *records;
+  Field_t *fields;
+  const char *map;
+  size_t map_size;
+  char *tail;
+} Batch_t;
+
 /* ****************************************************************************
  * Misc
  * ************************************************************************** */
@@ -0,0 +1,427 @@
+/* ************************************************************************** */
+/**
+ * @file     columns.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Functions for the columnar copy of the frequency ordered line list.
+ *
+ * @details
+ *
+ * Searching the line list through lin_ptr means loading a whole line structure
+ * for every line just to compare its z and istate. Instead, the quantities
+ * which the queries need are copied into line_columns in frequency order,
+ * with each column contiguous and aligned to a cache line, so a search only
+ * touches the columns it compares and the comparisons can be vectorised.
+ *
+ * The frequency column also has a directory of buckets, which finds where a
+ * frequency falls in the line list in constant expected time. As frequencies
+ * are positive, the bit pattern of a double increases with its value and is
+ * roughly linear in its logarithm, so the bucket of a frequency is the high
+ * bits of its offset from the lowest line frequency. Each bucket records the
+ * first line in it, so a search only has to look through one bucket.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+
+#include "atomix.h"
+
+#define COLUMN_ALIGN 64         /* The alignment of each column in bytes */
+#define SELECT_BLOCK 256        /* The number of lines compared in one go */
+#define BUCKET_SCAN_MAX 8       /* Buckets with more lines than this are binary searched */
+
+static int *bucket_start = NULL;  /* The first line in each bucket, with an extra entry for the end */
+static int nbuckets = 0;
+static int bucket_shift = 0;
+static uint64_t bucket_base = 0;
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the line columns.
+ *
+ * ************************************************************************** */
+
+void
+free_line_columns(void)
+{
+  free(line_columns.block);
+  memset(&line_columns, 0, sizeof(line_columns));
+
+  free(bucket_start);
+  bucket_start = NULL;
+  nbuckets = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the bit pattern of a frequency.
+ *
+ * ************************************************************************** */
+
+static inline uint64_t
+frequency_bits(double freq)
+{
+  uint64_t bits;
+
+  memcpy(&bits, &freq, sizeof(bits));
+
+  return bits;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the directory of frequency buckets for the line columns.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * The offsets of the frequencies from the lowest line frequency are shifted
+ * down until there are no more buckets than lines. If a frequency is not
+ * positive, the bit patterns are not ordered, so no directory is built and
+ * the whole line list is binary searched instead. The same is done if the
+ * frequencies are out of order, as the keys would then run past the last
+ * bucket. That can only happen if the lines were restored from a damaged
+ * snapshot.
+ *
+ * ************************************************************************** */
+
+static int
+build_frequency_directory(void)
+{
+  int i, b, n;
+  uint64_t span, key;
+  const double *freq = line_columns.freq;
+
+  n = line_columns.nlines;
+  if(n == 0 || !(freq[0] > 0) || !(freq[n - 1] <= DBL_MAX))
+    return EXIT_SUCCESS;
+
+  for(i = 1; i < n; ++i)
+    if(!(freq[i] >= freq[i - 1]))
+      return EXIT_SUCCESS;
+
+  bucket_base = frequency_bits(freq[0]);
+  span = frequency_bits(freq[n - 1]) - bucket_base;
+  for(bucket_shift = 0; (span >> bucket_shift) >= (uint64_t) n; ++bucket_shift);
+
+  nbuckets = (int) (span >> bucket_shift) + 1;
+  if((bucket_start = malloc((nbuckets + 1) * sizeof(int))) == NULL)
+  {
+    nbuckets = 0;
+    return EXIT_FAILURE;
+  }
+
+  for(i = 0, b = 0; i < n; ++i)
+  {
+    key = (frequency_bits(freq[i]) - bucket_base) >> bucket_shift;
+    while((uint64_t) b <= key)
+      bucket_start[b++] = i;
+  }
+
+  while(b <= nbuckets)
+    bucket_start[b++] = n;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Hand out the next aligned column from the block of columns.
+ *
+ * @param[in,out]  next  The next free byte in the block
+ * @param[in]      size  The size of the column in bytes
+ *
+ * @return  The start of the column
+ *
+ * ************************************************************************** */
+
+static void *
+next_column(char **next, size_t size)
+{
+  void *column = *next;
+
+  *next += (size + COLUMN_ALIGN - 1) / COLUMN_ALIGN * COLUMN_ALIGN;
+
+  return column;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the size of the block of columns for a number of lines, once
+ *         the lines have been padded to a whole number of SELECT_BLOCKs.
+ *
+ * ************************************************************************** */
+
+static size_t
+column_block_size(int n)
+{
+  size_t npadded = (n + SELECT_BLOCK - 1) / SELECT_BLOCK * SELECT_BLOCK;
+
+  return 5 * npadded * sizeof(double) + 6 * npadded * sizeof(int);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the line columns from the frequency ordered line list.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * All of the columns are put into one allocation, with each column starting
+ * on a COLUMN_ALIGN byte boundary. The columns are padded with zeros to a
+ * whole number of SELECT_BLOCKs, so select_lines() only ever compares whole
+ * blocks, and as z is 0 the padding never matches. This has to be called
+ * again whenever lin_ptr changes.
+ *
+ * ************************************************************************** */
+
+int
+build_line_columns(void)
+{
+  int i, n, npadded;
+  size_t size;
+  char *next;
+  LinePtr p;
+
+  free_line_columns();
+
+  n = nlines;
+  npadded = (n + SELECT_BLOCK - 1) / SELECT_BLOCK * SELECT_BLOCK;
+  size = column_block_size(n);
+
+  if(posix_memalign(&line_columns.block, COLUMN_ALIGN, size) != 0)
+  {
+    line_columns.block = NULL;
+    return EXIT_FAILURE;
+  }
+  memset(line_columns.block, 0, size);
+
+  next = line_columns.block;
+  line_columns.freq = next_column(&next, npadded * sizeof(double));
+  line_columns.wavelength = next_column(&next, npadded * sizeof(double));
+  line_columns.f = next_column(&next, npadded * sizeof(double));
+  line_columns.gl = next_column(&next, npadded * sizeof(double));
+  line_columns.gu = next_column(&next, npadded * sizeof(double));
+  line_columns.z = next_column(&next, npadded * sizeof(int));
+  line_columns.istate = next_column(&next, npadded * sizeof(int));
+  line_columns.nion = next_column(&next, npadded * sizeof(int));
+  line_columns.levl = next_column(&next, npadded * sizeof(int));
+  line_columns.levu = next_column(&next, npadded * sizeof(int));
+  line_columns.macro_info = next_column(&next, npadded * sizeof(int));
+
+  for(i = 0; i < n; ++i)
+  {
+    p = lin_ptr[i];
+    line_columns.freq[i] = p->freq;
+    line_columns.wavelength[i] = C_SI / p->freq / ANGSTROM / 1e-2;
+    line_columns.f[i] = p->f;
+    line_columns.gl[i] = p->gl;
+    line_columns.gu[i] = p->gu;
+    line_columns.z[i] = p->z;
+    line_columns.istate[i] = p->istate;
+    line_columns.nion[i] = p->nion;
+    line_columns.levl[i] = p->levl;
+    line_columns.levu[i] = p->levu;
+    line_columns.macro_info[i] = p->macro_info;
+  }
+
+  line_columns.nlines = n;
+
+  return build_frequency_directory();
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the lines of an element or ion.
+ *
+ * @param[in]   z         The atomic number of the element
+ * @param[in]   istate    The ionisation state of the ion, or a value less than
+ *                        1 for all of the lines of the element
+ * @param[out]  selected  The index in frequency order of each line found,
+ *                        which must have room for nlines + 1 entries
+ *
+ * @return  The number of lines found
+ *
+ * @details
+ *
+ * The lines are compared a block at a time. The first loop over a block only
+ * compares the z and istate columns, so it is vectorised by the compiler. If
+ * anything in the block matched, the second loop packs the matches into
+ * selected without branching.
+ *
+ * ************************************************************************** */
+
+int
+select_lines(int z, int istate, int *selected)
+{
+  int i, start, nselected;
+  int any_istate = istate < 1;
+  int any_match;
+  const int *restrict zc = line_columns.z;
+  const int *restrict ic = line_columns.istate;
+  int match[SELECT_BLOCK];
+
+  nselected = 0;
+
+  for(start = 0; start < line_columns.nlines; start += SELECT_BLOCK)
+  {
+    any_match = 0;
+    for(i = 0; i < SELECT_BLOCK; ++i)
+    {
+      match[i] = (zc[start + i] == z) & ((ic[start + i] == istate) | any_istate);
+      any_match |= match[i];
+    }
+
+    if(!any_match)
+      continue;
+
+    for(i = 0; i < SELECT_BLOCK; ++i)
+    {
+      selected[nselected] = start + i;
+      nselected += match[i];
+    }
+  }
+
+  return nselected;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the first line in part of the line list whose frequency is
+ *         above a frequency.
+ *
+ * @param[in]  freq       The frequency
+ * @param[in]  inclusive  If TRUE, a line at the frequency counts as above it
+ * @param[in]  lo         The first line to search
+ * @param[in]  hi         One past the last line to search
+ *
+ * @return  The first line above the frequency, or hi if there is none
+ *
+ * ************************************************************************** */
+
+static int
+search_frequency(double freq, int inclusive, int lo, int hi)
+{
+  int mid;
+  const double *f = line_columns.freq;
+
+  if(hi - lo <= BUCKET_SCAN_MAX)
+  {
+    if(inclusive)
+      while(lo < hi && f[lo] < freq)
+        lo++;
+    else
+      while(lo < hi && f[lo] <= freq)
+        lo++;
+
+    return lo;
+  }
+
+  while(lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if(f[mid] < freq || (!inclusive && f[mid] == freq))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the first line whose frequency is above a frequency, using the
+ *         frequency directory.
+ *
+ * @param[in]  freq       The frequency
+ * @param[in]  inclusive  If TRUE, a line at the frequency counts as above it
+ *
+ * @return  The first line above the frequency, or nlines if there is none
+ *
+ * ************************************************************************** */
+
+static int
+find_frequency(double freq, int inclusive)
+{
+  int n = line_columns.nlines;
+  uint64_t key;
+  const double *f = line_columns.freq;
+
+  if(n == 0)
+    return 0;
+
+  if(nbuckets == 0)
+    return search_frequency(freq, inclusive, 0, n);
+
+  if(freq < f[0] || (inclusive && freq == f[0]))
+    return 0;
+  if(freq > f[n - 1] || (!inclusive && freq == f[n - 1]))
+    return n;
+  if(!(freq == freq))
+    return search_frequency(freq, inclusive, 0, n);
+
+  key = (frequency_bits(freq) - bucket_base) >> bucket_shift;
+
+  return search_frequency(freq, inclusive, bucket_start[key], bucket_start[key + 1]);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the lines within a frequency range.
+ *
+ * @param[in]  freqmin  The lowest frequency of the range
+ * @param[in]  freqmax  The highest frequency of the range
+ *
+ * @return  The range of lines in frequency order with
+ *          freqmin <= freq <= freqmax
+ *
+ * @details
+ *
+ * Each end of the range is found with the frequency directory, so the time
+ * taken does not depend on the number of lines. Nothing is changed by a search,
+ * so it is safe to search from more than one thread at a time.
+ *
+ * ************************************************************************** */
+
+LineRange
+find_line_range(double freqmin, double freqmax)
+{
+  LineRange range;
+
+  range.first = find_frequency(freqmin, TRUE);
+  range.end = find_frequency(freqmax, FALSE);
+  if(range.end < range.first)
+    range.end = range.first;
+
+  return range;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the line columns and their frequency
+ *         directory to a memory table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * ************************************************************************** */
+
+void
+line_columns_memory(MemoryTable *table)
+{
+  if(line_columns.block == NULL)
+    return;
+
+  account_memory(table, line_columns.block, column_block_size(line_columns.nlines),
+                 line_columns.nlines * (5 * sizeof(double) + 6 * sizeof(int)));
+  if(bucket_start != NULL)
+    account_memory(table, bucket_start, (nbuckets + 1) * sizeof(int), (nbuckets + 1) * sizeof(int));
+}
@@ -0,0 +1,402 @@
+/* ************************************************************************** */
+/**
+ * @file     compact.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Compact storage of the photoionization and inner shell cross sections.
+ *
+ * @details
+ *
+ * The cross sections are smooth in log-log space, so each point after the
+ * first can be stored as the difference between the logarithm of its
+ * frequency and cross section and those of the point before, quantised to a
+ * step which keeps every point within a relative error of the original. The
+ * first point of each cross section is kept exactly in the x-section pools,
+ * so the thresholds are unchanged, and the differences are stored as shorts.
+ * Each point then takes 4 bytes rather than 16.
+ *
+ * The logarithms are quantised, rather than the differences, so the errors do
+ * not build up along a cross section. A cross section is only stored compactly
+ * if every point is found to be within the error when it is decoded, otherwise
+ * it is left in full. Cross sections with a point which is not positive, or
+ * with a jump between points too large for a short, are also left in full.
+ *
+ * The points of a compact cross section are read with xsection_point(),
+ * xsection_points() or xsection_sigma(). Only the first point can be read
+ * through freq and x.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#include "atomix.h"
+
+static short *xsection_packed = NULL; /* The differences of the compact x-sections, in pairs of frequency and x */
+static int nxsection_packed = 0;
+static double packed_step = 0;  /* The quantisation step of the logarithms */
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the compact x-section points.
+ *
+ * @details
+ *
+ * The x-sections which pointed into them have to be freed, or reset, at the
+ * same time.
+ *
+ * ************************************************************************** */
+
+void
+free_packed_xsections(void)
+{
+  free(xsection_packed);
+  xsection_packed = NULL;
+  nxsection_packed = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get an x-section from phot_top or inner_cross, numbering phot_top
+ *         first.
+ *
+ * ************************************************************************** */
+
+static TopPhotPtr
+packed_xsection(int i)
+{
+  return i < nphot_total ? &phot_top[i] : &inner_cross[i - nphot_total];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Try to encode the points of an x-section.
+ *
+ * @param[in]   xsection   The x-section, which is stored in full
+ * @param[in]   max_error  The largest relative error allowed for any point
+ * @param[out]  packed     The differences of the points after the first
+ * @param[out]  error      The largest relative error of any point
+ *
+ * @return  TRUE if the x-section can be stored compactly, otherwise FALSE
+ *
+ * ************************************************************************** */
+
+static int
+pack_xsection(const Topbase_phot *xsection, double max_error, short *packed, double *error)
+{
+  int k, i;
+  long q[2], last[2];
+  double base[2], value[2], steps, decoded;
+
+  *error = 0;
+
+  if(xsection->np < 2 || xsection->np > NCROSS)
+    return FALSE;
+
+  base[0] = xsection->freq[0];
+  base[1] = xsection->x[0];
+  last[0] = last[1] = 0;
+
+  for(k = 1; k < xsection->np; ++k)
+  {
+    value[0] = xsection->freq[k];
+    value[1] = xsection->x[k];
+
+    for(i = 0; i < 2; ++i)
+    {
+      if(!(value[i] > 0) || !(base[i] > 0))
+        return FALSE;
+
+      steps = log(value[i] / base[i]) / packed_step;
+      if(!(fabs(steps) < (double) NCROSS * SHRT_MAX))
+        return FALSE;
+
+      q[i] = lround(steps);
+      if(q[i] - last[i] > SHRT_MAX || q[i] - last[i] < SHRT_MIN)
+        return FALSE;
+
+      decoded = base[i] * exp(q[i] * packed_step);
+      if(fabs(decoded - value[i]) > max_error * value[i])
+        return FALSE;
+      if(fabs(decoded - value[i]) > *error * value[i])
+        *error = fabs(decoded - value[i]) / value[i];
+
+      packed[2 * (k - 1) + i] = (short) (q[i] - last[i]);
+      last[i] = q[i];
+    }
+  }
+
+  return TRUE;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Store the photoionization and inner shell cross sections compactly.
+ *
+ * @param[in]  max_error  The largest relative error allowed for any point, or
+ *                        0 to keep every cross section in full
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * The x-section pools are rebuilt with only the points which are still needed,
+ * being the first point of each compact x-section and every point of the
+ * others. Points left unused when an x-section was replaced are dropped too.
+ * The number of x-sections stored compactly and the memory saved are added to
+ * the atomic summary.
+ *
+ * This has to be called once all of the atomic data has been read in, and
+ * after the snapshot has been saved, as snapshots store the x-sections in
+ * full.
+ *
+ * ************************************************************************** */
+
+int
+compact_xsections(double max_error)
+{
+  int i, k, n, ntotal, npoints, ncompact;
+  double error, max_found, before, after;
+  double *freq, *x;
+  short scratch[2 * NCROSS];
+  TopPhotPtr xsection;
+
+  free_packed_xsections();
+
+  if(max_error <= 0)
+    return EXIT_SUCCESS;
+
+  ntotal = nphot_total + n_inner_tot;
+  packed_step = 2 * log1p(max_error) * (1 - 1e-6);
+
+  /*
+   * Find which x-sections can be stored compactly first, so the packed points
+   * and the new pools can be allocated at the size they need to be
+   */
+
+  for(i = 0; i < ntotal; ++i)
+    packed_xsection(i)->packed = NULL;
+
+  nxsection_packed = 0;
+  npoints = 1;
+  for(i = 0; i < ntotal; ++i)
+  {
+    xsection = packed_xsection(i);
+    if(pack_xsection(xsection, max_error, scratch, &error))
+    {
+      nxsection_packed += 2 * (xsection->np - 1);
+      npoints += 1;
+    }
+    else if(xsection->np > 0)
+    {
+      npoints += xsection->np;
+    }
+  }
+
+  xsection_packed = malloc((nxsection_packed + 1) * sizeof(short));
+  freq = malloc(npoints * sizeof(double));
+  x = malloc(npoints * sizeof(double));
+  if(xsection_packed == NULL || freq == NULL || x == NULL)
+  {
+    free(freq);
+    free(x);
+    free_packed_xsections();
+    return EXIT_FAILURE;
+  }
+
+  freq[0] = x[0] = -1;
+  npoints = 1;
+  nxsection_packed = 0;
+  ncompact = 0;
+  max_found = 0;
+
+  for(i = 0; i < ntotal; ++i)
+  {
+    xsection = packed_xsection(i);
+    n = xsection->np > 0 ? xsection->np : 0;
+
+    if(pack_xsection(xsection, max_error, scratch, &error))
+    {
+      xsection->packed = &xsection_packed[nxsection_packed];
+      memcpy(xsection->packed, scratch, 2 * (xsection->np - 1) * sizeof(short));
+      nxsection_packed += 2 * (xsection->np - 1);
+      n = 1;
+      ncompact++;
+      if(error > max_found)
+        max_found = error;
+    }
+
+    for(k = 0; k < n; ++k)
+    {
+      freq[npoints + k] = xsection->freq[k];
+      x[npoints + k] = xsection->x[k];
+    }
+    xsection->offset = n > 0 ? npoints : 0;
+    npoints += n;
+  }
+
+  /*
+   * The new pools replace the old ones, so every x-section has to be pointed
+   * at its points again
+   */
+
+  before = 1e-6 * nxsection_points * 2 * sizeof(double);
+
+  free(xsection_freq);
+  free(xsection_x);
+  xsection_freq = freq;
+  xsection_x = x;
+  nxsection_points = nxsection_points_max = npoints;
+  update_xsection_pointers();
+
+  after = 1e-6 * (nxsection_points * 2 * sizeof(double) + nxsection_packed * sizeof(short));
+
+  atomic_summary_add("Stored %d of %d cross sections compactly, with a largest relative error of %.2e",
+                     ncompact, ntotal, max_found);
+  atomic_summary_add("Cross section points use %.2f Mb rather than %.2f Mb, saving %.2f Mb", after, before,
+                     before - after);
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the points of an x-section.
+ *
+ * @param[in]   xsection  The x-section
+ * @param[out]  freq      The frequency of each point, which needs room for np
+ *                        points
+ * @param[out]  x         The cross section of each point, which needs room for
+ *                        np points
+ *
+ * @return  The number of points
+ *
+ * ************************************************************************** */
+
+int
+xsection_points(const Topbase_phot *xsection, double *freq, double *x)
+{
+  int k;
+  long qf, qx;
+
+  if(xsection->np < 1)
+    return 0;
+
+  if(xsection->packed == NULL)
+  {
+    memcpy(freq, xsection->freq, xsection->np * sizeof(double));
+    memcpy(x, xsection->x, xsection->np * sizeof(double));
+    return xsection->np;
+  }
+
+  freq[0] = xsection->freq[0];
+  x[0] = xsection->x[0];
+  qf = qx = 0;
+  for(k = 1; k < xsection->np; ++k)
+  {
+    qf += xsection->packed[2 * (k - 1)];
+    qx += xsection->packed[2 * (k - 1) + 1];
+    freq[k] = freq[0] * exp(qf * packed_step);
+    x[k] = x[0] * exp(qx * packed_step);
+  }
+
+  return xsection->np;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get one point of an x-section.
+ *
+ * @param[in]   xsection  The x-section
+ * @param[in]   k         The point, which has to be less than np
+ * @param[out]  freq      The frequency of the point
+ * @param[out]  x         The cross section of the point
+ *
+ * @details
+ *
+ * The points of a compact x-section are decoded from the first, so getting
+ * every point should be done with xsection_points() instead.
+ *
+ * ************************************************************************** */
+
+void
+xsection_point(const Topbase_phot *xsection, int k, double *freq, double *x)
+{
+  int j;
+  long qf, qx;
+
+  if(xsection->packed == NULL)
+  {
+    *freq = xsection->freq[k];
+    *x = xsection->x[k];
+    return;
+  }
+
+  qf = qx = 0;
+  for(j = 1; j <= k; ++j)
+  {
+    qf += xsection->packed[2 * (j - 1)];
+    qx += xsection->packed[2 * (j - 1) + 1];
+  }
+
+  *freq = xsection->freq[0] * exp(qf * packed_step);
+  *x = xsection->x[0] * exp(qx * packed_step);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the value of an x-section at a frequency.
+ *
+ * @param[in]  xsection  The x-section
+ * @param[in]  freq      The frequency
+ *
+ * @return  The cross section, linearly interpolated between the points
+ *
+ * ************************************************************************** */
+
+double
+xsection_sigma(const Topbase_phot *xsection, double freq)
+{
+  int np;
+  double sigma;
+  double xfreq[NCROSS], x[NCROSS];
+
+  if(xsection->np < 1)
+    return 0;
+
+  if(xsection->packed == NULL)
+  {
+    sigma = xsection->x[0];
+    if(xsection->np > 1)
+      linterp(freq, xsection->freq, xsection->x, xsection->np, &sigma, 0);
+    return sigma;
+  }
+
+  np = xsection_points(xsection, xfreq, x);
+  linterp(freq, xfreq, x, np, &sigma, 0);
+
+  return sigma;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the compact x-section points to a memory
+ *         table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * ************************************************************************** */
+
+void
+packed_xsections_memory(MemoryTable *table)
+{
+  if(xsection_packed == NULL)
+    return;
+
+  account_memory(table, xsection_packed, (nxsection_packed + 1) * sizeof(short), nxsection_packed * sizeof(short));
+}
@@ -0,0 +1,351 @@
+/* ************************************************************************** */
+/**
+ * @file     coverage.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * An index of the frequency range covered by each photoionization and inner
+ * shell cross section.
+ *
+ * @details
+ *
+ * A cross section is active, and contributes to the continuum opacity, between
+ * the first and last frequencies of its table, so finding what is active at a
+ * frequency means finding every interval [freq[0], freq[np - 1]] which contains
+ * it. The thresholds freq[0] are already in order in phot_top_ptr and
+ * inner_cross_ptr, so the cross sections which start at or below a frequency
+ * are a prefix of the list found by a binary search. Over the list, a tree
+ * holds the highest last frequency of every power of two sized run of cross
+ * sections, so the cross sections in the prefix which are still active can be
+ * found by only going into the parts of the tree which have at least one in
+ * them. The time taken therefore depends on how many cross sections are active
+ * rather than how many there are.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+
+#include "atomix.h"
+
+typedef struct CoverageIndex_t
+{
+  int n;                        /* The number of cross sections */
+  int nleaves;                  /* The number of leaves in the tree, a power of two no less than n */
+  double *first;                /* The first frequency of each cross section */
+  double *last;                 /* The last frequency of each cross section */
+  double *tree;                 /* The highest last frequency in each node of the tree, with the root at 1 */
+} CoverageIndex_t;
+
+static CoverageIndex_t coverage_index[NXSECTION_LISTS];
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the cross section coverage index.
+ *
+ * ************************************************************************** */
+
+void
+free_coverage_index(void)
+{
+  int list;
+
+  for(list = 0; list < NXSECTION_LISTS; ++list)
+  {
+    free(coverage_index[list].first);
+    free(coverage_index[list].last);
+    free(coverage_index[list].tree);
+    coverage_index[list].first = NULL;
+    coverage_index[list].last = NULL;
+    coverage_index[list].tree = NULL;
+    coverage_index[list].n = 0;
+    coverage_index[list].nleaves = 0;
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get a cross section from one of the frequency ordered lists.
+ *
+ * @param[in]  list  The list of cross sections
+ * @param[in]  i     The position of the cross section in the list
+ *
+ * @return  The cross section
+ *
+ * ************************************************************************** */
+
+TopPhotPtr
+coverage_xsection(int list, int i)
+{
+  return list == XSECTION_INNER ? inner_cross_ptr[i] : phot_top_ptr[i];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the coverage index for the photoionization and inner shell
+ *         cross sections.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * This has to be called once the cross sections have been put into frequency
+ * order, as the binary search relies on the thresholds being sorted. A cross
+ * section without any points is given an empty range, so is never active.
+ *
+ * ************************************************************************** */
+
+int
+build_coverage_index(void)
+{
+  int i, list, node;
+  double sigma;
+  TopPhotPtr x;
+  CoverageIndex_t *c;
+
+  free_coverage_index();
+
+  for(list = 0; list < NXSECTION_LISTS; ++list)
+  {
+    c = &coverage_index[list];
+    c->n = list == XSECTION_INNER ? n_inner_tot : nphot_total;
+    for(c->nleaves = 1; c->nleaves < c->n; c->nleaves *= 2);
+
+    c->first = malloc((c->n + 1) * sizeof(double));
+    c->last = malloc((c->n + 1) * sizeof(double));
+    c->tree = malloc(2 * c->nleaves * sizeof(double));
+    if(c->first == NULL || c->last == NULL || c->tree == NULL)
+    {
+      free_coverage_index();
+      return EXIT_FAILURE;
+    }
+
+    for(i = 0; i < c->n; ++i)
+    {
+      x = coverage_xsection(list, i);
+      c->first[i] = x->freq[0];
+      c->last[i] = -1;
+      if(x->np > 0)
+        xsection_point(x, x->np - 1, &c->last[i], &sigma);
+    }
+
+    for(i = 0; i < c->nleaves; ++i)
+      c->tree[c->nleaves + i] = i < c->n ? c->last[i] : -1;
+
+    for(node = c->nleaves - 1; node > 0; --node)
+      c->tree[node] = c->tree[2 * node] > c->tree[2 * node + 1] ? c->tree[2 * node] : c->tree[2 * node + 1];
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the cross sections in a part of the tree which start before a
+ *         position and end at or above a frequency.
+ *
+ * @param[in]   c       The coverage index
+ * @param[in]   node    The node of the tree to search
+ * @param[in]   lo      The first position under the node
+ * @param[in]   hi      One past the last position under the node
+ * @param[in]   end     One past the last position to report
+ * @param[in]   freq    The lowest last frequency to report
+ * @param[out]  active  The positions found
+ * @param[in]   n       The number of positions already found
+ *
+ * @return  The number of positions found, including those already found
+ *
+ * ************************************************************************** */
+
+static int
+report_active(const CoverageIndex_t *c, int node, int lo, int hi, int end, double freq, int *active, int n)
+{
+  int mid;
+
+  if(lo >= end || c->tree[node] < freq)
+    return n;
+
+  if(hi - lo == 1)
+  {
+    active[n++] = lo;
+    return n;
+  }
+
+  mid = lo + (hi - lo) / 2;
+  n = report_active(c, 2 * node, lo, mid, end, freq, active, n);
+  n = report_active(c, 2 * node + 1, mid, hi, end, freq, active, n);
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the cross sections which are active anywhere in a frequency
+ *         range.
+ *
+ * @param[in]   list     The list of cross sections to search
+ * @param[in]   freqmin  The lowest frequency of the range
+ * @param[in]   freqmax  The highest frequency of the range
+ * @param[out]  active   The position in phot_top_ptr or inner_cross_ptr of
+ *                       each cross section found, in threshold order, which
+ *                       needs room for every cross section in the list
+ *
+ * @return  The number of cross sections found
+ *
+ * @details
+ *
+ * A cross section is found if [freq[0], freq[np - 1]] overlaps
+ * [freqmin, freqmax], including at either end. To find the cross sections
+ * active at one frequency, both ends of the range are set to it.
+ *
+ * ************************************************************************** */
+
+int
+find_active_xsections(int list, double freqmin, double freqmax, int *active)
+{
+  int lo, hi, mid;
+  const CoverageIndex_t *c;
+
+  if(list < 0 || list >= NXSECTION_LISTS || coverage_index[list].tree == NULL || freqmax < freqmin)
+    return 0;
+
+  c = &coverage_index[list];
+
+  /*
+   * Find how many cross sections start at or below the top of the range, as
+   * only these can overlap it
+   */
+
+  lo = 0;
+  hi = c->n;
+  while(lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if(c->first[mid] <= freqmax)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return report_active(c, 1, 0, c->nleaves, lo, freqmin, active, 0);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Show the cross sections active at a wavelength, or over a range of
+ *         wavelengths, in the content view.
+ *
+ * @param[in]  list           The list of cross sections to search
+ * @param[in]  at_wavelength  If TRUE a single wavelength is queried, and the
+ *                            value of each cross section there is shown,
+ *                            otherwise a range of wavelengths is queried
+ *
+ * @details
+ *
+ * The wavelengths each cross section covers are shown as Wmin and Wmax, with
+ * its threshold wavelength being Wmax.
+ *
+ * ************************************************************************** */
+
+void
+active_xsections(int list, int at_wavelength)
+{
+  int i, n;
+  int *active;
+  double wmin, wmax, xmin, xmax, sigma;
+  char element[LINELEN];
+  const char *name;
+  TopPhotPtr x;
+  const int ndash = 104;
+
+  if(at_wavelength)
+  {
+    if(query_wavelength(&wmin) == FORM_QUIT)
+      return;
+    wmax = wmin;
+  }
+  else if(query_wavelength_range(&wmin, &wmax) == FORM_QUIT)
+  {
+    return;
+  }
+
+  if((active = malloc((coverage_index[list].n + 1) * sizeof(int))) == NULL)
+  {
+    error_atomix("Unable to allocate memory to find the active cross sections");
+    return;
+  }
+
+  n = find_active_xsections(list, C / (wmax * ANGSTROM), C / (wmin * ANGSTROM), active);
+  name = list == XSECTION_INNER ? "Inner shell" : "Photoionization";
+
+  if(at_wavelength)
+  {
+    display_add(" %s cross sections active at %.2f Angstroms", name, wmin);
+    add_sep_display(ndash);
+    display_add(" %-12s %-12s %-12s %-12s %-12s %-12s %-12s %-12s", "Element", "Z", "istate", "n", "l", "Wmin", "Wmax",
+                "Sigma");
+  }
+  else
+  {
+    display_add(" %s cross sections active over %.2f - %.2f Angstroms", name, wmin, wmax);
+    add_sep_display(ndash);
+    display_add(" %-12s %-12s %-12s %-12s %-12s %-12s %-12s", "Element", "Z", "istate", "n", "l", "Wmin", "Wmax");
+  }
+  add_sep_display(ndash);
+
+  for(i = 0; i < n; ++i)
+  {
+    x = coverage_xsection(list, active[i]);
+    get_element_name(x->z, element);
+    xmin = C / (coverage_index[list].last[active[i]] * ANGSTROM);
+    xmax = C / (coverage_index[list].first[active[i]] * ANGSTROM);
+
+    if(at_wavelength)
+    {
+      sigma = xsection_sigma(x, C / (wmin * ANGSTROM));
+      display_add(" %-12s %-12i %-12i %-12i %-12i %-12.2f %-12.2f %-12.3e", element, x->z, x->istate, x->n, x->l, xmin,
+                  xmax, sigma);
+    }
+    else
+    {
+      display_add(" %-12s %-12i %-12i %-12i %-12i %-12.2f %-12.2f", element, x->z, x->istate, x->n, x->l, xmin, xmax);
+    }
+  }
+
+  free(active);
+
+  count(ndash, n);
+
+  display_show(SCROLL_ENABLE, true, 4);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the cross section coverage index to a memory
+ *         table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * @details
+ *
+ * Node 0 of each tree is never used, as the root is at 1.
+ *
+ * ************************************************************************** */
+
+void
+coverage_index_memory(MemoryTable *table)
+{
+  int list;
+  const CoverageIndex_t *c;
+
+  for(list = 0; list < NXSECTION_LISTS; ++list)
+  {
+    c = &coverage_index[list];
+    if(c->tree == NULL)
+      continue;
+    account_memory(table, c->first, (c->n + 1) * sizeof(double), c->n * sizeof(double));
+    account_memory(table, c->last, (c->n + 1) * sizeof(double), c->n * sizeof(double));
+    account_memory(table, c->tree, 2 * c->nleaves * sizeof(double), (2 * c->nleaves - 1) * sizeof(double));
+  }
+}
@@ -70,8 +70,10 @@ element_line(struct elements e)
 void
 single_element_info(struct elements e, int detailed)
 {
-  int i, n;
+  int i, j, n;
+  const int *entries;
   double wavelength;
+  const SpeciesStats *stats;
 
   display_add(" Element: %s", e.name);
   add_sep_display(ndash);
@@ -81,6 +83,15 @@ single_element_info(struct elements e, int detailed)
   display_add(" First Ion Index          : %i", e.firstion);
   display_add(" Last Ion Index           : %i", e.firstion + e.nions - 1);
   display_add(" Highest Ionisation state : %i", e.istate_max);
+  if((stats = get_element_stats(element_index(e.z))) != NULL)
+  {
+    display_add(" Lines (macro / simple)   : %i (%i / %i)", stats->nlines, stats->nmacro, stats->nsimple);
+    display_add(" Lines with coll strength : %i", stats->ncoll);
+    display_add(" Line wavelength range    : %.2f - %.2f A", stats->wmin, stats->wmax);
+    display_add(" Sum of gf                : %.3e", stats->gf_sum);
+    display_add(" Photoionization edges    : %i", stats->nphot);
+    display_add(" Inner shell edges        : %i", stats->ninner);
+  }
   add_sep_display(ndash);
 
   if(!detailed)
@@ -90,16 +101,12 @@ single_element_info(struct elements e, int detailed)
   add_sep_display(ndash);
   display_add(" %-12s %-12s %-12s %-12s", "Ionisation", "Wavelength", "levu", "levl");
 
-  n = 0;
-
-  for(i = 0; i < nlines; ++i)
+  n = find_postings(POSTING_LINES, e.z, 0, &entries);
+  for(i = 0; i < n; ++i)
   {
-    if(lin_ptr[i]->z == e.z)
-    {
-      n++;
-      wavelength = C_SI / lin_ptr[i]->freq / ANGSTROM / 1e-2;
-      display_add(" %-12i %-12.2f %-12i %-12i", lin_ptr[i]->istate, wavelength, lin_ptr[i]->levu, lin_ptr[i]->levl);
-    }
+    j = entries[i];
+    display_add(" %-12i %-12.2f %-12i %-12i", line_columns.istate[j], line_columns.wavelength[j], line_columns.levu[j],
+                line_columns.levl[j]);
   }
 
   add_sep_display(ndash);
@@ -110,17 +117,13 @@ single_element_info(struct elements e, int detailed)
   add_sep_display(ndash);
   display_add(" %-12s %-12s %-12s %-12s", "Ionisation", "Wavelength", "n", "l");
 
-  n = 0;
-
-  for(i = 0; i < nphot_total; ++i)
+  n = find_postings(POSTING_PHOT, e.z, 0, &entries);
+  for(i = 0; i < n; ++i)
   {
-    if(phot_top_ptr[i]->z == e.z)
-    {
-      n++;
-      wavelength = C_SI / phot_top_ptr[i]->freq[0] / ANGSTROM / 1e-2;
-      display_add(" %-12i %-12.2f %-12i %-12i", phot_top_ptr[i]->istate, wavelength, phot_top_ptr[i]->n,
-                  phot_top_ptr[i]->l);
-    }
+    j = entries[i];
+    wavelength = C_SI / phot_top_ptr[j]->freq[0] / ANGSTROM / 1e-2;
+    display_add(" %-12i %-12.2f %-12i %-12i", phot_top_ptr[j]->istate, wavelength, phot_top_ptr[j]->n,
+                phot_top_ptr[j]->l);
   }
 
   add_sep_display(ndash);
@@ -132,17 +135,13 @@ single_element_info(struct elements e, int detailed)
   add_sep_display(ndash);
   display_add(" %-12s %-12s %-12s %-12s", "Ionisation", "Wavelength", "n", "l");
 
-  n = 0;
-
-  for(i = 0; i < n_inner_tot; ++i)
+  n = find_postings(POSTING_INNER, e.z, 0, &entries);
+  for(i = 0; i < n; ++i)
   {
-    if(inner_cross_ptr[i]->z == e.z)
-    {
-      n++;
-      wavelength = C_SI / inner_cross_ptr[i]->freq[0] / ANGSTROM / 1e-2;
-      display_add(" %-12i %-12.2f %-12i %-12i", inner_cross_ptr[i]->istate, wavelength, inner_cross_ptr[i]->n,
-                  inner_cross_ptr[i]->l);
-    }
+    j = entries[i];
+    wavelength = C_SI / inner_cross_ptr[j]->freq[0] / ANGSTROM / 1e-2;
+    display_add(" %-12i %-12.2f %-12i %-12i", inner_cross_ptr[j]->istate, wavelength, inner_cross_ptr[j]->n,
+                inner_cross_ptr[j]->l);
   }
 
   add_sep_display(ndash);
@@ -193,21 +192,11 @@ single_element(void)
 {
   int i;
   int atomic_z;
-  int found = false;
 
   if(query_atomic_number(&atomic_z) == FORM_QUIT)
     return;
 
-  for(i = 0; i < nelements; ++i)
-  {
-    if(ele[i].z == atomic_z)
-    {
-      found = true;
-      break;
-    }
-  }
-
-  if(!found)
+  if((i = element_index(atomic_z)) < 0)
   {
     error_atomix("Element Z = %i is not in the atomic data", atomic_z);
     return;
@@ -217,3 +206,18 @@ single_element(void)
   single_element_info(ele[i], true);
   display_show(SCROLL_ENABLE, false, 0);
 }
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the line and edge totals of every element, in an order chosen
+ *         by the user.
+ *
+ * @details
+ *
+ * ************************************************************************** */
+
+void
+elements_summary(void)
+{
+  species_summary(TRUE);
+}
@@ -3,6 +3,8 @@ void bound_bound_header(void);
 void bound_bound_line(int n);
 void all_bound_bound(void);
 void bound_bound_wavelength_range(void);
+void bound_bound_strongest(void);
+void bound_bound_lower_level(void);
 void bound_bound_element(void);
 void bound_bound_ion(void);
 /* buffer.c */
@@ -50,6 +52,8 @@ void bound_free_header(void);
 void bound_free_line(int nphot);
 void all_bound_free(void);
 void bound_free_wavelength_range(void);
+void bound_free_active_wavelength(void);
+void bound_free_active_range(void);
 void bound_free_element(void);
 void bound_free_ion(void);
 /* atomic_data.c */
@@ -58,12 +62,33 @@ int fraction(double value, double array[], int npts, int *ival, double *f, int m
 int linterp(double x, double xarray[], double yarray[], int xdim, double *y, int mode);
 int index_phot_top(void);
 int index_inner_cross(void);
-void indexx(int n, float arrin[], int indx[]);
+int index_frequency_order(void);
 int limit_lines(double freqmin, double freqmax);
 int check_xsections(void);
 double a21(struct lines *line_ptr);
 double upsilon(int n_coll, double u0);
 int index_lines(void);
+int grow_ions(int n);
+int grow_levels(int n);
+int grow_lines(int n);
+IonLinksPtr ion_link(int nion);
+LineLinksPtr line_link(const struct lines *lin);
+int grow_coll_stren(int n);
+int grow_phot_top(int n);
+int grow_inner_cross(int n);
+int grow_drecomb(int n);
+int grow_total_rr(int n);
+int grow_bad_gs_rr(int n);
+int grow_dere_di_rate(int n);
+int config_njumps(int nlevel, int kind);
+const int *config_jumps(int nlevel, int kind);
+int resize_macro_jumps(const int *njumps);
+void free_atomic_tables(void);
+int reset_atomic_data(void);
+void update_xsection_pointers(void);
+int resize_xsection_points(int npoints);
+int add_xsection_points(TopPhotPtr xsection, int np, double energy[], double x[]);
+int get_atomic_data_file_path(char *file, int use_relative, char *path);
 int get_atomic_data(char *masterfile, int use_relative);
 /* query.c */
 void clean_up_form(FORM *form, FIELD **fields, int nfields);
@@ -71,17 +96,24 @@ int control_form(FORM *form, int ch, int exit_index);
 int query_user(Window_t w, Query_t *q, int nfields, char *title_message);
 void init_single_question_form(Query_t *q, char *label, char *answer);
 void init_two_question_form(Query_t *q, char *label1, char *label2, char *answer1, char *answer2);
+void init_multi_question_form(Query_t *q, int nquestions, char **labels, char **answers);
 int query_wavelength_range(double *wmin, double *wmax);
+int query_wavelength_energy_range(double *wmin, double *wmax, double *emin, double *emax);
+int query_wavelength(double *wavelength);
 int query_atomic_number(int *z);
 int query_ion_input(int nion_or_z, int *z, int *istate, int *nion);
+int query_level(int *level);
 void switch_atomic_data(void);
 int query_atomic_number_by_symbol(int *z);
+int query_stats_order(int *order);
+int query_strongest_lines(int *k, int *strength);
 /* elements.c */
 void elements_header(void);
 void element_line(struct elements e);
 void single_element_info(struct elements e, int detailed);
 void all_elements(void);
 void single_element(void);
+void elements_summary(void);
 /* ions.c */
 void ion_header(void);
 void ion_line(int nion);
@@ -90,16 +122,107 @@ void all_ions(void);
 void single_ion_atomic_z(void);
 void single_ion_nion(void);
 void ions_for_element(void);
+void ions_summary(void);
 /* levels.c */
 void atomic_level_header(void);
 void atomic_level_line(int n);
 void all_level_configurations(void);
+void level_transitions(void);
 /* inner.c */
 void inner_shell_header(void);
 void inner_shell_line(int nphot);
 void all_inner_shell(void);
 void inner_shell_wavelength_range(void);
+void inner_shell_active_wavelength(void);
+void inner_shell_active_range(void);
 void inner_shell_element(void);
 void inner_shell_ion(void);
 /* parse.c */
 int check_command_line(int argc, char **argv);
+/* snapshot.c */
+int save_atomic_snapshot(char *masterfile, int use_relative, int first_summary);
+int load_atomic_snapshot(char *masterfile, int use_relative);
+/* records.c */
+void free_atomic_data_batches(void);
+int read_atomic_data_batches(FILE *mptr, int use_relative, Batch_t **batches);
+Record_t *get_next_record(Batch_t *batch);
+char *copy_record_line(const Record_t *record, char *buffer, int size);
+int record_scanf(Record_t *record, int kind, ...);
+/* lookup.c */
+void reset_lookup_tables(void);
+int add_element_lookup(int nelem);
+int add_ion_lookup(int nion);
+void rebuild_lookup_tables(void);
+int element_index(int z);
+int ion_index(int z, int istate);
+int element_index_by_name(const char *name);
+void lookup_tables_memory(MemoryTable *table);
+/* sort.c */
+int sort_by_key(int n, const double *keys, int *order);
+/* columns.c */
+void free_line_columns(void);
+int build_line_columns(void);
+int select_lines(int z, int istate, int *selected);
+LineRange find_line_range(double freqmin, double freqmax);
+void line_columns_memory(MemoryTable *table);
+/* windows.c */
+int find_window_ranges(SpectralWindow *windows, int nwindows);
+int read_spectral_windows(const char *path, double velocity, SpectralWindow **windows);
+void print_spectral_windows(FILE *f, const SpectralWindow *windows, int nwindows);
+int headless_window_lookup(const char *path, double velocity);
+/* postings.c */
+void free_posting_lists(void);
+int build_posting_lists(void);
+int find_postings(int kind, int z, int istate, const int **entries);
+void posting_lists_memory(MemoryTable *table);
+/* stats.c */
+void free_species_stats(void);
+int build_species_stats(void);
+const SpeciesStats *get_element_stats(int nelem);
+const SpeciesStats *get_ion_stats(int nion);
+int stats_order_from_name(const char *name);
+const char *stats_order_name(int order);
+int order_species_stats(int by_element, int order, int *index);
+void species_stats_header(char *row, size_t len);
+void species_stats_row(char *row, size_t len, int by_element, int n);
+int print_species_stats(FILE *f, int by_element, int order);
+int headless_species_summary(int order);
+void species_summary(int by_element);
+void species_stats_memory(MemoryTable *table);
+/* strongest.c */
+void free_strongest_index(void);
+int build_strongest_index(void);
+int find_strongest_lines(double freqmin, double freqmax, int s, int k, int *strongest);
+double line_strength(int s, int line);
+void strongest_index_memory(MemoryTable *table);
+/* coverage.c */
+void free_coverage_index(void);
+TopPhotPtr coverage_xsection(int list, int i);
+int build_coverage_index(void);
+int find_active_xsections(int list, double freqmin, double freqmax, int *active);
+void active_xsections(int list, int at_wavelength);
+void coverage_index_memory(MemoryTable *table);
+/* lowerlevel.c */
+void free_lower_level_index(void);
+int build_lower_level_index(void);
+int find_lines_by_lower_level(double freqmin, double freqmax, double emin, double emax, int *found);
+void lower_level_index_memory(MemoryTable *table);
+/* adjacency.c */
+void free_level_links(void);
+int build_level_links(void);
+int find_level_links(int kind, int level, const int **entries);
+void level_links_memory(MemoryTable *table);
+/* compact.c */
+void free_packed_xsections(void);
+int compact_xsections(double max_error);
+int xsection_points(const Topbase_phot *xsection, double *freq, double *x);
+void xsection_point(const Topbase_phot *xsection, int k, double *freq, double *x);
+double xsection_sigma(const Topbase_phot *xsection, double freq);
+void packed_xsections_memory(MemoryTable *table);
+/* memory.c */
+void account_memory(MemoryTable *table, const void *block, size_t reserved, size_t used);
+void start_memory_accounting(void);
+void memory_report_header(char *row, size_t len);
+void memory_report_row(char *row, size_t len, const MemoryTable *table);
+void memory_summary(void);
+int headless_memory_report(void);
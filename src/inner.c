@@ -140,6 +140,39 @@ inner_shell_wavelength_range(void)
   display_show(SCROLL_ENABLE, true, 4);
 }
 
+/* ************************************************************************** */
+/**
+ * @brief  Print the inner shell cross sections which are non-zero at a
+ *         wavelength.
+ *
+ * @details
+ *
+ * The wavelength is queried within active_xsections(), which also shows the
+ * value of each cross section at the wavelength.
+ *
+ * ************************************************************************** */
+
+void
+inner_shell_active_wavelength(void)
+{
+  active_xsections(XSECTION_INNER, TRUE);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the inner shell cross sections which are non-zero anywhere over a
+ *         wavelength range.
+ *
+ * @details
+ *
+ * ************************************************************************** */
+
+void
+inner_shell_active_range(void)
+{
+  active_xsections(XSECTION_INNER, FALSE);
+}
+
 /* ************************************************************************** */
 /**
  * @brief  Print all the bound free edges for an element.
@@ -151,8 +184,8 @@ inner_shell_wavelength_range(void)
 void
 inner_shell_element(void)
 {
-  int n, z;
-  int nphot;
+  int i, n, z;
+  const int *entries;
   char element[LINELEN];
 
   if(query_atomic_number(&z) == FORM_QUIT)
@@ -166,15 +199,9 @@ inner_shell_element(void)
   add_sep_display(ndash);
   inner_shell_header();
 
-  n = 0;
-  for(nphot = 0; nphot < n_inner_tot; ++nphot)
-  {
-    if(inner_cross_ptr[nphot]->z == z)
-    {
-      inner_shell_line(nphot);
-      n++;
-    }
-  }
+  n = find_postings(POSTING_INNER, z, 0, &entries);
+  for(i = 0; i < n; ++i)
+    inner_shell_line(entries[i]);
 
   count(ndash, n);
 
@@ -193,7 +220,8 @@ void
 inner_shell_ion(void)
 {
   int z, istate;
-  int n, nion, nphot;
+  int i, n, nion;
+  const int *entries;
   char element[LINELEN];
 
   if(query_ion_input(TRUE, NULL, NULL, &nion) == FORM_QUIT)
@@ -216,15 +244,9 @@ inner_shell_ion(void)
   add_sep_display(ndash);
   inner_shell_header();
 
-  n = 0;
-  for(nphot = 0; nphot < n_inner_tot; ++nphot)
-  {
-    if(inner_cross_ptr[nphot]->z == z && inner_cross_ptr[nphot]->istate == istate)
-    {
-      inner_shell_line(nphot);
-      n++;
-    }
-  }
+  n = find_postings(POSTING_INNER, z, istate, &entries);
+  for(i = 0; i < n; ++i)
+    inner_shell_line(entries[i]);
 
   count(ndash, n);
 
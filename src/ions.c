@@ -77,10 +77,12 @@ ion_line(int nion)
 void
 single_ion_info(int nion, int detailed)
 {
-  int i, n;
+  int i, j, n;
+  const int *entries;
   double wavelength;
   char element[LINELEN];
   struct ions ion;
+  const SpeciesStats *stats;
 
   ion = ions[nion];
   get_element_name(ion.z, element);
@@ -93,6 +95,15 @@ single_ion_info(int nion, int detailed)
   display_add(" Photionization info           : %i", ion.phot_info);
   display_add(" Ionisation potential          : %.2e eV", ion.ip / EV2ERGS);
   display_add(" Number of ions for element %-2s : %i", element, ele[ion.nelem].nions);
+  if((stats = get_ion_stats(nion)) != NULL)
+  {
+    display_add(" Lines (macro atom / simple)   : %i (%i / %i)", stats->nlines, stats->nmacro, stats->nsimple);
+    display_add(" Lines with collision strength : %i", stats->ncoll);
+    display_add(" Line wavelength range         : %.2f - %.2f A", stats->wmin, stats->wmax);
+    display_add(" Sum of gf                     : %.3e", stats->gf_sum);
+    display_add(" Photoionization edges         : %i", stats->nphot);
+    display_add(" Inner shell edges             : %i", stats->ninner);
+  }
   add_sep_display(ndash);
 
   if(!detailed)
@@ -102,16 +113,11 @@ single_ion_info(int nion, int detailed)
   add_sep_display(ndash);
   display_add(" %-12s %-12s %-12s", "Wavelength", "levu", "levl");
 
-  n = 0;
-
-  for(i = 0; i < nlines; ++i)
+  n = find_postings(POSTING_LINES, ion.z, ion.istate, &entries);
+  for(i = 0; i < n; ++i)
   {
-    if(lin_ptr[i]->z == ion.z && lin_ptr[i]->istate == ion.istate)
-    {
-      n++;
-      wavelength = C_SI / lin_ptr[i]->freq / ANGSTROM / 1e-2;
-      display_add(" %-12.2f %-12i %-12i", wavelength, lin_ptr[i]->levu, lin_ptr[i]->levl);
-    }
+    j = entries[i];
+    display_add(" %-12.2f %-12i %-12i", line_columns.wavelength[j], line_columns.levu[j], line_columns.levl[j]);
   }
 
   add_sep_display(ndash);
@@ -122,16 +128,12 @@ single_ion_info(int nion, int detailed)
   add_sep_display(ndash);
   display_add(" %-12s %-12s %-12s", "Wavelength", "n", "l");
 
-  n = 0;
-
-  for(i = 0; i < nphot_total; ++i)
+  n = find_postings(POSTING_PHOT, ion.z, ion.istate, &entries);
+  for(i = 0; i < n; ++i)
   {
-    if(phot_top_ptr[i]->z == ion.z && phot_top_ptr[i]->istate == ion.istate)
-    {
-      n++;
-      wavelength = C_SI / phot_top_ptr[i]->freq[0] / ANGSTROM / 1e-2;
-      display_add(" %-12.2f %-12i %-12i", wavelength, phot_top_ptr[i]->n, phot_top_ptr[i]->l);
-    }
+    j = entries[i];
+    wavelength = C_SI / phot_top_ptr[j]->freq[0] / ANGSTROM / 1e-2;
+    display_add(" %-12.2f %-12i %-12i", wavelength, phot_top_ptr[j]->n, phot_top_ptr[j]->l);
   }
 
   add_sep_display(ndash);
@@ -143,17 +145,13 @@ single_ion_info(int nion, int detailed)
   add_sep_display(ndash);
   display_add(" %-12s %-12s %-12s %-12s", "Ionisation", "Wavelength", "n", "l");
 
-  n = 0;
-
-  for(i = 0; i < n_inner_tot; ++i)
+  n = find_postings(POSTING_INNER, ion.z, ion.istate, &entries);
+  for(i = 0; i < n; ++i)
   {
-    if(inner_cross_ptr[i]->z == ion.z && inner_cross_ptr[i]->istate == ion.istate)
-    {
-      n++;
-      wavelength = C_SI / inner_cross_ptr[i]->freq[0] / ANGSTROM / 1e-2;
-      display_add(" %-12i %-12.2f %-12i %-12i", inner_cross_ptr[i]->istate, wavelength, inner_cross_ptr[i]->n,
-                  inner_cross_ptr[i]->l);
-    }
+    j = entries[i];
+    wavelength = C_SI / inner_cross_ptr[j]->freq[0] / ANGSTROM / 1e-2;
+    display_add(" %-12i %-12.2f %-12i %-12i", inner_cross_ptr[j]->istate, wavelength, inner_cross_ptr[j]->n,
+                inner_cross_ptr[j]->l);
   }
 
   add_sep_display(ndash);
@@ -198,7 +196,6 @@ single_ion_atomic_z(void)
 {
   int nion;
   int z, istate;
-  int found = false;
 
   if(query_ion_input(false, &z, &istate, NULL) == FORM_QUIT)
     return;
@@ -206,16 +203,7 @@ single_ion_atomic_z(void)
   if(find_element(z) == ELEMENT_NO_FOUND)
     return;
 
-  for(nion = 0; nion < nions; ++nion)
-  {
-    if(ions[nion].z == z && ions[nion].istate == istate)
-    {
-      found = true;
-      break;
-    }
-  }
-
-  if(!found)
+  if((nion = ion_index(z, istate)) < 0)
   {
     error_atomix("Unknown ion configuration");
     return;
@@ -288,3 +276,18 @@ ions_for_element(void)
   count(ndash_line, ele[n].nions);
   display_show(SCROLL_ENABLE, true, 4);
 }
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the line and edge totals of every ion, in an order chosen by
+ *         the user.
+ *
+ * @details
+ *
+ * ************************************************************************** */
+
+void
+ions_summary(void)
+{
+  species_summary(FALSE);
+}
@@ -26,7 +26,7 @@ void
 atomic_level_header(void)
 {
   add_sep_display(ndash);
-  display_add(" %-12s %-12s %-12s %-12s %-12s", "Z", "istate", "nion", "nden", "ilv");
+  display_add(" %-12s %-12s %-12s %-12s %-12s %-12s", "Level", "Z", "istate", "nion", "nden", "ilv");
   add_sep_display(ndash);
 }
 
@@ -43,7 +43,7 @@ atomic_level_line(int n)
 {
   ConfigPtr c;
   c = &config[n];
-  display_add(" %-12i %-12i %-12i %-12i %-12i", c->z, c->istate, c->nion, c->nden, c->ilv);
+  display_add(" %-12i %-12i %-12i %-12i %-12i %-12i", n, c->z, c->istate, c->nion, c->nden, c->ilv);
 }
 
 /* ************************************************************************** */
@@ -67,3 +67,144 @@ all_level_configurations(void)
   count(ndash, nlevels);
   display_show(SCROLL_ENABLE, true, 3);
 }
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the lines which go up from, or down to, a level to the display.
+ *
+ * @param[in]  level  The level, as an index into config
+ * @param[in]  kind   LEVEL_LINES_UP or LEVEL_LINES_DOWN
+ *
+ * @return  The number of lines
+ *
+ * @details
+ *
+ * The level at the other end of each line is shown, which is -9999 or -1 if
+ * the line was not matched to a level.
+ *
+ * ************************************************************************** */
+
+static int
+level_lines(int level, int kind)
+{
+  int i, j, n, other;
+  const int *entries;
+
+  display_add(" Bound-bound transitions %s this level", kind == LEVEL_LINES_UP ? "up from" : "down to");
+  add_sep_display(ndash);
+  display_add(" %-12s %-12s %-12s %-12s %-12s %-12s", "Wavelength", kind == LEVEL_LINES_UP ? "Upper" : "Lower",
+              "ilv", "Energy (eV)", "gf", "A21");
+
+  n = find_level_links(kind, level, &entries);
+  for(i = 0; i < n; ++i)
+  {
+    j = entries[i];
+    other = kind == LEVEL_LINES_UP ? lin_ptr[j]->nconfigu : lin_ptr[j]->nconfigl;
+    if(other >= 0 && other < nlevels)
+    {
+      display_add(" %-12.2f %-12i %-12i %-12.3f %-12.3e %-12.3e", line_columns.wavelength[j], other, config[other].ilv,
+                  config[other].ex / EV2ERGS, line_columns.gl[j] * line_columns.f[j], a21(lin_ptr[j]));
+    }
+    else
+    {
+      display_add(" %-12.2f %-12i %-12s %-12s %-12.3e %-12.3e", line_columns.wavelength[j], other, "-", "-",
+                  line_columns.gl[j] * line_columns.f[j], a21(lin_ptr[j]));
+    }
+  }
+
+  add_sep_display(ndash);
+  display_add(" %i lines", n);
+  add_sep_display(ndash);
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the photoionization or inner shell edges linked to a level to
+ *         the display.
+ *
+ * @param[in]  level  The level, as an index into config
+ * @param[in]  kind   LEVEL_PHOT_FROM, LEVEL_PHOT_TO or LEVEL_INNER_FROM
+ *
+ * @return  The number of edges
+ *
+ * ************************************************************************** */
+
+static int
+level_edges(int level, int kind)
+{
+  int i, n;
+  const int *entries;
+  TopPhotPtr x;
+
+  switch(kind)
+  {
+  case LEVEL_PHOT_FROM:
+    display_add(" Photoionization from this level");
+    break;
+  case LEVEL_PHOT_TO:
+    display_add(" Photoionization into this level");
+    break;
+  default:
+    display_add(" Inner shell ionization from this level");
+    break;
+  }
+  add_sep_display(ndash);
+  display_add(" %-12s %-12s %-12s %-12s %-12s", "Wavelength", "n", "l", "Lower", "Upper");
+
+  n = find_level_links(kind, level, &entries);
+  for(i = 0; i < n; ++i)
+  {
+    x = kind == LEVEL_INNER_FROM ? inner_cross_ptr[entries[i]] : phot_top_ptr[entries[i]];
+    display_add(" %-12.2f %-12i %-12i %-12i %-12i", C_SI / x->freq[0] / ANGSTROM / 1e-2, x->n, x->l, x->nlev,
+                x->uplev);
+  }
+
+  add_sep_display(ndash);
+  display_add(" %i edges", n);
+  add_sep_display(ndash);
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print every transition which goes into or out of a level.
+ *
+ * @details
+ *
+ * The level is queried as an index into config, which is the Level column of
+ * the level tables. The transitions are found from the level link lists, so
+ * this works for simple ions as well as macro atoms, and only the transitions
+ * of the level are looked at.
+ *
+ * ************************************************************************** */
+
+void
+level_transitions(void)
+{
+  int level, n;
+  char element[LINELEN];
+  ConfigPtr c;
+
+  if(query_level(&level) == FORM_QUIT)
+    return;
+
+  c = &config[level];
+  get_element_name(c->z, element);
+
+  display_add(" Level %i: %s %i, ilv %i, energy %.3f eV, g %.0f", level, element, c->istate, c->ilv, c->ex / EV2ERGS,
+              c->g);
+  add_sep_display(ndash);
+
+  n = level_lines(level, LEVEL_LINES_UP);
+  n += level_lines(level, LEVEL_LINES_DOWN);
+  n += level_edges(level, LEVEL_PHOT_FROM);
+  n += level_edges(level, LEVEL_PHOT_TO);
+  n += level_edges(level, LEVEL_INNER_FROM);
+
+  display_add(" %i transitions in total", n);
+
+  display_show(SCROLL_ENABLE, false, 0);
+}
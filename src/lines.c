@@ -11,6 +11,7 @@
  * ************************************************************************** */
 
 #include <stdbool.h>
+#include <stdlib.h>
 
 #include "atomix.h"
 
@@ -35,23 +36,24 @@ bound_bound_header(void)
 /**
  * @brief  Standard layout for a bound bound transition line.
  *
+ * @param[in]  n  The index of the line in frequency order
+ *
  * @details
  *
  * The function bound_bound_header will create an appropriate header for one
- * of these lines.
+ * of these lines. The line is read from the line columns.
  *
  * ************************************************************************** */
 
 void
 bound_bound_line(int n)
 {
-  double wl;
   char element[LINELEN];
 
-  get_element_name(lin_ptr[n]->z, element);
-  wl = C_SI / lin_ptr[n]->freq / ANGSTROM / 1e-2;
-  display_add(" %-12.2f %-12s %-12i %-12i %-12i %-12i %-12i %-12i %-12i", wl, element, lin_ptr[n]->z,
-              lin_ptr[n]->istate, lin_ptr[n]->levu, lin_ptr[n]->levl, lin_ptr[n]->nion, lin_ptr[n]->macro_info, n);
+  get_element_name(line_columns.z[n], element);
+  display_add(" %-12.2f %-12s %-12i %-12i %-12i %-12i %-12i %-12i %-12i", line_columns.wavelength[n], element,
+              line_columns.z[n], line_columns.istate[n], line_columns.levu[n], line_columns.levl[n],
+              line_columns.nion[n], line_columns.macro_info[n], n);
 }
 
 /* ************************************************************************** */
@@ -71,8 +73,8 @@ all_bound_bound(void)
   int i;
   double wmin, wmax;
 
-  wmin = C_SI / lin_ptr[nlines - 1]->freq / ANGSTROM / 1e-2;
-  wmax = C_SI / lin_ptr[0]->freq / ANGSTROM / 1e-2;
+  wmin = line_columns.wavelength[nlines - 1];
+  wmax = line_columns.wavelength[0];
 
   display_add(" Wavelength range: %.2f - %.2f Angstroms", wmin, wmax);
   add_sep_display(ndash);
@@ -94,9 +96,8 @@ all_bound_bound(void)
  *
  * @details
  *
- * This function simply loops over the lin_ptr struct between the limits
- * nline_min and nline_max set by the limit_lines() function. The wavelength
- * limits are queried within the function.
+ * This function simply loops over the lines in the range found by
+ * find_line_range(). The wavelength limits are queried within the function.
  *
  * ************************************************************************** */
 
@@ -105,18 +106,19 @@ bound_bound_wavelength_range(void)
 {
   int n, nline;
   double wmin, wmax;
+  LineRange range;
 
   if(query_wavelength_range(&wmin, &wmax) == FORM_QUIT)
     return;
 
-  limit_lines(C / (wmax * ANGSTROM), C / (wmin * ANGSTROM));
-  n = nline_max - nline_min - 1;
+  range = find_line_range(C / (wmax * ANGSTROM), C / (wmin * ANGSTROM));
+  n = range.end - range.first;
 
   display_add(" Wavelength range: %.2f - %.2f Angstroms", wmin, wmax);
   add_sep_display(ndash);
   bound_bound_header();
 
-  for(nline = nline_min + 1; nline < nline_max; ++nline)
+  for(nline = range.first; nline < range.end; ++nline)
     bound_bound_line(nline);
 
   count(ndash, n);
@@ -124,6 +126,113 @@ bound_bound_wavelength_range(void)
   display_show(SCROLL_ENABLE, true, 4);
 }
 
+/* ************************************************************************** */
+/**
+ * @brief  Print the strongest bound bound transitions over a given wavelength
+ *         range.
+ *
+ * @details
+ *
+ * The wavelength range, number of lines and the measure of line strength are
+ * queried. The lines are found with the strongest line index, so the time taken
+ * depends on the number of lines asked for rather than the number of lines in
+ * the range. The strongest line is printed first.
+ *
+ * ************************************************************************** */
+
+void
+bound_bound_strongest(void)
+{
+  int i, j, k, n, strength;
+  int *strongest;
+  double wmin, wmax;
+  char element[LINELEN];
+
+  if(query_wavelength_range(&wmin, &wmax) == FORM_QUIT)
+    return;
+
+  if(query_strongest_lines(&k, &strength) == FORM_QUIT)
+    return;
+
+  if((strongest = malloc(k * sizeof(int))) == NULL ||
+     (n = find_strongest_lines(C / (wmax * ANGSTROM), C / (wmin * ANGSTROM), strength, k, strongest)) < 0)
+  {
+    free(strongest);
+    error_atomix("Unable to find the strongest lines");
+    return;
+  }
+
+  display_add(" Strongest lines by %s: %.2f - %.2f Angstroms", strength == STRENGTH_GF ? "gf" : "A21", wmin, wmax);
+  add_sep_display(ndash + 13);
+  display_add(" %-12s %-12s %-12s %-12s %-12s %-12s %-12s %-12s %-12s %-12s", strength == STRENGTH_GF ? "gf" : "A21",
+              "Wavelength", "Element", "Z", "istate", "levu", "levl", "nion", "macro info", "nres");
+  add_sep_display(ndash + 13);
+
+  for(i = 0; i < n; ++i)
+  {
+    j = strongest[i];
+    get_element_name(line_columns.z[j], element);
+    display_add(" %-12.4e %-12.2f %-12s %-12i %-12i %-12i %-12i %-12i %-12i %-12i", line_strength(strength, j),
+                line_columns.wavelength[j], element, line_columns.z[j], line_columns.istate[j], line_columns.levu[j],
+                line_columns.levl[j], line_columns.nion[j], line_columns.macro_info[j], j);
+  }
+
+  free(strongest);
+
+  count(ndash + 13, n);
+
+  display_show(SCROLL_ENABLE, true, 4);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the bound bound transitions over a given wavelength range
+ *         whose lower level is within a range of energies.
+ *
+ * @details
+ *
+ * The wavelength and energy ranges are queried in one form, with the energies
+ * in eV. The lines are found with the lower level energy index, so only the
+ * lines at each end of the wavelength range are checked one by one.
+ *
+ * ************************************************************************** */
+
+void
+bound_bound_lower_level(void)
+{
+  int i, n;
+  int *found;
+  double wmin, wmax, emin, emax;
+  LineRange range;
+
+  if(query_wavelength_energy_range(&wmin, &wmax, &emin, &emax) == FORM_QUIT)
+    return;
+
+  range = find_line_range(C / (wmax * ANGSTROM), C / (wmin * ANGSTROM));
+
+  if((found = malloc((range.end - range.first + 1) * sizeof(int))) == NULL ||
+     (n = find_lines_by_lower_level(C / (wmax * ANGSTROM), C / (wmin * ANGSTROM), emin * EV2ERGS, emax * EV2ERGS,
+                                    found)) < 0)
+  {
+    free(found);
+    error_atomix("Unable to find the lines by lower level energy");
+    return;
+  }
+
+  display_add(" Wavelength range: %.2f - %.2f Angstroms, lower level energy: %.3f - %.3f eV", wmin, wmax, emin, emax);
+  add_sep_display(ndash);
+  bound_bound_header();
+
+  for(i = 0; i < n; ++i)
+    bound_bound_line(found[i]);
+
+  free(found);
+
+  count(ndash, n);
+
+  display_show(SCROLL_ENABLE, true, 4);
+}
+
 /* ************************************************************************** */
 /**
  * @brief  Print all bound bound transitions for a given element.
@@ -136,7 +245,8 @@ void
 bound_bound_element(void)
 {
   int n, z;
-  int nline;
+  int i;
+  const int *entries;
   char element[LINELEN];
 
   if(query_atomic_number(&z) == FORM_QUIT)
@@ -150,15 +260,9 @@ bound_bound_element(void)
   add_sep_display(ndash);
   bound_bound_header();
 
-  n = 0;
-  for(nline = 0; nline < nlines; ++nline)
-  {
-    if(lin_ptr[nline]->z == z)
-    {
-      bound_bound_line(nline);
-      n++;
-    }
-  }
+  n = find_postings(POSTING_LINES, z, 0, &entries);
+  for(i = 0; i < n; ++i)
+    bound_bound_line(entries[i]);
 
   count(ndash, n);
 
@@ -181,7 +285,8 @@ void
 bound_bound_ion(void)
 {
   int z, istate;
-  int n, nion, nline;
+  int i, n, nion;
+  const int *entries;
   char element[LINELEN];
 
   if(query_ion_input(TRUE, NULL, NULL, &nion) == FORM_QUIT)
@@ -204,15 +309,9 @@ bound_bound_ion(void)
   add_sep_display(ndash);
   bound_bound_header();
 
-  n = 0;
-  for(nline = 0; nline < nlines; ++nline)
-  {
-    if(lin_ptr[nline]->z == z && lin_ptr[nline]->istate == istate)
-    {
-      bound_bound_line(nline);
-      n++;
-    }
-  }
+  n = find_postings(POSTING_LINES, z, istate, &entries);
+  for(i = 0; i < n; ++i)
+    bound_bound_line(entries[i]);
 
   count(ndash, n);
 
@@ -0,0 +1,284 @@
+/* ************************************************************************** */
+/**
+ * @file     lookup.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Lookup tables for finding elements and ions.
+ *
+ * @details
+ *
+ * The ele and ions arrays are in the order the data was read in, so finding
+ * an element or ion used to mean a scan over the whole array. Instead, elz and
+ * ionzi map an atomic number, and an atomic number and ionization state, to
+ * the index of the element or ion, and element names are hashed so they can
+ * be found without caring about their case. The tables are filled in as the
+ * elements and ions are read in, or rebuilt in one go after a snapshot has
+ * been loaded.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#include "atomix.h"
+
+#define SYMBOL_TABLE_SIZE 128
+
+static int symbol_table[SYMBOL_TABLE_SIZE];
+
+/* ************************************************************************** */
+/**
+ * @brief  Hash the name of an element, ignoring the case of the letters.
+ *
+ * @param[in]  name  The name of the element
+ *
+ * @return  The hash of the name
+ *
+ * ************************************************************************** */
+
+static uint32_t
+hash_symbol(const char *name)
+{
+  uint32_t hash = 2166136261u;
+
+  for(; *name != '\0'; ++name)
+  {
+    hash ^= (unsigned char) tolower((unsigned char) *name);
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Compare two element names, ignoring the case of the letters.
+ *
+ * @param[in]  a  The first name
+ * @param[in]  b  The second name
+ *
+ * @return  TRUE if the names are the same
+ *
+ * ************************************************************************** */
+
+static int
+same_symbol(const char *a, const char *b)
+{
+  for(; *a != '\0' && *b != '\0'; ++a, ++b)
+    if(tolower((unsigned char) *a) != tolower((unsigned char) *b))
+      return FALSE;
+
+  return *a == *b;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Empty all of the lookup tables.
+ *
+ * ************************************************************************** */
+
+void
+reset_lookup_tables(void)
+{
+  int z, istate;
+
+  for(z = 0; z <= ZMAX; ++z)
+  {
+    elz[z] = -1;
+    for(istate = 0; istate <= ZMAX + 1; ++istate)
+      ionzi[z][istate] = -1;
+  }
+
+  for(z = 0; z < SYMBOL_TABLE_SIZE; ++z)
+    symbol_table[z] = -1;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add an element to the lookup tables.
+ *
+ * @param[in]  nelem  The index of the element in ele
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the atomic number of the element
+ *          is outside of the range of the tables
+ *
+ * @details
+ *
+ * If an element with the same atomic number or name is already in the tables,
+ * the first one read in is kept.
+ *
+ * ************************************************************************** */
+
+int
+add_element_lookup(int nelem)
+{
+  int z = ele[nelem].z;
+  uint32_t slot;
+
+  if(z < 1 || z > ZMAX)
+    return EXIT_FAILURE;
+
+  if(elz[z] < 0)
+    elz[z] = nelem;
+
+  slot = hash_symbol(ele[nelem].name) & (SYMBOL_TABLE_SIZE - 1);
+  while(symbol_table[slot] >= 0)
+  {
+    if(same_symbol(ele[symbol_table[slot]].name, ele[nelem].name))
+      return EXIT_SUCCESS;
+    slot = (slot + 1) & (SYMBOL_TABLE_SIZE - 1);
+  }
+
+  symbol_table[slot] = nelem;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add an ion to the lookup tables.
+ *
+ * @param[in]  nion  The index of the ion in ions
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the atomic number or ionization
+ *          state of the ion is outside of the range of the tables
+ *
+ * @details
+ *
+ * If an ion with the same atomic number and ionization state is already in the
+ * table, the first one read in is kept.
+ *
+ * ************************************************************************** */
+
+int
+add_ion_lookup(int nion)
+{
+  int z = ions[nion].z;
+  int istate = ions[nion].istate;
+
+  if(z < 1 || z > ZMAX || istate < 1 || istate > z + 1)
+    return EXIT_FAILURE;
+
+  if(ionzi[z][istate] < 0)
+    ionzi[z][istate] = nion;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Rebuild the lookup tables from ele and ions.
+ *
+ * @details
+ *
+ * Used when the elements and ions have been copied in from somewhere other
+ * than the data files, such as a snapshot.
+ *
+ * ************************************************************************** */
+
+void
+rebuild_lookup_tables(void)
+{
+  int n;
+
+  reset_lookup_tables();
+
+  for(n = 0; n < nelements; ++n)
+    add_element_lookup(n);
+  for(n = 0; n < nions; ++n)
+    add_ion_lookup(n);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the index of an element in ele.
+ *
+ * @param[in]  z  The atomic number of the element
+ *
+ * @return  The index of the element, or -1 if it is not in the atomic data
+ *
+ * ************************************************************************** */
+
+int
+element_index(int z)
+{
+  if(z < 1 || z > ZMAX)
+    return -1;
+
+  return elz[z];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the index of an ion in ions.
+ *
+ * @param[in]  z       The atomic number of the ion
+ * @param[in]  istate  The ionization state of the ion
+ *
+ * @return  The index of the ion, or -1 if it is not in the atomic data
+ *
+ * ************************************************************************** */
+
+int
+ion_index(int z, int istate)
+{
+  if(z < 1 || z > ZMAX || istate < 1 || istate > z + 1)
+    return -1;
+
+  return ionzi[z][istate];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the index of an element in ele from its name.
+ *
+ * @param[in]  name  The name of the element, in any case
+ *
+ * @return  The index of the element, or -1 if it is not in the atomic data
+ *
+ * ************************************************************************** */
+
+int
+element_index_by_name(const char *name)
+{
+  uint32_t slot;
+
+  if(name == NULL || name[0] == '\0')
+    return -1;
+
+  slot = hash_symbol(name) & (SYMBOL_TABLE_SIZE - 1);
+  while(symbol_table[slot] >= 0)
+  {
+    if(same_symbol(ele[symbol_table[slot]].name, name))
+      return symbol_table[slot];
+    slot = (slot + 1) & (SYMBOL_TABLE_SIZE - 1);
+  }
+
+  return -1;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the lookup tables to a memory table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * @details
+ *
+ * The lookup tables are static and cover every possible z and istate, so all
+ * of each counts as used.
+ *
+ * ************************************************************************** */
+
+void
+lookup_tables_memory(MemoryTable *table)
+{
+  account_memory(table, elz, sizeof(elz), sizeof(elz));
+  account_memory(table, ionzi, sizeof(ionzi), sizeof(ionzi));
+  account_memory(table, symbol_table, sizeof(symbol_table), sizeof(symbol_table));
+}
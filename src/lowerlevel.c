@@ -0,0 +1,249 @@
+/* ************************************************************************** */
+/**
+ * @file     lowerlevel.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * An index for finding the lines in a frequency range whose lower level is
+ * within a range of energies.
+ *
+ * @details
+ *
+ * The frequency ordered line list is split into buckets of LOWER_LEVEL_BUCKET
+ * lines, and the lines in each bucket are kept in a second order sorted by the
+ * energy of their lower level. The lines in the frequency range are covered by
+ * a run of whole buckets with a partial bucket at each end. In each whole
+ * bucket the lines within the energy range are next to each other in energy
+ * order, so are found with a binary search, and only the partial buckets have
+ * to be checked line by line. The lines found in a bucket are put back into
+ * frequency order with a bit mask, so results always come out in frequency
+ * order.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+
+#include "atomix.h"
+
+#define LOWER_LEVEL_BUCKET 64   /* The number of lines in each bucket, one bit each in a mask */
+
+typedef struct LowerLevelIndex_t
+{
+  int n;                        /* The number of lines indexed */
+  double *el;                   /* The lower level energy of each line in frequency order */
+  double *sorted_el;            /* The lower level energies in each bucket in energy order */
+  int *order;                   /* The position of each line in each bucket in energy order */
+} LowerLevelIndex_t;
+
+static LowerLevelIndex_t lower_level_index = { 0, NULL, NULL, NULL };
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the lower level energy index.
+ *
+ * ************************************************************************** */
+
+void
+free_lower_level_index(void)
+{
+  free(lower_level_index.el);
+  free(lower_level_index.sorted_el);
+  free(lower_level_index.order);
+  lower_level_index.el = NULL;
+  lower_level_index.sorted_el = NULL;
+  lower_level_index.order = NULL;
+  lower_level_index.n = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the lower level energy index for the frequency ordered lines.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * This has to be called once the line columns have been built. Lines read
+ * without any level information have a lower level energy of zero.
+ *
+ * ************************************************************************** */
+
+int
+build_lower_level_index(void)
+{
+  int i, j, first, end;
+  LowerLevelIndex_t *index = &lower_level_index;
+
+  free_lower_level_index();
+
+  index->n = line_columns.nlines;
+  index->el = malloc((index->n + 1) * sizeof(double));
+  index->sorted_el = malloc((index->n + 1) * sizeof(double));
+  index->order = malloc((index->n + 1) * sizeof(int));
+  if(index->el == NULL || index->sorted_el == NULL || index->order == NULL)
+  {
+    free_lower_level_index();
+    return EXIT_FAILURE;
+  }
+
+  for(i = 0; i < index->n; ++i)
+    index->el[i] = lin_ptr[i]->el;
+
+  /*
+   * The buckets are short, so each is put into energy order with an insertion
+   * sort. Lines with the same energy stay in frequency order
+   */
+
+  for(first = 0; first < index->n; first += LOWER_LEVEL_BUCKET)
+  {
+    end = first + LOWER_LEVEL_BUCKET < index->n ? first + LOWER_LEVEL_BUCKET : index->n;
+    for(i = first; i < end; ++i)
+    {
+      for(j = i; j > first && index->sorted_el[j - 1] > index->el[i]; --j)
+      {
+        index->sorted_el[j] = index->sorted_el[j - 1];
+        index->order[j] = index->order[j - 1];
+      }
+      index->sorted_el[j] = index->el[i];
+      index->order[j] = i;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Check each line in a range of lines against the energy range.
+ *
+ * @return  The number of lines found, including those already found
+ *
+ * ************************************************************************** */
+
+static int
+scan_lower_level(int first, int end, double emin, double emax, int *found, int n)
+{
+  int i;
+  const double *el = lower_level_index.el;
+
+  for(i = first; i < end; ++i)
+  {
+    found[n] = i;
+    n += el[i] >= emin && el[i] <= emax;
+  }
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the lines in a whole bucket within the energy range.
+ *
+ * @return  The number of lines found, including those already found
+ *
+ * @details
+ *
+ * The lines are found in energy order, and marked in a bit mask of the bucket
+ * so they can be read back out in frequency order, lowest set bit first.
+ *
+ * ************************************************************************** */
+
+static int
+search_bucket(int first, double emin, double emax, int *found, int n)
+{
+  int i, lo, hi, mid;
+  unsigned long long mask = 0;
+  const double *sorted_el = lower_level_index.sorted_el;
+  const int *order = lower_level_index.order;
+
+  lo = first;
+  hi = first + LOWER_LEVEL_BUCKET;
+  while(lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if(sorted_el[mid] < emin)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  for(i = lo; i < first + LOWER_LEVEL_BUCKET && sorted_el[i] <= emax; ++i)
+    mask |= 1ULL << (order[i] - first);
+
+  for(; mask != 0; mask &= mask - 1)
+    found[n++] = first + __builtin_ctzll(mask);
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the lines within a frequency range whose lower level is within
+ *         an energy range.
+ *
+ * @param[in]   freqmin  The lowest frequency of the range
+ * @param[in]   freqmax  The highest frequency of the range
+ * @param[in]   emin     The lowest lower level energy in ergs
+ * @param[in]   emax     The highest lower level energy in ergs
+ * @param[out]  found    The position in lin_ptr of each line found, in
+ *                       frequency order, which needs room for every line in
+ *                       the frequency range
+ *
+ * @return  The number of lines found, or -1 if the index has not been built
+ *
+ * @details
+ *
+ * Both ranges include their ends, as with find_line_range().
+ *
+ * ************************************************************************** */
+
+int
+find_lines_by_lower_level(double freqmin, double freqmax, double emin, double emax, int *found)
+{
+  int n, bucket, bfirst, bend;
+  LineRange range;
+
+  if(lower_level_index.el == NULL || lower_level_index.n != line_columns.nlines)
+    return -1;
+
+  if(emax < emin)
+    return 0;
+
+  range = find_line_range(freqmin, freqmax);
+  bfirst = (range.first + LOWER_LEVEL_BUCKET - 1) / LOWER_LEVEL_BUCKET;
+  bend = range.end / LOWER_LEVEL_BUCKET;
+
+  if(bend <= bfirst)
+    return scan_lower_level(range.first, range.end, emin, emax, found, 0);
+
+  n = scan_lower_level(range.first, bfirst * LOWER_LEVEL_BUCKET, emin, emax, found, 0);
+  for(bucket = bfirst; bucket < bend; ++bucket)
+    n = search_bucket(bucket * LOWER_LEVEL_BUCKET, emin, emax, found, n);
+  n = scan_lower_level(bend * LOWER_LEVEL_BUCKET, range.end, emin, emax, found, n);
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the lower level energy index to a memory
+ *         table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * ************************************************************************** */
+
+void
+lower_level_index_memory(MemoryTable *table)
+{
+  const LowerLevelIndex_t *index = &lower_level_index;
+
+  if(index->el == NULL)
+    return;
+
+  account_memory(table, index->el, (index->n + 1) * sizeof(double), index->n * sizeof(double));
+  account_memory(table, index->sorted_el, (index->n + 1) * sizeof(double), index->n * sizeof(double));
+  account_memory(table, index->order, (index->n + 1) * sizeof(int), index->n * sizeof(int));
+}
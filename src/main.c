@@ -47,6 +47,7 @@ main(int argc, char *argv[])
   AtomixConfiguration.rows = AtomixConfiguration.cols = 0;
   AtomixConfiguration.current_line = AtomixConfiguration.current_col = 0;
   AtomixConfiguration.atomic_data_loaded = FALSE;
+  AtomixConfiguration.xsection_error = 0;
   AtomixConfiguration.atomic_data[0] = '\0';
   AtomixConfiguration.status_message[0] = '\0';
 
@@ -0,0 +1,439 @@
+/* ************************************************************************** */
+/**
+ * @file     memory.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Accounting of the memory taken by the atomic data.
+ *
+ * @details
+ *
+ * Each table of atomic data, and each index built over them, is reported as
+ * the bytes reserved for it, the bytes which hold data and the bytes which are
+ * resident in memory. The tables grow geometrically as the data is read in,
+ * and the gaunt factors are a static array sized for the largest data set, so
+ * the three can be very different. Resident pages are found with mincore(), so
+ * a page which is shared with another allocation counts as touched if it is
+ * resident.
+ *
+ * The resident set size of atomix is also recorded before the atomic data is
+ * read in, and its peak is reset, so the peak reported covers loading, or
+ * switching to, the current data set. On Linux this is read from /proc, and
+ * elsewhere only the peak over the whole run is known.
+ *
+ * ************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+#include "atomix.h"
+
+#define NMEMORY_TABLES 32
+
+#ifdef __APPLE__
+typedef char mincore_t;
+#else
+typedef unsigned char mincore_t;
+#endif
+
+static size_t rss_before = 0;   /* The resident set size before the atomic data was read in */
+static int peak_was_reset = FALSE;  /* If the peak resident set size was reset when rss_before was recorded */
+
+/* ************************************************************************** */
+/**
+ * @brief  Add a block of memory to a memory table.
+ *
+ * @param[in,out]  table     The memory table
+ * @param[in]      block     The start of the block
+ * @param[in]      reserved  The size of the block in bytes
+ * @param[in]      used      The bytes of the block which hold data
+ *
+ * @details
+ *
+ * The bytes touched are the bytes of the block in pages which are resident. If
+ * the pages cannot be checked, none of the block counts as touched.
+ *
+ * ************************************************************************** */
+
+void
+account_memory(MemoryTable *table, const void *block, size_t reserved, size_t used)
+{
+  size_t page, npages, k;
+  uintptr_t start, end, first, lo, hi;
+  mincore_t *resident;
+
+  table->reserved += reserved;
+  table->used += used;
+
+  if(block == NULL || reserved == 0)
+    return;
+
+  page = (size_t) sysconf(_SC_PAGESIZE);
+  start = (uintptr_t) block;
+  end = start + reserved;
+  first = start / page * page;
+  npages = (end - first + page - 1) / page;
+
+  if((resident = malloc(npages)) == NULL)
+    return;
+
+  if(mincore((void *) first, npages * page, resident) == 0)
+  {
+    for(k = 0; k < npages; ++k)
+    {
+      if(!(resident[k] & 1))
+        continue;
+      lo = first + k * page > start ? first + k * page : start;
+      hi = first + (k + 1) * page < end ? first + (k + 1) * page : end;
+      table->touched += hi - lo;
+    }
+  }
+
+  free(resident);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read a value in kB from /proc/self/status.
+ *
+ * @param[in]  key  The name of the value, such as VmRSS
+ *
+ * @return  The value in bytes, or 0 if it could not be read
+ *
+ * ************************************************************************** */
+
+static size_t
+read_proc_status(const char *key)
+{
+  FILE *f;
+  char line[LINELEN];
+  unsigned long kb = 0;
+  size_t len = strlen(key);
+
+  if((f = fopen("/proc/self/status", "r")) == NULL)
+    return 0;
+
+  while(fgets(line, LINELEN, f) != NULL)
+  {
+    if(strncmp(line, key, len) == 0 && line[len] == ':')
+    {
+      sscanf(line + len + 1, "%lu", &kb);
+      break;
+    }
+  }
+
+  fclose(f);
+
+  return kb * 1024;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the peak resident set size.
+ *
+ * @return  The peak resident set size in bytes
+ *
+ * @details
+ *
+ * If the peak could not be read from /proc, the peak over the whole run from
+ * getrusage() is used instead.
+ *
+ * ************************************************************************** */
+
+static size_t
+peak_rss(void)
+{
+  size_t peak;
+  struct rusage usage;
+
+  if((peak = read_proc_status("VmHWM")) > 0)
+    return peak;
+
+  if(getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+
+#ifdef __APPLE__
+  return (size_t) usage.ru_maxrss;
+#else
+  return (size_t) usage.ru_maxrss * 1024;
+#endif
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Record the resident set size before the atomic data is read in, and
+ *         reset its peak.
+ *
+ * @details
+ *
+ * Writing 5 to /proc/self/clear_refs resets the peak to the current resident
+ * set size. This has to be called at the start of get_atomic_data().
+ *
+ * ************************************************************************** */
+
+void
+start_memory_accounting(void)
+{
+  FILE *f;
+
+  peak_was_reset = FALSE;
+  if((f = fopen("/proc/self/clear_refs", "w")) != NULL)
+  {
+    peak_was_reset = fputs("5", f) >= 0;
+    peak_was_reset = fclose(f) == 0 && peak_was_reset;
+  }
+
+  rss_before = read_proc_status("VmRSS");
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Start a new row of the memory tables.
+ *
+ * @param[in,out]  tables   The memory tables
+ * @param[in,out]  ntables  The number of memory tables
+ * @param[in]      name     The name of the new table
+ *
+ * @return  The new table
+ *
+ * ************************************************************************** */
+
+static MemoryTable *
+new_memory_table(MemoryTable *tables, int *ntables, const char *name)
+{
+  MemoryTable *table = &tables[(*ntables)++];
+
+  table->name = name;
+  table->reserved = table->used = table->touched = 0;
+
+  return table;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Work out the memory taken by each table of atomic data and each
+ *         index.
+ *
+ * @param[out]  tables  The memory tables, which needs room for NMEMORY_TABLES
+ *
+ * @return  The number of memory tables
+ *
+ * @details
+ *
+ * The gaunt factors count as used up to the number of entries read in. The
+ * inner shell cross sections are counted with the inner shell tables, and
+ * their points with the other cross section points.
+ *
+ * ************************************************************************** */
+
+static int
+collect_memory(MemoryTable *tables)
+{
+  int kind, ntables = 0;
+  MemoryTable *t;
+
+  t = new_memory_table(tables, &ntables, "Elements");
+  account_memory(t, ele, NELEMENTS * sizeof(ele_dummy), nelements * sizeof(ele_dummy));
+
+  t = new_memory_table(tables, &ntables, "Ions");
+  account_memory(t, ions, nions_max * sizeof(ion_dummy), nions * sizeof(ion_dummy));
+  t = new_memory_table(tables, &ntables, "Ion links");
+  account_memory(t, ion_links, nions_max * sizeof(ion_links_dummy), nions * sizeof(ion_links_dummy));
+  t = new_memory_table(tables, &ntables, "Ground state fractions");
+  account_memory(t, ground_frac, nions_max * sizeof(struct ground_fracs), nions * sizeof(struct ground_fracs));
+
+  t = new_memory_table(tables, &ntables, "Levels");
+  account_memory(t, config, nlevels_max * sizeof(config_dummy), nlevels * sizeof(config_dummy));
+  t = new_memory_table(tables, &ntables, "Macro atom jumps");
+  for(kind = 0; kind < NMACRO_JUMPS; ++kind)
+    account_memory(t, macro_jumps[kind], macro_jumps[kind] != NULL ? (nmacro_jumps[kind] + 1) * sizeof(int) : 0,
+                   nmacro_jumps[kind] * sizeof(int));
+
+  t = new_memory_table(tables, &ntables, "Lines");
+  account_memory(t, line, nlines_max * sizeof(line_dummy), nlines * sizeof(line_dummy));
+  t = new_memory_table(tables, &ntables, "Line links");
+  account_memory(t, line_links, nlines_max * sizeof(line_links_dummy), nlines * sizeof(line_links_dummy));
+  t = new_memory_table(tables, &ntables, "Line pointers");
+  account_memory(t, lin_ptr, nlines_max * sizeof(LinePtr), nlines * sizeof(LinePtr));
+  t = new_memory_table(tables, &ntables, "Collision strengths");
+  account_memory(t, coll_stren, n_coll_stren_max * sizeof(Coll_stren), n_coll_stren * sizeof(Coll_stren));
+
+  t = new_memory_table(tables, &ntables, "Photoionization");
+  account_memory(t, phot_top, nphot_max * sizeof(Topbase_phot), nphot_total * sizeof(Topbase_phot));
+  account_memory(t, phot_top_ptr, nphot_max * sizeof(TopPhotPtr), nphot_total * sizeof(TopPhotPtr));
+  t = new_memory_table(tables, &ntables, "Inner shell");
+  account_memory(t, inner_cross, n_inner_max * sizeof(Topbase_phot), n_inner_tot * sizeof(Topbase_phot));
+  account_memory(t, inner_cross_ptr, n_inner_max * sizeof(TopPhotPtr), n_inner_tot * sizeof(TopPhotPtr));
+  account_memory(t, inner_elec_yield, n_inner_max * sizeof(Inner_elec_yield), n_inner_tot * sizeof(Inner_elec_yield));
+  account_memory(t, inner_fluor_yield, n_inner_max * sizeof(Inner_fluor_yield), 0);
+  t = new_memory_table(tables, &ntables, "Cross section points");
+  account_memory(t, xsection_freq, nxsection_points_max * sizeof(double), nxsection_points * sizeof(double));
+  account_memory(t, xsection_x, nxsection_points_max * sizeof(double), nxsection_points * sizeof(double));
+  packed_xsections_memory(t);
+
+  t = new_memory_table(tables, &ntables, "Rate data");
+  account_memory(t, drecomb, ndrecomb_max * sizeof(Drecomb), ndrecomb * sizeof(Drecomb));
+  account_memory(t, total_rr, n_total_rr_max * sizeof(Total_rr), n_total_rr * sizeof(Total_rr));
+  account_memory(t, bad_gs_rr, n_bad_gs_rr_max * sizeof(Bad_gs_rr), n_bad_gs_rr * sizeof(Bad_gs_rr));
+  account_memory(t, dere_di_rate, n_dere_di_rate_max * sizeof(Dere_di_rate), n_dere_di_rate * sizeof(Dere_di_rate));
+  account_memory(t, gaunt_total, sizeof(gaunt_total), gaunt_n_gsqrd * sizeof(Gaunt_total));
+
+  lookup_tables_memory(new_memory_table(tables, &ntables, "Lookup tables"));
+  line_columns_memory(new_memory_table(tables, &ntables, "Line columns"));
+  posting_lists_memory(new_memory_table(tables, &ntables, "Posting lists"));
+  species_stats_memory(new_memory_table(tables, &ntables, "Species totals"));
+  strongest_index_memory(new_memory_table(tables, &ntables, "Strongest lines"));
+  coverage_index_memory(new_memory_table(tables, &ntables, "Cross section coverage"));
+  lower_level_index_memory(new_memory_table(tables, &ntables, "Lower level energies"));
+  level_links_memory(new_memory_table(tables, &ntables, "Level links"));
+
+  return ntables;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Write the header of the memory table.
+ *
+ * @param[out]  row  The header
+ * @param[in]   len  The size of row
+ *
+ * ************************************************************************** */
+
+void
+memory_report_header(char *row, size_t len)
+{
+  snprintf(row, len, " %-24s %-14s %-14s %s", "Table", "Reserved (Mb)", "Used (Mb)", "Touched (Mb)");
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Write the row of the memory table for one table.
+ *
+ * @param[out]  row    The row
+ * @param[in]   len    The size of row
+ * @param[in]   table  The memory table
+ *
+ * ************************************************************************** */
+
+void
+memory_report_row(char *row, size_t len, const MemoryTable *table)
+{
+  snprintf(row, len, " %-24s %-14.3f %-14.3f %.3f", table->name, 1e-6 * table->reserved, 1e-6 * table->used,
+           1e-6 * table->touched);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Write the memory report, one row at a time.
+ *
+ * @param[in]  add_row  The function each row is given to
+ *
+ * @details
+ *
+ * The report is the memory table, with the total of every table, followed by
+ * the resident set size before and after the atomic data was read in and its
+ * peak.
+ *
+ * ************************************************************************** */
+
+static void
+write_memory_report(void (*add_row)(const char *row))
+{
+  int i, ntables;
+  char row[2 * LINELEN];
+  MemoryTable tables[NMEMORY_TABLES + 1];
+  MemoryTable total = { "Total", 0, 0, 0 };
+
+  ntables = collect_memory(tables);
+
+  memory_report_header(row, sizeof(row));
+  add_row(row);
+  for(i = 0; i < ntables; ++i)
+  {
+    memory_report_row(row, sizeof(row), &tables[i]);
+    add_row(row);
+    total.reserved += tables[i].reserved;
+    total.used += tables[i].used;
+    total.touched += tables[i].touched;
+  }
+  memory_report_row(row, sizeof(row), &total);
+  add_row(row);
+
+  add_row("");
+  if(rss_before > 0)
+  {
+    snprintf(row, sizeof(row), " Resident set size: %.2f Mb before loading, %.2f Mb now", 1e-6 * rss_before,
+             1e-6 * read_proc_status("VmRSS"));
+    add_row(row);
+  }
+  snprintf(row, sizeof(row), " Peak resident set size: %.2f Mb %s", 1e-6 * peak_rss(),
+           peak_was_reset ? "while loading" : "since atomix started");
+  add_row(row);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add a row of the memory report to the atomic summary.
+ *
+ * ************************************************************************** */
+
+static void
+summary_row(const char *row)
+{
+  atomic_summary_add("%s", row);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print a row of the memory report to stdout.
+ *
+ * ************************************************************************** */
+
+static void
+print_row(const char *row)
+{
+  printf("%s\n", row);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory report to the atomic summary.
+ *
+ * @details
+ *
+ * This has to be called once the atomic data has been read in and the
+ * snapshot saved, so the report is not stored in the snapshot.
+ *
+ * ************************************************************************** */
+
+void
+memory_summary(void)
+{
+  atomic_summary_add("Memory used by the atomic data");
+  write_memory_report(summary_row);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the memory report to stdout, for when atomix is run without
+ *         the UI.
+ *
+ * @return  EXIT_SUCCESS
+ *
+ * ************************************************************************** */
+
+int
+headless_memory_report(void)
+{
+  printf("Memory used by the atomic data\n\n");
+  write_memory_report(print_row);
+
+  return EXIT_SUCCESS;
+}
@@ -31,6 +31,10 @@ MenuItem_t BOUND_MENU_CHOICES[] = {
   {&bound_bound_wavelength_range, 1, "By wavelength range", "Print the transitions over a given wavelength range"},
   {&bound_bound_element, 2, "By element", "Print all the transitions for a given element"},
   {&bound_bound_ion, 3, "By ion number", "Print all the transitions for a given ion"},
+  {&bound_bound_strongest, 4, "Strongest by wavelength range",
+   "Print the strongest transitions over a given wavelength range"},
+  {&bound_bound_lower_level, 5, "By wavelength and lower level energy",
+   "Print the transitions over a wavelength range with a lower level in an energy range"},
   {NULL, MENU_QUIT, "Return to main menu", ""}
 };
 
@@ -40,6 +44,10 @@ MenuItem_t BOUND_FREE_MENU_CHOICES[] = {
   {&bound_free_wavelength_range, 1, "By wavelength range", "Print the transitions over a given wavelength range"},
   {&bound_free_element, 2, "By element", "Print all the transitions for a given element"},
   {&bound_free_ion, 3, "By ion number", "Print all the transitions for a given ion"},
+  {&bound_free_active_wavelength, 4, "Active at wavelength",
+   "Print the cross sections which are non-zero at a wavelength"},
+  {&bound_free_active_range, 5, "Active over wavelength range",
+   "Print the cross sections which are non-zero over a wavelength range"},
   {NULL, MENU_QUIT, "Return to main menu", ""}
 };
 
@@ -49,6 +57,10 @@ MenuItem_t INNER_SHELL_MENU_CHOICES[] = {
   {&inner_shell_wavelength_range, 1, "By wavelength range", "Print the transitions over a given wavelength range"},
   {&inner_shell_element, 2, "By element", "Print all the transitions for a given element"},
   {&inner_shell_ion, 3, "By ion number", "Print all the transitions for a given ion"},
+  {&inner_shell_active_wavelength, 4, "Active at wavelength",
+   "Print the cross sections which are non-zero at a wavelength"},
+  {&inner_shell_active_range, 5, "Active over wavelength range",
+   "Print the cross sections which are non-zero over a wavelength range"},
   {NULL, MENU_QUIT, "Return to main menu", ""}
 };
 
@@ -56,6 +68,7 @@ MenuItem_t INNER_SHELL_MENU_CHOICES[] = {
 MenuItem_t ELEMENTS_MENU_CHOICES[] = {
   {&all_elements, 0, "All elements", "Query all elements in the atomic data"},
   {&single_element, 1, "Single element", "Query a single element"},
+  {&elements_summary, 2, "Summary", "Line and edge totals for every element, sorted"},
   {NULL, MENU_QUIT, "Return to main menu", ""},
 };
 
@@ -66,6 +79,7 @@ MenuItem_t IONS_MENU_CHOICES[] = {
   {&single_ion_atomic_z, 2, "By atomic and ionisation state",
    "Detailed output for a single ion by atomic number and ionisation state"},
   {&single_ion_nion, 3, "By ion number", "Detailed output for a single ion by ion number"},
+  {&ions_summary, 4, "Summary", "Line and edge totals for every ion, sorted"},
   {NULL, MENU_QUIT, "Return to main menu", ""},
 };
 
@@ -76,5 +90,6 @@ MenuItem_t LEVELS_MENU_CHOICES[] = {
   {NULL, 2, "By atomic number and ionisation state", ""},
   {NULL, 3, "By ion number", ""},
   {NULL, 4, "By level density", ""},
+  {&level_transitions, 5, "Transitions for a level", "Print every transition into or out of a level"},
   {NULL, MENU_QUIT, "Return to main menu", ""}
 };
@@ -26,23 +26,36 @@
  *
  * @details
  *
- * Quick and dirty method to parse the command line arguments. atomix either
- * expects ONE or NO arguments. If one argument is provided, this is assumed
- * to be the file name for the atomic data and it will subsequently be loaded
- * in. If we cannot read the atomic data, then atomix will exit.
+ * Quick and dirty method to parse the command line arguments. atomix expects
+ * at most one positional argument. If it is provided, this is assumed to be
+ * the file name for the atomic data and it will subsequently be loaded in. If
+ * we cannot read the atomic data, then atomix will exit.
+ *
+ * With -c, the photoionization and inner shell cross sections are stored
+ * compactly within the relative error given, see compact_xsections().
+ *
+ * If a file of spectral windows is given with -w, or a summary is asked for
+ * with -s, atomix runs headless: the lines and edges in each window, or the
+ * line and edge totals of every element and ion, are printed and atomix exits
+ * without starting the UI. The same goes for --mem-report, which prints the
+ * memory taken by each table of atomic data, see memory_summary().
  *
  * This function is called before ncurses is initialised, thus printf should be
  * used instead when expanding it.
  *
- * TODO: better way to parse command line for multiple arguments
- *
  * ************************************************************************** */
 
 int
 check_command_line(int argc, char **argv)
 {
+  int i;
   int provided = false;
   int atomic_data_error;
+  int stats_order = -1;
+  int mem_report = false;
+  double velocity = 0;
+  char *windows_file = NULL;
+  char *end;
   char atomic_data_name[LINELEN];
 
   char help[] =
@@ -50,19 +63,92 @@ check_command_line(int argc, char **argv)
     "Python is required to be installed correctly for atomix to work.\n"
     "\nTo test atomix, one can load the standard80_test test data.\n\n"
     "Usage:\n"
-    "   atomix [-h] [atomic_data]\n\n"
+    "   atomix [-h] [-c error] [-w windows [-v velocity]] [-s order] [--mem-report]\n"
+    "          [atomic_data]\n\n"
     "   atomic_data  [optional]  the name of the atomic data to explore\n"
-    "   h            [optional]  print this help message\n";
+    "   h            [optional]  print this help message\n"
+    "   c            [optional]  store the photoionization and inner shell cross\n"
+    "                            sections compactly, with every point within this\n"
+    "                            relative error, such as 1e-4\n"
+    "   w            [optional]  print the lines and edges in each spectral window\n"
+    "                            listed in the file windows, then exit\n"
+    "   v            [optional]  widen each window by this velocity in km/s\n"
+    "   s            [optional]  print the line and edge totals of every element\n"
+    "                            and ion, sorted by order, then exit. order is one\n"
+    "                            of index, lines, gf, macro, coll or edges\n"
+    "   mem-report   [optional]  print the memory reserved, used and touched by\n"
+    "                            each table of atomic data and the peak resident\n"
+    "                            set size while loading it, then exit\n\n"
+    "Each line of a windows file is a window in Angstroms, given as\n"
+    "   wavelength [wavelength_max [velocity]]\n"
+    "The headless modes require atomic_data to be given.\n\n"
+    "Parsed atomic data is cached in $ATOMIX_CACHE_DIR, or $HOME/.cache/atomix by\n"
+    "default. Set ATOMIX_CACHE_DIR to an empty string to disable the cache.\n";
+
+  atomic_data_name[0] = '\0';
+
+  for(i = 1; i < argc; ++i)
+  {
+    if(strncmp(argv[i], "-h", 2) == 0)
+    {
+      printf("%s", help);
+      exit(EXIT_SUCCESS);
+    }
+    else if(strcmp(argv[i], "--mem-report") == 0)
+    {
+      mem_report = true;
+    }
+    else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+    {
+      AtomixConfiguration.xsection_error = strtod(argv[++i], &end);
+      if(*end != '\0' || !(AtomixConfiguration.xsection_error > 0 && AtomixConfiguration.xsection_error < 1))
+      {
+        printf("Invalid cross section error %s\n", argv[i]);
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if(strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+    {
+      windows_file = argv[++i];
+    }
+    else if(strcmp(argv[i], "-v") == 0 && i + 1 < argc)
+    {
+      velocity = strtod(argv[++i], &end);
+      if(*end != '\0' || velocity < 0)
+      {
+        printf("Invalid velocity width %s\n", argv[i]);
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+    {
+      if((stats_order = stats_order_from_name(argv[++i])) < 0)
+      {
+        printf("Unknown summary order %s\n", argv[i]);
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if(argv[i][0] != '-' && atomic_data_name[0] == '\0' && strlen(argv[i]) < LINELEN - 4)
+    {
+      strcpy(atomic_data_name, argv[i]);
+    }
+    else
+    {
+      printf("Unknown arguments. Seek help!\n");
+      printf("\n%s", help);
+      exit(EXIT_FAILURE);
+    }
+  }
 
-  if(argc == 2 && strncmp(argv[1], "-h", 2) == 0)
+  if((windows_file != NULL || stats_order >= 0 || mem_report) && atomic_data_name[0] == '\0')
   {
-    printf("%s", help);
-    exit(EXIT_SUCCESS);
+    printf("The atomic data has to be given to run without the UI\n");
+    exit(EXIT_FAILURE);
   }
-  else if(argc == 2)
+
+  if(atomic_data_name[0] != '\0')
   {
-    strcpy(atomic_data_name, argv[1]);
-    if(strcmp(&atomic_data_name[strlen(atomic_data_name) - 4], ".dat") != 0)
+    if(strlen(atomic_data_name) < 4 || strcmp(&atomic_data_name[strlen(atomic_data_name) - 4], ".dat") != 0)
       strcat(atomic_data_name, ".dat");
 
     atomic_data_error = get_atomic_data(atomic_data_name, false);
@@ -77,11 +163,18 @@ check_command_line(int argc, char **argv)
     provided = true;
     strcpy(AtomixConfiguration.atomic_data, atomic_data_name);
   }
-  else if(argc > 2)
+
+  if(windows_file != NULL || stats_order >= 0 || mem_report)
   {
-    printf("Unknown arguments. Seek help!\n");
-    printf("\n%s", help);
-    exit(EXIT_FAILURE);
+    atomic_data_error = EXIT_SUCCESS;
+    if(windows_file != NULL)
+      atomic_data_error = headless_window_lookup(windows_file, velocity);
+    if(stats_order >= 0 && atomic_data_error == EXIT_SUCCESS)
+      atomic_data_error = headless_species_summary(stats_order);
+    if(mem_report && atomic_data_error == EXIT_SUCCESS)
+      atomic_data_error = headless_memory_report();
+    logfile_close();
+    exit(atomic_data_error);
   }
 
   return provided;
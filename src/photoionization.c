@@ -140,6 +140,39 @@ bound_free_wavelength_range(void)
   display_show(SCROLL_ENABLE, true, 4);
 }
 
+/* ************************************************************************** */
+/**
+ * @brief  Print the photoionization cross sections which are non-zero at a
+ *         wavelength.
+ *
+ * @details
+ *
+ * The wavelength is queried within active_xsections(), which also shows the
+ * value of each cross section at the wavelength.
+ *
+ * ************************************************************************** */
+
+void
+bound_free_active_wavelength(void)
+{
+  active_xsections(XSECTION_PHOT, TRUE);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the photoionization cross sections which are non-zero anywhere over a
+ *         wavelength range.
+ *
+ * @details
+ *
+ * ************************************************************************** */
+
+void
+bound_free_active_range(void)
+{
+  active_xsections(XSECTION_PHOT, FALSE);
+}
+
 /* ************************************************************************** */
 /**
  * @brief  Print all the bound free edges for an element.
@@ -151,8 +184,8 @@ bound_free_wavelength_range(void)
 void
 bound_free_element(void)
 {
-  int n, z;
-  int nphot;
+  int i, n, z;
+  const int *entries;
   char element[LINELEN];
 
   if(query_atomic_number(&z) == FORM_QUIT)
@@ -166,15 +199,9 @@ bound_free_element(void)
   add_sep_display(ndash);
   bound_free_header();
 
-  n = 0;
-  for(nphot = 0; nphot < nphot_total; ++nphot)
-  {
-    if(phot_top[nphot].z == z)
-    {
-      bound_free_line(nphot);
-      n++;
-    }
-  }
+  n = find_postings(POSTING_PHOT, z, 0, &entries);
+  for(i = 0; i < n; ++i)
+    bound_free_line(phot_top_ptr[entries[i]] - phot_top);
 
   count(ndash, n);
 
@@ -193,7 +220,8 @@ void
 bound_free_ion(void)
 {
   int z, istate;
-  int n, nion, nphot;
+  int i, n, nion;
+  const int *entries;
   char element[LINELEN];
 
   if(query_ion_input(TRUE, NULL, NULL, &nion) == FORM_QUIT)
@@ -216,15 +244,9 @@ bound_free_ion(void)
   add_sep_display(ndash);
   bound_free_header();
 
-  n = 0;
-  for(nphot = 0; nphot < nphot_total; ++nphot)
-  {
-    if(phot_top[nphot].z == z && phot_top[nphot].istate == istate)
-    {
-      bound_free_line(nphot);
-      n++;
-    }
-  }
+  n = find_postings(POSTING_PHOT, z, istate, &entries);
+  for(i = 0; i < n; ++i)
+    bound_free_line(phot_top_ptr[entries[i]] - phot_top);
 
   count(ndash, n);
 
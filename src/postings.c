@@ -0,0 +1,302 @@
+/* ************************************************************************** */
+/**
+ * @file     postings.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Posting lists of the lines and photoionization edges of each element and
+ * ion.
+ *
+ * @details
+ *
+ * Finding the lines or edges of one element or ion used to mean comparing the
+ * z and istate of every entry in the frequency ordered lists. Instead, the
+ * positions of the entries for each element and ion are grouped together once
+ * the atomic data has been put into frequency order, so a view only has to
+ * look at the entries it is going to show.
+ *
+ * Each set of posting lists is stored as one array of positions, with a second
+ * array giving where the list of each element or ion starts. The positions are
+ * put in with a counting sort over the frequency ordered list, so each posting
+ * list is also in frequency order.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+
+#include "atomix.h"
+
+typedef struct PostingList_t
+{
+  int nkeys;                    /* The number of elements or ions */
+  int *start;                   /* Where the list of each key starts, with an extra entry for the end */
+  int *entries;                 /* The positions in frequency order */
+} PostingList_t;
+
+static PostingList_t element_postings[NPOSTING_KINDS];
+static PostingList_t ion_postings[NPOSTING_KINDS];
+
+/* ************************************************************************** */
+/**
+ * @brief  Free a set of posting lists.
+ *
+ * @param[in,out]  list  The posting lists to free
+ *
+ * ************************************************************************** */
+
+static void
+free_posting_list(PostingList_t *list)
+{
+  free(list->start);
+  free(list->entries);
+  list->start = NULL;
+  list->entries = NULL;
+  list->nkeys = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Free all of the posting lists.
+ *
+ * ************************************************************************** */
+
+void
+free_posting_lists(void)
+{
+  int kind;
+
+  for(kind = 0; kind < NPOSTING_KINDS; ++kind)
+  {
+    free_posting_list(&element_postings[kind]);
+    free_posting_list(&ion_postings[kind]);
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the number of entries in a frequency ordered list, and the
+ *         atomic number and ionization state of one of them.
+ *
+ * @param[in]   kind    The frequency ordered list
+ * @param[in]   i       The position of the entry, or -1 to only get the number
+ *                      of entries
+ * @param[out]  z       The atomic number of the entry
+ * @param[out]  istate  The ionization state of the entry
+ *
+ * @return  The number of entries in the list
+ *
+ * ************************************************************************** */
+
+static int
+posting_source(int kind, int i, int *z, int *istate)
+{
+  switch(kind)
+  {
+  case POSTING_LINES:
+    if(i >= 0)
+    {
+      *z = line_columns.z[i];
+      *istate = line_columns.istate[i];
+    }
+    return line_columns.nlines;
+  case POSTING_PHOT:
+    if(i >= 0)
+    {
+      *z = phot_top_ptr[i]->z;
+      *istate = phot_top_ptr[i]->istate;
+    }
+    return nphot_total;
+  case POSTING_INNER:
+    if(i >= 0)
+    {
+      *z = inner_cross_ptr[i]->z;
+      *istate = inner_cross_ptr[i]->istate;
+    }
+    return n_inner_tot;
+  default:
+    return 0;
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the posting lists of one frequency ordered list.
+ *
+ * @param[in]   kind     The frequency ordered list
+ * @param[in]   nkeys    The number of elements or ions
+ * @param[in]   by_ion   TRUE to make a list for each ion, otherwise a list for
+ *                       each element
+ * @param[out]  list     The posting lists
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * The key of an entry is the element or ion which element_index() or
+ * ion_index() finds for its z and istate, so a posting list holds the same
+ * entries as a search of the list on z and istate would. Entries which do not
+ * belong to any element or ion are left out.
+ *
+ * ************************************************************************** */
+
+static int
+build_posting_list(int kind, int nkeys, int by_ion, PostingList_t *list)
+{
+  int i, n, key;
+  int z = 0, istate = 0;
+  int *keys;
+
+  n = posting_source(kind, -1, NULL, NULL);
+
+  list->nkeys = nkeys;
+  list->start = calloc(nkeys + 1, sizeof(int));
+  list->entries = malloc((n + 1) * sizeof(int));
+  keys = malloc((n + 1) * sizeof(int));
+
+  if(list->start == NULL || list->entries == NULL || keys == NULL)
+  {
+    free(keys);
+    free_posting_list(list);
+    return EXIT_FAILURE;
+  }
+
+  /*
+   * Count the entries for each key, then turn the counts into where each list
+   * ends. Putting each entry in at the end of its list and moving the end back
+   * leaves start pointing at the first entry of each list
+   */
+
+  for(i = 0; i < n; ++i)
+  {
+    posting_source(kind, i, &z, &istate);
+    key = by_ion ? ion_index(z, istate) : element_index(z);
+    keys[i] = key;
+    if(key >= 0 && key < nkeys)
+      list->start[key]++;
+  }
+
+  for(key = 1; key <= nkeys; ++key)
+    list->start[key] += list->start[key - 1];
+
+  for(i = n - 1; i >= 0; --i)
+    if(keys[i] >= 0 && keys[i] < nkeys)
+      list->entries[--list->start[keys[i]]] = i;
+
+  free(keys);
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the posting lists for every element and ion.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * This has to be called once the lookup tables and line columns have been
+ * built, and again whenever the frequency ordered lists change.
+ *
+ * ************************************************************************** */
+
+int
+build_posting_lists(void)
+{
+  int kind;
+
+  free_posting_lists();
+
+  for(kind = 0; kind < NPOSTING_KINDS; ++kind)
+  {
+    if(build_posting_list(kind, nelements, FALSE, &element_postings[kind]) ||
+       build_posting_list(kind, nions, TRUE, &ion_postings[kind]))
+    {
+      free_posting_lists();
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the lines or photoionization edges of an element or ion.
+ *
+ * @param[in]   kind     The frequency ordered list to search
+ * @param[in]   z        The atomic number of the element
+ * @param[in]   istate   The ionization state of the ion, or a value less than
+ *                       1 for everything belonging to the element
+ * @param[out]  entries  The positions in the frequency ordered list of each
+ *                       entry found, in frequency order
+ *
+ * @return  The number of entries found
+ *
+ * @details
+ *
+ * entries points into the posting lists, so must not be freed and is only good
+ * until the posting lists are next built.
+ *
+ * ************************************************************************** */
+
+int
+find_postings(int kind, int z, int istate, const int **entries)
+{
+  int key;
+  PostingList_t *list;
+
+  *entries = NULL;
+
+  if(kind < 0 || kind >= NPOSTING_KINDS)
+    return 0;
+
+  if(istate < 1)
+  {
+    list = &element_postings[kind];
+    key = element_index(z);
+  }
+  else
+  {
+    list = &ion_postings[kind];
+    key = ion_index(z, istate);
+  }
+
+  if(key < 0 || key >= list->nkeys || list->start == NULL)
+    return 0;
+
+  *entries = list->entries + list->start[key];
+
+  return list->start[key + 1] - list->start[key];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the posting lists to a memory table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * ************************************************************************** */
+
+void
+posting_lists_memory(MemoryTable *table)
+{
+  int kind, by_ion, n;
+  PostingList_t *list;
+
+  for(kind = 0; kind < NPOSTING_KINDS; ++kind)
+  {
+    for(by_ion = 0; by_ion < 2; ++by_ion)
+    {
+      list = by_ion ? &ion_postings[kind] : &element_postings[kind];
+      if(list->start == NULL)
+        continue;
+
+      n = posting_source(kind, -1, NULL, NULL);
+      account_memory(table, list->start, (list->nkeys + 1) * sizeof(int), (list->nkeys + 1) * sizeof(int));
+      account_memory(table, list->entries, (n + 1) * sizeof(int), list->start[list->nkeys] * sizeof(int));
+    }
+  }
+}
@@ -34,6 +34,22 @@ MenuItem_t ATOMIC_DATA_CHOICES[] = {
   {NULL, INDEX_OTHER, "Other", ": Custom data, needs to be in $PYTHON/xdata"}
 };
 
+// const
+MenuItem_t STATS_ORDER_CHOICES[] = {
+  {NULL, STATS_BY_INDEX, "Index", ": The order in the atomic data"},
+  {NULL, STATS_BY_LINES, "Lines", ": The most lines first"},
+  {NULL, STATS_BY_GF, "Sum of gf", ": The largest sum of gf first"},
+  {NULL, STATS_BY_MACRO, "Macro atom lines", ": The most macro atom lines first"},
+  {NULL, STATS_BY_COLL, "Collision strengths", ": The most lines with a collision strength first"},
+  {NULL, STATS_BY_EDGES, "Edges", ": The most photoionization and inner shell edges first"},
+};
+
+// const
+MenuItem_t STRENGTH_CHOICES[] = {
+  {NULL, STRENGTH_GF, "gf", ": The oscillator strength times the lower level multiplicity"},
+  {NULL, STRENGTH_A21, "A21", ": The Einstein A coefficient"},
+};
+
 /* ************************************************************************** */
 /**
  * @brief  Clean up a form.
@@ -317,6 +333,51 @@ init_two_question_form(Query_t *q, char *label1, char *label2, char *answer1, ch
   q[3].background = A_REVERSE;
 }
 
+/* ************************************************************************** */
+/**
+ * @brief  Initialise a Query_t object for a form to query any number of
+ *         inputs.
+ *
+ * @param[out]  q           The Query_t object to initialise, which needs
+ *                          2 * nquestions entries
+ * @param[in]   nquestions  The number of questions to ask
+ * @param[in]   labels      The label for each question
+ * @param[in]   answers     The default answer for each question
+ *
+ * @details
+ *
+ * The questions are laid out as in init_two_question_form, with the label and
+ * answer for question i in q[2 * i] and q[2 * i + 1].
+ *
+ * ************************************************************************** */
+
+void
+init_multi_question_form(Query_t *q, int nquestions, char **labels, char **answers)
+{
+  int i;
+  int label_len = 0;
+
+  for(i = 0; i < nquestions; ++i)
+    label_len = MAX(label_len, (int) strlen(labels[i]));
+
+  for(i = 0; i < nquestions; ++i)
+  {
+    q[2 * i].buffer_number = 0;
+    strcpy(q[2 * i].buffer, labels[i]);
+    q[2 * i].field = new_field(1, label_len, 2 * i, 0, 0, 0);
+    q[2 * i].opts_off = FIELD_SKIP;
+    q[2 * i].opts_on = O_VISIBLE | O_PUBLIC | O_AUTOSKIP;
+    q[2 * i].background = FIELD_NO_BKG;
+
+    q[2 * i + 1].buffer_number = 0;
+    strcpy(q[2 * i + 1].buffer, answers[i]);
+    q[2 * i + 1].field = new_field(1, FIELD_INPUT_LEN, 2 * i, label_len + 2, 0, 0);
+    q[2 * i + 1].opts_off = O_AUTOSKIP;
+    q[2 * i + 1].opts_on = O_VISIBLE | O_PUBLIC | O_EDIT | O_ACTIVE;
+    q[2 * i + 1].background = A_REVERSE;
+  }
+}
+
 /* ************************************************************************** */
 /**
  * @brief  Get the wavelength range to consider.
@@ -379,6 +440,119 @@ query_wavelength_range(double *wmin, double *wmax)
   return EXIT_SUCCESS;
 }
 
+/* ************************************************************************** */
+/**
+ * @brief  Get a wavelength range and a range of lower level energies.
+ *
+ * @param[out]  wmin  The smallest wavelength transition to find
+ * @param[out]  wmax  The largest wavelength transition to find
+ * @param[out]  emin  The lowest lower level energy in eV
+ * @param[out]  emax  The highest lower level energy in eV
+ *
+ * @details
+ *
+ * All four limits are asked for in one form. This keeps looping until the
+ * user quits or the input is correct; i.e., wmin < wmax and emin <= emax. The
+ * previous answers are remembered.
+ *
+ * ************************************************************************** */
+
+int
+query_wavelength_energy_range(double *wmin, double *wmax, double *emin, double *emax)
+{
+  int form_return;
+  int valid_input = false;
+  WINDOW *window = CONTENT_VIEW_WINDOW.window;
+
+  static char string_wmin[FIELD_INPUT_LEN] = "";
+  static char string_wmax[FIELD_INPUT_LEN] = "";
+  static char string_emin[FIELD_INPUT_LEN] = "0";
+  static char string_emax[FIELD_INPUT_LEN] = "";
+  static Query_t range_query[8];
+
+  char *labels[] = { "Minimum Wavelength : ", "Maximum Wavelength : ", "Minimum Lower Level Energy (eV) : ",
+    "Maximum Lower Level Energy (eV) : "
+  };
+  char *answers[] = { string_wmin, string_wmax, string_emin, string_emax };
+
+  while(valid_input == false)
+  {
+    wclear(window);
+    init_multi_question_form(range_query, 4, labels, answers);
+    form_return = query_user(CONTENT_VIEW_WINDOW, range_query, 8, "Input the wavelength and lower level energy ranges");
+
+    if(form_return == FORM_QUIT)
+      return form_return;
+
+    *wmin = strtod(range_query[1].buffer, NULL);
+    *wmax = strtod(range_query[3].buffer, NULL);
+    *emin = strtod(range_query[5].buffer, NULL);
+    *emax = strtod(range_query[7].buffer, NULL);
+    strcpy(string_wmin, range_query[1].buffer);
+    strcpy(string_wmax, range_query[3].buffer);
+    strcpy(string_emin, range_query[5].buffer);
+    strcpy(string_emax, range_query[7].buffer);
+
+    if(*wmax <= *wmin)
+    {
+      update_status_bar("Invalid input for wavelength range %f - %f (minimum - maximum)", *wmin, *wmax);
+    }
+    else if(*emax < *emin)
+    {
+      update_status_bar("Invalid input for energy range %f - %f (minimum - maximum)", *emin, *emax);
+    }
+    else
+    {
+      valid_input = true;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Query a single wavelength from the user.
+ *
+ * @param[out]  wavelength  The wavelength in Angstroms
+ *
+ * @details
+ *
+ * Continues to loop until a positive wavelength is given or the user quits.
+ *
+ * ************************************************************************** */
+
+int
+query_wavelength(double *wavelength)
+{
+  int form_return;
+  int valid_input = false;
+  WINDOW *window = CONTENT_VIEW_WINDOW.window;
+
+  static char default_wavelength[FIELD_INPUT_LEN] = "";
+  static Query_t wavelength_query[2];
+
+  while(valid_input != true)
+  {
+    wclear(window);
+    init_single_question_form(wavelength_query, "Wavelength : ", default_wavelength);
+    form_return = query_user(CONTENT_VIEW_WINDOW, wavelength_query, 2, "Input the wavelength");
+
+    if(form_return == FORM_QUIT)
+      return form_return;
+
+    *wavelength = strtod(wavelength_query[1].buffer, NULL);
+    strcpy(default_wavelength, wavelength_query[1].buffer);
+
+    if(*wavelength > 0)
+      valid_input = true;
+    else
+      update_status_bar("Invalid wavelength %f", *wavelength);
+  }
+
+  return EXIT_SUCCESS;
+}
+
 /* ************************************************************************** */
 /**
  * @brief  Query an atomic number from the user.
@@ -543,6 +717,54 @@ query_ion_input(int nion_or_z, int *z, int *istate, int *nion)
   return EXIT_SUCCESS;
 }
 
+/* ************************************************************************** */
+/**
+ * @brief  Query a level from the user.
+ *
+ * @param[out]  level  The level, as an index into config
+ *
+ * @details
+ *
+ * Continues to loop until a level which exists is given or the user quits.
+ * The previous answer is remembered.
+ *
+ * ************************************************************************** */
+
+int
+query_level(int *level)
+{
+  int form_return;
+  int valid_input = false;
+  WINDOW *window = CONTENT_VIEW_WINDOW.window;
+
+  static char default_level[FIELD_INPUT_LEN] = "";
+  static Query_t level_query[2];
+
+  while(valid_input != true)
+  {
+    wclear(window);
+    init_single_question_form(level_query, "Level number : ", default_level);
+    form_return = query_user(CONTENT_VIEW_WINDOW, level_query, 2, "Please input the level number");
+
+    if(form_return == FORM_QUIT)
+      return form_return;
+
+    *level = (int) strtol(level_query[1].buffer, NULL, 10);
+    strcpy(default_level, level_query[1].buffer);
+
+    if(*level >= 0 && *level < nlevels)
+    {
+      valid_input = true;
+    }
+    else
+    {
+      update_status_bar("Invalid level number %i when there are %i levels", *level, nlevels);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
 /* ************************************************************************** */
 /**
  * @brief     Query the user for the atomic data name.
@@ -680,3 +902,94 @@ query_atomic_number_by_symbol(int *z)
 
   return EXIT_SUCCESS;
 }
+
+/* ************************************************************************** */
+/**
+ * @brief  Query the order to sort a table of element or ion totals by.
+ *
+ * @param[out]  order  The order chosen
+ *
+ * @details
+ *
+ * The previous choice is remembered.
+ *
+ * ************************************************************************** */
+
+int
+query_stats_order(int *order)
+{
+  static int menu_index = 0;
+  int index;
+
+  index = create_menu(CONTENT_VIEW_WINDOW, "Sort the summary by", STATS_ORDER_CHOICES,
+                      ARRAY_SIZE(STATS_ORDER_CHOICES), menu_index, MENU_CONTROL);
+
+  if(index == MENU_QUIT)
+    return FORM_QUIT;
+
+  menu_index = index;
+  *order = STATS_ORDER_CHOICES[index].index;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Query how many of the strongest lines to find, and what to measure
+ *         their strength by.
+ *
+ * @param[out]  k         The number of lines
+ * @param[out]  strength  The measure of line strength
+ *
+ * @details
+ *
+ * Continues to loop until a positive number of lines is given or the user
+ * quits. The previous answers are remembered.
+ *
+ * ************************************************************************** */
+
+int
+query_strongest_lines(int *k, int *strength)
+{
+  int form_return;
+  int index;
+  int valid_input = false;
+  WINDOW *window = CONTENT_VIEW_WINDOW.window;
+
+  static int menu_index = 0;
+  static char default_k[FIELD_INPUT_LEN] = "20";
+  static Query_t k_query[2];
+
+  while(valid_input != true)
+  {
+    wclear(window);
+    init_single_question_form(k_query, "Number of lines : ", default_k);
+    form_return = query_user(CONTENT_VIEW_WINDOW, k_query, 2, "How many of the strongest lines should be shown");
+
+    if(form_return == FORM_QUIT)
+      return form_return;
+
+    *k = (int) strtol(k_query[1].buffer, NULL, 10);
+
+    if(*k > 0)
+    {
+      valid_input = true;
+      strcpy(default_k, k_query[1].buffer);
+    }
+    else
+    {
+      update_status_bar("Invalid number of lines %i", *k);
+    }
+  }
+
+  index = create_menu(CONTENT_VIEW_WINDOW, "Measure the strength of the lines by", STRENGTH_CHOICES,
+                      ARRAY_SIZE(STRENGTH_CHOICES), menu_index, MENU_CONTROL);
+
+  if(index == MENU_QUIT)
+    return FORM_QUIT;
+
+  menu_index = index;
+  *strength = STRENGTH_CHOICES[index].index;
+
+  return EXIT_SUCCESS;
+}
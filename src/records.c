@@ -0,0 +1,1147 @@
+/* ************************************************************************** */
+/**
+ * @file     records.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Functions for reading the atomic data files into batches of records.
+ *
+ * @details
+ *
+ * Reading the atomic data is done in two phases. In the first phase, each file
+ * listed in the masterfile is mapped into memory and split into a batch of
+ * records by a pool of threads. Each line of a file becomes a record, which
+ * contains the keyword of the line and the fields of the line parsed with the
+ * format which the line is most likely going to be read with. In the second phase, get_atomic_data()
+ * goes through the batches in masterfile order and uses the records to
+ * populate the atomic data structures. As all of the linking happens in the
+ * second phase, the order dependent rules of the data files still apply.
+ *
+ * The format a line is parsed with in the first phase is only a guess, as it
+ * can depend on records from the previous files. get_atomic_data() reads each
+ * record using record_scanf() which behaves as sscanf(). If the record was
+ * parsed with the format which was requested, the parsed fields are used,
+ * otherwise the line is parsed again with that format. In either case the
+ * result is the same as calling sscanf() on the line.
+ *
+ * ************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <float.h>
+#include <limits.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "atomix.h"
+
+#define LINELENGTH 400
+
+/* ************************************************************************** */
+/**
+ * @brief  Convert the integer at the start of a string, as strtol() would in
+ *         base 10.
+ *
+ * @param[in]   s      The string to convert
+ * @param[out]  end    The first character after the integer, or s if there
+ *                     is no integer
+ * @param[in]   width  The maximum number of characters to use, or 0 for no
+ *                     limit
+ *
+ * @return  The integer
+ *
+ * @details
+ *
+ * Integers which are too long to be accumulated without overflow are left to
+ * strtol(), so that they saturate in the same way.
+ *
+ * ************************************************************************** */
+
+static long
+read_integer(const char *s, char **end, int width)
+{
+  int negative, ndigits;
+  long value;
+  const char *c;
+
+  if(width <= 0)
+    width = INT_MAX;
+
+  c = s;
+  negative = FALSE;
+  if(*c == '+' || *c == '-')
+  {
+    negative = *c++ == '-';
+    width--;
+  }
+
+  value = 0;
+  for(ndigits = 0; ndigits < width && isdigit((unsigned char) *c); ++ndigits, ++c)
+  {
+    if(ndigits == 18)
+      return strtol(s, end, 10);
+    value = 10 * value + (*c - '0');
+  }
+
+  if(ndigits == 0)
+  {
+    *end = (char *) s;
+    return 0;
+  }
+
+  *end = (char *) c;
+
+  return negative ? -value : value;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Convert the number at the start of a string, as strtod() would.
+ *
+ * @param[in]   s    The string to convert
+ * @param[out]  end  The first character after the number, or s if there is no
+ *                   number
+ *
+ * @return  The number
+ *
+ * @details
+ *
+ * The digits are accumulated into an integer mantissa m and a decimal exponent
+ * q. When m and 10^|q| are both exactly representable as doubles, m * 10^q is
+ * a single correctly rounded operation. Otherwise, if long double has a 64 bit
+ * mantissa, m * 10^q is worked out with at most two long double operations and
+ * rounded to double. This is only correctly rounded if the result is not
+ * close to half way between two doubles, which is checked using the 11 bits
+ * of the long double mantissa which are dropped. Anything else, such as a
+ * number with more than 19 digits, hexadecimal, inf or nan, is left to
+ * strtod(), so the result is always identical to strtod().
+ *
+ * ************************************************************************** */
+
+static const double POW10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+  1e20, 1e21, 1e22
+};
+
+#if LDBL_MANT_DIG == 64 && (defined(__x86_64__) || defined(__i386__))
+#define READ_REAL_EXTENDED
+static const long double POW10L[] = {
+  1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L,
+  1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+};
+#endif
+
+static double
+read_real(const char *s, char **end)
+{
+  int negative, ndigits, exponent, e, enegative, any;
+  uint64_t mantissa;
+  double value;
+  const char *c, *x;
+
+  c = s;
+  negative = FALSE;
+  if(*c == '+' || *c == '-')
+    negative = *c++ == '-';
+
+  if(c[0] == '0' && (c[1] == 'x' || c[1] == 'X'))
+    return strtod(s, end);
+
+  any = FALSE;
+  mantissa = 0;
+  ndigits = 0;
+  exponent = 0;
+
+  for(; isdigit((unsigned char) *c); ++c)
+  {
+    any = TRUE;
+    if(ndigits == 0 && *c == '0')
+      continue;
+    if(ndigits++ == 19)
+      return strtod(s, end);
+    mantissa = 10 * mantissa + (*c - '0');
+  }
+
+  if(*c == '.')
+  {
+    for(++c; isdigit((unsigned char) *c); ++c)
+    {
+      any = TRUE;
+      exponent--;
+      if(ndigits == 0 && *c == '0')
+        continue;
+      if(ndigits++ == 19)
+        return strtod(s, end);
+      mantissa = 10 * mantissa + (*c - '0');
+    }
+  }
+
+  if(!any)
+    return strtod(s, end);
+
+  if(*c == 'e' || *c == 'E')
+  {
+    x = c + 1;
+    enegative = FALSE;
+    if(*x == '+' || *x == '-')
+      enegative = *x++ == '-';
+    if(isdigit((unsigned char) *x))
+    {
+      for(e = 0; isdigit((unsigned char) *x); ++x)
+        if(e < 100000)
+          e = 10 * e + (*x - '0');
+      exponent += enegative ? -e : e;
+      c = x;
+    }
+  }
+
+  *end = (char *) c;
+
+  if(mantissa == 0)
+    return negative ? -0.0 : 0.0;
+
+  if(mantissa <= (UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22)
+  {
+    value = exponent < 0 ? (double) mantissa / POW10[-exponent] : (double) mantissa * POW10[exponent];
+    return negative ? -value : value;
+  }
+
+#ifdef READ_REAL_EXTENDED
+  if(exponent >= -54 && exponent <= 54)
+  {
+    long double extended;
+    uint64_t bits;
+
+    extended = (long double) mantissa;
+    e = exponent < 0 ? -exponent : exponent;
+    if(exponent < 0)
+      extended = e > 27 ? extended / POW10L[27] / POW10L[e - 27] : extended / POW10L[e];
+    else
+      extended = e > 27 ? extended * POW10L[27] * POW10L[e - 27] : extended * POW10L[e];
+
+    memcpy(&bits, &extended, sizeof bits);
+    bits &= 0x7FF;
+    value = (double) extended;
+
+    if((bits < 0x400 - 3 || bits > 0x400 + 3) && value >= DBL_MIN && value <= DBL_MAX)
+      return negative ? -value : value;
+  }
+#endif
+
+  return strtod(s, end);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Convert the next field of a line, for each type of field in a
+ *         record schema.
+ *
+ * @param[in,out]  c       The position in the line
+ * @param[in]      end     The end of the line
+ * @param[in,out]  fields  The next field to store
+ * @param[in,out]  n       The number of fields stored
+ *
+ * @return  0 if the field was converted, 1 if it could not be converted or
+ *          EOF if the end of the line was reached first
+ *
+ * @details
+ *
+ * These behave the same as the sscanf() conversions which the records used to
+ * be read with, being %*s, %d, %2d, %le, %19s and %15c respectively. The line
+ * is not terminated, so string and chars fields are stored as the position
+ * and length of their characters in the line.
+ *
+ * A line always ends with a newline or a terminator, neither of which can be
+ * part of a number, so numbers are converted without checking for the end.
+ *
+ * ************************************************************************** */
+
+#define SKIP_SPACE(c, end) \
+  while(*(c) < (end) && isspace((unsigned char) **(c))) \
+    ++*(c); \
+  if(*(c) == (end)) \
+    return EOF;
+
+static inline int
+scan_skip(const char **c, const char *end, Field_t **fields, int *n)
+{
+  (void) fields;
+  (void) n;
+
+  SKIP_SPACE(c, end);
+  while(*c < end && !isspace((unsigned char) **c))
+    ++*c;
+
+  return 0;
+}
+
+static inline int
+scan_integer_width(const char **c, const char *end, Field_t **fields, int *n, int width)
+{
+  char *next;
+  long value;
+
+  SKIP_SPACE(c, end);
+  value = read_integer(*c, &next, width);
+  if(next == *c)
+    return 1;
+
+  *c = next;
+  (*fields)++->i = (int) value;
+  (*n)++;
+
+  return 0;
+}
+
+static inline int
+scan_integer(const char **c, const char *end, Field_t **fields, int *n)
+{
+  return scan_integer_width(c, end, fields, n, 0);
+}
+
+static inline int
+scan_integer2(const char **c, const char *end, Field_t **fields, int *n)
+{
+  return scan_integer_width(c, end, fields, n, 2);
+}
+
+static inline int
+scan_real(const char **c, const char *end, Field_t **fields, int *n)
+{
+  char *next;
+  double value;
+
+  SKIP_SPACE(c, end);
+  value = read_real(*c, &next);
+  if(next == *c)
+    return 1;
+
+  *c = next;
+  (*fields)++->d = value;
+  (*n)++;
+
+  return 0;
+}
+
+static inline int
+scan_text(const char **c, const char *end, Field_t **fields, int *n, int width, int word)
+{
+  const char *start;
+
+  SKIP_SPACE(c, end);
+  start = *c;
+  while(*c < end && *c - start < width && !(word && isspace((unsigned char) **c)))
+    ++*c;
+
+  (*fields)->text.start = start;
+  (*fields)++->text.len = (int) (*c - start);
+  (*n)++;
+
+  return 0;
+}
+
+static inline int
+scan_string(const char **c, const char *end, Field_t **fields, int *n)
+{
+  return scan_text(c, end, fields, n, RECORD_STRING_LEN, TRUE);
+}
+
+static inline int
+scan_chars(const char **c, const char *end, Field_t **fields, int *n)
+{
+  return scan_text(c, end, fields, n, RECORD_CHARS_LEN, FALSE);
+}
+
+/*
+ * A parser is generated for each kind of record from its schema, which calls
+ * the scan function of each field in turn. The return value is the same as
+ * sscanf(): the number of fields stored, or EOF if the end of the line was
+ * reached before any field was stored
+ */
+
+#define SCAN_FIELD(type) \
+  if((status = scan_##type(&c, end, &fields, &n)) != 0) \
+    return status == EOF && n == 0 ? EOF : n;
+
+#define DEFINE_RECORD_PARSER(kind) \
+static int \
+parse_##kind(const char *c, const char *end, Field_t *fields) \
+{ \
+  int n = 0; \
+  int status; \
+  kind##_SCHEMA(SCAN_FIELD) \
+  return n; \
+}
+
+RECORD_SCHEMAS(DEFINE_RECORD_PARSER)
+
+/*
+ * The parser of each kind of record, and the type of each field it stores: i
+ * for int, d for double, s for a string and c for RECORD_CHARS_LEN chars
+ */
+
+#define FIELD_TYPE_skip ""
+#define FIELD_TYPE_integer "i"
+#define FIELD_TYPE_integer2 "i"
+#define FIELD_TYPE_real "d"
+#define FIELD_TYPE_string "s"
+#define FIELD_TYPE_chars "c"
+#define FIELD_TYPE(type) FIELD_TYPE_##type
+
+#define RECORD_PARSER_ENTRY(kind) [kind] = {parse_##kind, kind##_SCHEMA(FIELD_TYPE)},
+
+typedef struct RecordParser_t
+{
+  int (*parse)(const char *, const char *, Field_t *);
+  const char *types;
+} RecordParser_t;
+
+static const RecordParser_t RECORD_PARSERS[RECORD_NKINDS] = {
+  RECORD_SCHEMAS(RECORD_PARSER_ENTRY)
+};
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the perfect hash table of the record keywords.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if no perfect hash could be found
+ *
+ * @details
+ *
+ * The keywords are hashed with a seeded FNV-1a hash, and seeds are tried in
+ * turn until one is found which gives each keyword its own slot in the table.
+ * This is done once, before the files are read by the threads, and as the
+ * keywords are fixed the same seed is found every time. Looking up a word
+ * then costs a hash of the word and a single comparison against the one
+ * keyword it could be.
+ *
+ * ************************************************************************** */
+
+#define KEYWORD_TABLE_SIZE 128
+#define KEYWORD_MAX_SEED (1 << 20)
+
+#define RECORD_KEYWORD_ENTRY(keyword, name, choice) [keyword] = {name, sizeof(name) - 1, choice},
+
+typedef struct RecordKeyword_t
+{
+  const char *name;
+  size_t len;
+  char choice;
+} RecordKeyword_t;
+
+static const RecordKeyword_t RECORD_KEYWORD_TABLE[RECORD_NKEYWORDS] = {
+  RECORD_KEYWORDS(RECORD_KEYWORD_ENTRY)
+};
+
+static signed char KEYWORD_TABLE[KEYWORD_TABLE_SIZE];
+static uint32_t KEYWORD_SEED;
+static int KEYWORD_TABLE_BUILT = FALSE;
+
+static inline unsigned int
+hash_keyword(const char *word, size_t len, uint32_t seed)
+{
+  size_t i;
+  uint32_t hash = 2166136261u ^ seed;
+
+  for(i = 0; i < len; ++i)
+  {
+    hash ^= (unsigned char) word[i];
+    hash *= 16777619u;
+  }
+
+  return (hash ^ (hash >> 16)) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+static int
+build_keyword_table(void)
+{
+  int i;
+  uint32_t seed;
+  unsigned int slot;
+
+  if(KEYWORD_TABLE_BUILT)
+    return EXIT_SUCCESS;
+
+  for(seed = 0; seed < KEYWORD_MAX_SEED; ++seed)
+  {
+    memset(KEYWORD_TABLE, KEYWORD_NONE, sizeof KEYWORD_TABLE);
+
+    for(i = 0; i < RECORD_NKEYWORDS; ++i)
+    {
+      slot = hash_keyword(RECORD_KEYWORD_TABLE[i].name, RECORD_KEYWORD_TABLE[i].len, seed);
+      if(KEYWORD_TABLE[slot] != KEYWORD_NONE)
+        break;
+      KEYWORD_TABLE[slot] = i;
+    }
+
+    if(i == RECORD_NKEYWORDS)
+    {
+      KEYWORD_SEED = seed;
+      KEYWORD_TABLE_BUILT = TRUE;
+      return EXIT_SUCCESS;
+    }
+  }
+
+  return EXIT_FAILURE;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Determine the type of record from the first word of a line.
+ *
+ * @param[in]   word     The first word of the line
+ * @param[in]   end      The end of the line
+ * @param[out]  keyword  The keyword of the line, or KEYWORD_NONE
+ *
+ * @return  The choice of record, '*' for a continuation of the previous record
+ *          type or 'z' if the record is unknown
+ *
+ * @details
+ *
+ * The whole of the first word has to match a keyword exactly, so for example
+ * LevelX is unknown rather than a Level record.
+ *
+ * ************************************************************************** */
+
+static char
+get_record_choice(const char *word, const char *end, int *keyword)
+{
+  int n;
+  size_t len;
+
+  *keyword = KEYWORD_NONE;
+
+  if(word == end || *word == '!' || *word == '#')
+    return 'c';                 /* It's a blank line or a comment */
+  if(*word == '*')
+    return '*';                 /* It's a continuation so record type remains same */
+
+  for(len = 0; word + len < end && !isspace((unsigned char) word[len]); ++len);
+
+  n = KEYWORD_TABLE[hash_keyword(word, len, KEYWORD_SEED)];
+  if(n == KEYWORD_NONE || RECORD_KEYWORD_TABLE[n].len != len || memcmp(word, RECORD_KEYWORD_TABLE[n].name, len) != 0)
+    return 'z';                 /* Who knows what it is */
+
+  *keyword = n;
+
+  return RECORD_KEYWORD_TABLE[n].choice;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Guess the format a record will be read with in get_atomic_data().
+ *
+ * @param[in]  choice   The choice of record
+ * @param[in]  keyword  The keyword of the line
+ *
+ * @return  The kind of record, or RECORD_NONE
+ *
+ * ************************************************************************** */
+
+static int
+get_record_kind(char choice, int keyword)
+{
+  switch(choice)
+  {
+    case 'e':
+      return RECORD_ELEMENT;
+    case 'i':
+      return RECORD_ION;
+    case 'N':
+      if(keyword == KEYWORD_LEVTOP)
+        return RECORD_LEVTOP;
+      if(keyword == KEYWORD_LEVMACRO)
+        return RECORD_LEVMACRO;
+      return RECORD_NONE;
+    case 'n':
+      return RECORD_LEVEL_KURUCZ;
+    case 'w':
+      if(keyword == KEYWORD_PHOTMACS || keyword == KEYWORD_PHOTTOPS || keyword == KEYWORD_PHOTVFKYS)
+        return RECORD_PHOT;
+      return RECORD_NONE;
+    case 'I':
+      return RECORD_INNER;
+    case 'r':
+      if(keyword == KEYWORD_LINMACRO)
+        return RECORD_LINMACRO;
+      return RECORD_LINE;
+    case 'f':
+      return RECORD_FRAC;
+    case 'D':
+      return RECORD_DR_BADNL;
+    case 'S':
+      return RECORD_DR_SHULL;
+    case 'T':
+      return RECORD_RR_BADNL;
+    case 's':
+      return RECORD_RR_SHULL;
+    case 'G':
+      return RECORD_BAD_GS_RR;
+    case 'g':
+      return RECORD_FF_GAUNT;
+    case 'd':
+      return RECORD_DI_DERE;
+    case 'K':
+      return RECORD_KELECYIELD;
+    case 'C':
+      return RECORD_CSTREN;
+    default:
+      return RECORD_NONE;
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Parse the fields of a record as a kind of record.
+ *
+ * @param[in,out]  batch       The batch the record belongs to
+ * @param[in,out]  record      The record to parse
+ * @param[in]      kind        The kind of record to parse the line as
+ * @param[in,out]  nfields     The number of fields used in the batch so far
+ * @param[in,out]  max_fields  The number of fields allocated for the batch
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * The fields are appended to the fields of the batch, which may be moved when
+ * it is grown, so the records are only pointed at their fields once the whole
+ * batch has been parsed.
+ *
+ * ************************************************************************** */
+
+static int
+parse_record(Batch_t *batch, Record_t *record, int kind, int *nfields, int *max_fields)
+{
+  int n;
+  Field_t *fields;
+
+  if(*nfields + RECORD_MAX_FIELDS > *max_fields)
+  {
+    *max_fields = 2 * (*nfields + RECORD_MAX_FIELDS);
+    if((fields = realloc(batch->fields, *max_fields * sizeof(Field_t))) == NULL)
+      return EXIT_FAILURE;
+    batch->fields = fields;
+  }
+
+  n = RECORD_PARSERS[kind].parse(record->line, record->line + record->len, &batch->fields[*nfields]);
+
+  record->kind = kind;
+  record->nfields = n;
+
+  if(n > 0)
+    *nfields += n;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read an atomic data file into a batch of records.
+ *
+ * @param[in,out]  batch  The batch to read, with the path already set
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the file could not be read
+ *
+ * @details
+ *
+ * The file is mapped into memory read only, and each record is the position
+ * and length of its line in the mapping. The lines are parsed where they are,
+ * and the string and chars fields point back into them, so the file is never
+ * copied or written to. The only exception is a final line without a newline,
+ * which is copied so it ends with a terminator. As the lines are not read
+ * into a fixed size buffer, there is no limit on the length of a line. The
+ * lines which fgets() with a LINELENGTH buffer would have split are counted,
+ * so they can be logged once the batches have been read.
+ *
+ * Multi-line records are followed through the batch, so that the lines of
+ * photoionization and collision strength tables are parsed with the format
+ * of the table rather than as records in their own right.
+ *
+ * ************************************************************************** */
+
+static int
+read_batch(Batch_t *batch)
+{
+  int fd;
+  struct stat st;
+  int i, nlines, nfields, max_fields;
+  int kind, pending, pending_kind;
+  char choice, previous_choice;
+  const char *map, *start, *next, *end, *eol, *word;
+  char *tail;
+  Record_t *record;
+
+  if((fd = open(batch->path, O_RDONLY)) < 0)
+    return EXIT_FAILURE;
+
+  if(fstat(fd, &st) != 0)
+  {
+    close(fd);
+    return EXIT_FAILURE;
+  }
+
+  map = NULL;
+  if(st.st_size > 0)
+  {
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(map == MAP_FAILED)
+    {
+      close(fd);
+      return EXIT_FAILURE;
+    }
+    batch->map = map;
+    batch->map_size = st.st_size;
+  }
+
+  close(fd);
+  end = map + st.st_size;
+
+  /*
+   * Count the number of lines, so the storage for the records can be
+   * allocated in one go
+   */
+
+  nlines = 0;
+  for(start = map; start < end && (eol = memchr(start, '\n', end - start)) != NULL; start = eol + 1)
+    nlines++;
+  if(start < end)
+    nlines++;
+
+  batch->nrecords = nlines;
+  batch->records = calloc(nlines + 1, sizeof(Record_t));
+  max_fields = nlines * 4 + RECORD_MAX_FIELDS;
+  batch->fields = malloc(max_fields * sizeof(Field_t));
+
+  if(batch->records == NULL || batch->fields == NULL)
+    return EXIT_FAILURE;
+
+  nfields = 0;
+  pending = 0;
+  pending_kind = RECORD_NONE;
+  previous_choice = 'x';
+
+  for(i = 0, start = map; start < end; start = next, ++i)
+  {
+    if((eol = memchr(start, '\n', end - start)) != NULL)
+    {
+      next = eol + 1;
+    }
+    else
+    {
+      if((tail = malloc(end - start + 1)) == NULL)
+        return EXIT_FAILURE;
+      memcpy(tail, start, end - start);
+      tail[end - start] = '\0';
+      batch->tail = tail;
+      eol = tail + (end - start);
+      start = tail;
+      next = end;
+    }
+
+    record = &batch->records[i];
+    record->line = start;
+    record->len = (int) (eol - start);
+    if(record->len >= LINELENGTH - 1)
+      batch->nlong++;
+
+    for(word = start; word < eol && isspace((unsigned char) *word); ++word);
+
+    choice = get_record_choice(word, eol, &record->keyword);
+    record->choice = choice;
+    record->kind = RECORD_NONE;
+
+    /*
+     * Lines which belong to the table of a previous record do not change the
+     * choice of record in get_atomic_data, so they are handled separately
+     */
+
+    if(pending > 0)
+    {
+      kind = pending_kind;
+      pending--;
+    }
+    else
+    {
+      if(choice != '*')
+        previous_choice = choice;
+      kind = get_record_kind(previous_choice, record->keyword);
+    }
+
+    if(kind == RECORD_NONE)
+      continue;
+
+    if(parse_record(batch, record, kind, &nfields, &max_fields))
+      return EXIT_FAILURE;
+
+    if((kind == RECORD_PHOT || kind == RECORD_INNER) && record->nfields == 6)
+    {
+      pending = batch->fields[nfields - 1].i;
+      pending_kind = RECORD_POINT;
+    }
+    else if(kind == RECORD_CSTREN && record->nfields == 18)
+    {
+      pending = 2;
+      pending_kind = RECORD_CSTREN_SPLINE;
+    }
+  }
+
+  for(i = 0, nfields = 0; i < nlines; ++i)
+  {
+    record = &batch->records[i];
+    if(record->kind != RECORD_NONE && record->nfields > 0)
+    {
+      record->fields = &batch->fields[nfields];
+      nfields += record->nfields;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  The work done by each thread in the pool reading the batches.
+ *
+ * @details
+ *
+ * Each thread takes the next unread batch until all the batches have been
+ * read. The files are handed out in masterfile order, so the largest files
+ * do not all end up being read by the same thread.
+ *
+ * ************************************************************************** */
+
+typedef struct BatchQueue_t
+{
+  pthread_mutex_t lock;
+  int next;
+  int nbatches;
+  Batch_t *batches;
+} BatchQueue_t;
+
+static void *
+read_batch_worker(void *arg)
+{
+  int n;
+  BatchQueue_t *queue = arg;
+
+  while(TRUE)
+  {
+    pthread_mutex_lock(&queue->lock);
+    n = queue->next++;
+    pthread_mutex_unlock(&queue->lock);
+
+    if(n >= queue->nbatches)
+      break;
+
+    queue->batches[n].error = read_batch(&queue->batches[n]);
+  }
+
+  return NULL;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Log the lines of a batch which were too long to be read with fgets()
+ *         into a LINELENGTH buffer.
+ *
+ * @param[in]  batch  The batch of records
+ *
+ * @details
+ *
+ * Before the files were mapped into memory, such a line was split into pieces
+ * of LINELENGTH - 1 characters, and each piece after the first was read as a
+ * line of its own. The lines are now read whole, so they are logged in case a
+ * data file relied on the split.
+ *
+ * ************************************************************************** */
+
+static void
+log_long_lines(const Batch_t *batch)
+{
+  int i;
+
+  if(batch->nlong == 0)
+    return;
+
+  for(i = 0; i < batch->nrecords; ++i)
+  {
+    if(batch->records[i].len >= LINELENGTH - 1)
+      logfile("read_atomic_data_batches: line %d of %s is %d characters long, and is read whole rather than split\n",
+              i + 1, batch->file, batch->records[i].len);
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the batches of records from the previous read.
+ *
+ * ************************************************************************** */
+
+static Batch_t *BATCHES = NULL;
+static int NBATCHES = 0;
+
+void
+free_atomic_data_batches(void)
+{
+  int i;
+
+  for(i = 0; i < NBATCHES; ++i)
+  {
+    free(BATCHES[i].records);
+    free(BATCHES[i].fields);
+    free(BATCHES[i].tail);
+    if(BATCHES[i].map != NULL)
+      munmap((void *) BATCHES[i].map, BATCHES[i].map_size);
+  }
+
+  free(BATCHES);
+  BATCHES = NULL;
+  NBATCHES = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read all of the files listed in a masterfile into batches of
+ *         records.
+ *
+ * @param[in]   mptr          The opened masterfile
+ * @param[in]   use_relative  If TRUE, the data file paths are used as is
+ * @param[out]  batches       The batches of records, one for each file in
+ *                            masterfile order
+ *
+ * @return  The number of batches, or -1 if memory could not be allocated or
+ *          the keywords could not be hashed
+ *
+ * @details
+ *
+ * The files are read by a pool of threads, one for each core. If a file could
+ * not be read, the error flag of its batch is set and it is up to the caller
+ * to decide what to do, as the files before it still have to be processed.
+ *
+ * The batches belong to this file and are only freed at the start of the next
+ * read, or by free_atomic_data_batches(), so get_atomic_data() does not need
+ * to free them on each of its error paths.
+ *
+ * ************************************************************************** */
+
+int
+read_atomic_data_batches(FILE *mptr, int use_relative, Batch_t **batches)
+{
+  int i, nthreads, max_batches;
+  int lineno, split;
+  long ncores;
+  pthread_t *threads;
+  Batch_t *tmp;
+  BatchQueue_t queue;
+  char aline[LINELENGTH];
+  char file[LINELENGTH];
+
+  free_atomic_data_batches();
+
+  if(build_keyword_table())
+    return -1;
+
+  max_batches = 0;
+  lineno = 0;
+  split = FALSE;
+
+  while(fgets(aline, LINELENGTH, mptr) != NULL)
+  {
+    if(!split)
+      lineno++;
+    split = strchr(aline, '\n') == NULL && !feof(mptr);
+    if(split)
+      logfile("read_atomic_data_batches: line %d of the masterfile is longer than %d characters and is split\n", lineno,
+              LINELENGTH - 2);
+
+    if(sscanf(aline, "%s", file) == 1 && file[0] != '#')
+    {
+      if(NBATCHES == max_batches)
+      {
+        max_batches = max_batches ? 2 * max_batches : 32;
+        if((tmp = realloc(BATCHES, max_batches * sizeof(Batch_t))) == NULL)
+          return -1;
+        BATCHES = tmp;
+      }
+
+      memset(&BATCHES[NBATCHES], 0, sizeof(Batch_t));
+      strcpy(BATCHES[NBATCHES].file, file);
+      get_atomic_data_file_path(file, use_relative, BATCHES[NBATCHES].path);
+      NBATCHES++;
+    }
+  }
+
+  *batches = BATCHES;
+
+  if(NBATCHES == 0)
+    return 0;
+
+  ncores = sysconf(_SC_NPROCESSORS_ONLN);
+  nthreads = ncores > 0 ? (int) ncores : 1;
+  if(nthreads > NBATCHES)
+    nthreads = NBATCHES;
+
+  queue.next = 0;
+  queue.nbatches = NBATCHES;
+  queue.batches = BATCHES;
+  pthread_mutex_init(&queue.lock, NULL);
+
+  if((threads = malloc(nthreads * sizeof(pthread_t))) == NULL)
+    nthreads = 0;
+
+  for(i = 0; i < nthreads; ++i)
+  {
+    if(pthread_create(&threads[i], NULL, read_batch_worker, &queue) != 0)
+      break;
+  }
+  nthreads = i;
+
+  /*
+   * If no threads could be created, then the batches are read on this thread
+   * instead
+   */
+
+  if(nthreads == 0)
+    read_batch_worker(&queue);
+
+  for(i = 0; i < nthreads; ++i)
+    pthread_join(threads[i], NULL);
+
+  free(threads);
+  pthread_mutex_destroy(&queue.lock);
+
+  for(i = 0; i < NBATCHES; ++i)
+    log_long_lines(&BATCHES[i]);
+
+  return NBATCHES;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the next record in a batch.
+ *
+ * @param[in,out]  batch  The batch of records
+ *
+ * @return  The next record, or NULL when there are no records left
+ *
+ * ************************************************************************** */
+
+Record_t *
+get_next_record(Batch_t *batch)
+{
+  if(batch->next >= batch->nrecords)
+    return NULL;
+
+  return &batch->records[batch->next++];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Copy the line of a record into a buffer, as a string.
+ *
+ * @param[in]   record  The record
+ * @param[out]  buffer  The buffer to copy the line into
+ * @param[in]   size    The size of the buffer
+ *
+ * @return  The buffer
+ *
+ * @details
+ *
+ * The lines of the records are not terminated, so this is used to get a line
+ * which can be printed. A line which is too long for the buffer is cut short.
+ *
+ * ************************************************************************** */
+
+char *
+copy_record_line(const Record_t *record, char *buffer, int size)
+{
+  int len;
+
+  len = record->len < size - 1 ? record->len : size - 1;
+  memcpy(buffer, record->line, len);
+  buffer[len] = '\0';
+
+  return buffer;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read the fields of a record, in the same way as sscanf().
+ *
+ * @param[in]  record  The record to read
+ * @param[in]  kind    The kind of record to read the line as
+ * @param[out] ...     Pointers to the variables to store each field in, in
+ *                     the order of the schema of the kind of record
+ *
+ * @return  The number of fields read, as returned by sscanf()
+ *
+ * @details
+ *
+ * If the record has already been parsed as this kind of record, the parsed
+ * fields are copied into the variables. Otherwise, the line is parsed with
+ * the parser for the kind of record first. As with sscanf(), only the fields
+ * which were successfully converted are written to. A string field needs room
+ * for RECORD_STRING_LEN characters and a terminator, and a chars field is
+ * padded with spaces to RECORD_CHARS_LEN characters.
+ *
+ * ************************************************************************** */
+
+int
+record_scanf(Record_t *record, int kind, ...)
+{
+  int i, n;
+  va_list args;
+  void *p[RECORD_MAX_FIELDS];
+  Field_t parsed[RECORD_MAX_FIELDS];
+  Field_t *fields;
+  const char *types = RECORD_PARSERS[kind].types;
+
+  va_start(args, kind);
+  for(i = 0; types[i] != '\0'; ++i)
+    p[i] = va_arg(args, void *);
+  va_end(args);
+
+  if(record->kind == kind)
+  {
+    fields = record->fields;
+    n = record->nfields;
+  }
+  else
+  {
+    fields = parsed;
+    n = RECORD_PARSERS[kind].parse(record->line, record->line + record->len, parsed);
+  }
+
+  for(i = 0; i < n; ++i)
+  {
+    switch(types[i])
+    {
+      case 'i':
+        *(int *) p[i] = fields[i].i;
+        break;
+      case 'd':
+        *(double *) p[i] = fields[i].d;
+        break;
+      case 's':
+        memcpy(p[i], fields[i].text.start, fields[i].text.len);
+        ((char *) p[i])[fields[i].text.len] = '\0';
+        break;
+      case 'c':
+        memcpy(p[i], fields[i].text.start, fields[i].text.len);
+        memset((char *) p[i] + fields[i].text.len, ' ', RECORD_CHARS_LEN - fields[i].text.len);
+        break;
+    }
+  }
+
+  return n;
+}
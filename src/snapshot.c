@@ -0,0 +1,914 @@
+/* ************************************************************************** */
+/**
+ * @file     snapshot.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Functions for saving and restoring a binary snapshot of the atomic data.
+ *
+ * @details
+ *
+ * Parsing every file in a masterfile is by far the slowest part of starting
+ * atomix. Once a data set has been read in successfully, the fully linked
+ * state of the atomic data structures is written to a snapshot file in the
+ * cache directory. The next time the same masterfile is requested, the
+ * snapshot is memory mapped and copied back into the structures instead.
+ *
+ * A snapshot is keyed by a fingerprint of the masterfile and every file which
+ * it lists (path, size and modification time), as well as the snapshot version
+ * and the sizes of the structures. If any of these change, the snapshot is
+ * ignored and is rebuilt after the data has been parsed again.
+ *
+ * The cache directory is $ATOMIX_CACHE_DIR if set, otherwise it is
+ * $HOME/.cache/atomix. Setting ATOMIX_CACHE_DIR to an empty string disables
+ * snapshots altogether.
+ *
+ * ************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "atomix.h"
+
+#define SNAPSHOT_MAGIC "ATOMIXSN"
+#define SNAPSHOT_VERSION 7
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+typedef struct Snapshot_t
+{
+  char magic[8];
+  int version;
+  uint64_t fingerprint;
+  int nelements, nions, nlevels, nlte_levels, nlevels_macro;
+  int nlines, nlines_macro;
+  int nxphot, ntop_phot, nphot_total;
+  int n_inner_tot, n_coll_stren;
+  int nxsection_points;
+  int ndrecomb, n_total_rr, n_bad_gs_rr, n_dere_di_rate, gaunt_n_gsqrd;
+  int nsummary;
+  int nmacro_jumps[NMACRO_JUMPS];
+  double rho2nh, phot_freq_min, inner_freq_min;
+} Snapshot_t;
+
+/* ************************************************************************** */
+/**
+ * @brief  Update a FNV-1a hash with a block of bytes.
+ *
+ * @param[in]  hash  The current value of the hash
+ * @param[in]  data  The bytes to add to the hash
+ * @param[in]  len   The number of bytes
+ *
+ * @return  The updated hash
+ *
+ * ************************************************************************** */
+
+static uint64_t
+fnv_hash(uint64_t hash, const void *data, size_t len)
+{
+  size_t i;
+  const unsigned char *bytes = data;
+
+  for(i = 0; i < len; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+
+  return hash;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the path, size and modification time of a file to a hash.
+ *
+ * @param[in,out]  hash  The hash to update
+ * @param[in]      path  The path to the file
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the file could not be stat'd
+ *
+ * @details
+ *
+ * The nanoseconds of the modification time are included, so a file which is
+ * rewritten with the same size within a second still changes the hash.
+ *
+ * ************************************************************************** */
+
+static int
+fingerprint_file(uint64_t *hash, const char *path)
+{
+  struct stat st;
+  int64_t size, mtime, mtime_nsec;
+
+  if(stat(path, &st) != 0)
+    return EXIT_FAILURE;
+
+  size = (int64_t) st.st_size;
+  mtime = (int64_t) st.st_mtime;
+#if defined(__APPLE__)
+  mtime_nsec = (int64_t) st.st_mtimespec.tv_nsec;
+#else
+  mtime_nsec = (int64_t) st.st_mtim.tv_nsec;
+#endif
+
+  *hash = fnv_hash(*hash, path, strlen(path));
+  *hash = fnv_hash(*hash, &size, sizeof size);
+  *hash = fnv_hash(*hash, &mtime, sizeof mtime);
+  *hash = fnv_hash(*hash, &mtime_nsec, sizeof mtime_nsec);
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Compute the fingerprint of a masterfile and all of its data files.
+ *
+ * @param[in]   masterfile    The full path to the masterfile
+ * @param[in]   use_relative  If TRUE, the data file paths are used as is
+ * @param[out]  fingerprint   The fingerprint of the data set
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if one of the files could not be found
+ *
+ * @details
+ *
+ * The masterfile is read in the same way as in get_atomic_data(), so the list
+ * of files fingerprinted is the same as the list of files which are parsed.
+ * The structure sizes are included so a change of layout invalidates any old
+ * snapshots.
+ *
+ * ************************************************************************** */
+
+static int
+fingerprint_atomic_data(char *masterfile, int use_relative, uint64_t *fingerprint)
+{
+  FILE *mptr;
+  int version = SNAPSHOT_VERSION;
+  size_t sizes[] = {
+    sizeof(ele_dummy), sizeof(ion_dummy), sizeof(ion_links_dummy), sizeof(config_dummy), sizeof(line_dummy),
+    sizeof(line_links_dummy), sizeof(Topbase_phot), sizeof(Coll_stren), sizeof(Inner_elec_yield),
+    sizeof(struct ground_fracs), sizeof(Drecomb), sizeof(Total_rr), sizeof(Bad_gs_rr), sizeof(Dere_di_rate),
+    sizeof(Gaunt_total)
+  };
+  char aline[LINELEN * 4];
+  char file[LINELEN * 4];
+  char path[LINELEN * 4];
+
+  *fingerprint = FNV_OFFSET;
+  *fingerprint = fnv_hash(*fingerprint, &version, sizeof version);
+  *fingerprint = fnv_hash(*fingerprint, sizes, sizeof sizes);
+
+  if(fingerprint_file(fingerprint, masterfile))
+    return EXIT_FAILURE;
+
+  if((mptr = fopen(masterfile, "r")) == NULL)
+    return EXIT_FAILURE;
+
+  while(fgets(aline, sizeof aline, mptr) != NULL)
+  {
+    if(sscanf(aline, "%s", file) == 1 && file[0] != '#')
+    {
+      get_atomic_data_file_path(file, use_relative, path);
+      if(fingerprint_file(fingerprint, path))
+      {
+        fclose(mptr);
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  fclose(mptr);
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the path of the snapshot file for a masterfile.
+ *
+ * @param[in]   masterfile  The full path to the masterfile
+ * @param[out]  path        The path to the snapshot file
+ * @param[in]   create      If TRUE, create the cache directory if required
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if snapshots are disabled or the
+ *          cache directory is not available
+ *
+ * @details
+ *
+ * The name of the snapshot is a hash of the canonical path to the masterfile,
+ * so each data set gets a single snapshot which is overwritten when it is
+ * rebuilt.
+ *
+ * ************************************************************************** */
+
+static int
+get_snapshot_path(char *masterfile, char *path, int create)
+{
+  uint64_t hash;
+  char *env, *real;
+  char dir[LINELEN * 4];
+
+  if((env = getenv("ATOMIX_CACHE_DIR")) != NULL)
+  {
+    if(strlen(env) == 0 || strlen(env) > sizeof dir - 1)
+      return EXIT_FAILURE;
+    strcpy(dir, env);
+  }
+  else
+  {
+    if((env = getenv("HOME")) == NULL || strlen(env) > sizeof dir - 16)
+      return EXIT_FAILURE;
+    sprintf(dir, "%s/.cache", env);
+    if(create)
+      mkdir(dir, 0755);
+    strcat(dir, "/atomix");
+  }
+
+  if(create)
+    mkdir(dir, 0755);
+
+  if((real = realpath(masterfile, NULL)) == NULL)
+    return EXIT_FAILURE;
+  hash = fnv_hash(FNV_OFFSET, real, strlen(real));
+  free(real);
+
+  sprintf(path, "%s/snapshot_%016llx.bin", dir, (unsigned long long) hash);
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Write a block of data, prefixed by its size, to a snapshot.
+ *
+ * ************************************************************************** */
+
+static int
+write_block(FILE *fptr, const void *data, uint64_t size)
+{
+  if(fwrite(&size, sizeof size, 1, fptr) != 1)
+    return EXIT_FAILURE;
+  if(size > 0 && fwrite(data, size, 1, fptr) != 1)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Copy a block of data out of a mapped snapshot.
+ *
+ * @param[in,out]  cursor  The current position in the snapshot
+ * @param[in]      end     The end of the snapshot
+ * @param[out]     data    Where to copy the block, or NULL to only return it
+ * @param[in]      size    The expected size of the block
+ *
+ * @return  A pointer to the block in the snapshot, or NULL if the block is
+ *          not the expected size
+ *
+ * ************************************************************************** */
+
+static const char *
+read_block(const char **cursor, const char *end, void *data, uint64_t size)
+{
+  uint64_t stored;
+  const char *block;
+
+  if(end - *cursor < (long) sizeof stored)
+    return NULL;
+  memcpy(&stored, *cursor, sizeof stored);
+  *cursor += sizeof stored;
+
+  if(stored != size || (uint64_t) (end - *cursor) < size)
+    return NULL;
+
+  block = *cursor;
+  if(data != NULL && size > 0)
+    memcpy(data, block, size);
+  *cursor += size;
+
+  return block;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Convert an array of pointers into an array of indices.
+ *
+ * ************************************************************************** */
+
+#define POINTERS_TO_INDICES(indices, pointers, base, n) \
+{ \
+  int _i; \
+  for(_i = 0; _i < (n); ++_i) \
+    (indices)[_i] = (int) ((pointers)[_i] - (base)); \
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Save a snapshot of the atomic data which has just been read in.
+ *
+ * @param[in]  masterfile     The full path to the masterfile
+ * @param[in]  use_relative   If TRUE, the data file paths are used as is
+ * @param[in]  first_summary  The first line of the atomic summary which was
+ *                            created whilst reading the data
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the snapshot was not written
+ *
+ * @details
+ *
+ * The snapshot is written to a temporary file which is renamed once complete,
+ * so an interrupted write never leaves a partial snapshot in the cache.
+ * Frequency ordered pointer arrays are stored as indices, and the x-sections
+ * are stored with the pools of points their offsets index into.
+ *
+ * ************************************************************************** */
+
+int
+save_atomic_snapshot(char *masterfile, int use_relative, int first_summary)
+{
+  int i, error;
+  int nindex;
+  int *indices;
+  uint64_t len;
+  FILE *fptr;
+  Snapshot_t header;
+  char path[LINELEN * 4];
+  char tmp_path[LINELEN * 4 + 32];
+
+  if(get_snapshot_path(masterfile, path, TRUE))
+    return EXIT_FAILURE;
+
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+  header.version = SNAPSHOT_VERSION;
+  if(fingerprint_atomic_data(masterfile, use_relative, &header.fingerprint))
+    return EXIT_FAILURE;
+
+  header.nelements = nelements;
+  header.nions = nions;
+  header.nlevels = nlevels;
+  header.nlte_levels = nlte_levels;
+  header.nlevels_macro = nlevels_macro;
+  header.nlines = nlines;
+  header.nlines_macro = nlines_macro;
+  header.nxphot = nxphot;
+  header.ntop_phot = ntop_phot;
+  header.nphot_total = nphot_total;
+  header.n_inner_tot = n_inner_tot;
+  header.n_coll_stren = n_coll_stren;
+  header.nxsection_points = nxsection_points;
+  header.ndrecomb = ndrecomb;
+  header.n_total_rr = n_total_rr;
+  header.n_bad_gs_rr = n_bad_gs_rr;
+  header.n_dere_di_rate = n_dere_di_rate;
+  header.gaunt_n_gsqrd = gaunt_n_gsqrd;
+  header.nsummary = ATOMIC_BUFFER.nlines - first_summary;
+  for(i = 0; i < NMACRO_JUMPS; ++i)
+    header.nmacro_jumps[i] = nmacro_jumps[i];
+  header.rho2nh = rho2nh;
+  header.phot_freq_min = phot_freq_min;
+  header.inner_freq_min = inner_freq_min;
+
+  nindex = MAX(nlines, MAX(nphot_total, n_inner_tot));
+  if((indices = malloc((nindex + 1) * sizeof(int))) == NULL)
+    return EXIT_FAILURE;
+
+  sprintf(tmp_path, "%s.%ld.tmp", path, (long) getpid());
+  if((fptr = fopen(tmp_path, "wb")) == NULL)
+  {
+    logfile("save_atomic_snapshot: unable to open %s\n", tmp_path);
+    free(indices);
+    return EXIT_FAILURE;
+  }
+
+  error = write_block(fptr, &header, sizeof header);
+  error |= write_block(fptr, ele, nelements * sizeof(ele_dummy));
+  error |= write_block(fptr, ions, nions * sizeof(ion_dummy));
+  error |= write_block(fptr, ion_links, nions * sizeof(ion_links_dummy));
+  error |= write_block(fptr, config, nlevels * sizeof(config_dummy));
+  for(i = 0; i < NMACRO_JUMPS; ++i)
+    error |= write_block(fptr, macro_jumps[i], nmacro_jumps[i] * sizeof(int));
+  error |= write_block(fptr, line, nlines * sizeof(line_dummy));
+  error |= write_block(fptr, line_links, nlines * sizeof(line_links_dummy));
+  POINTERS_TO_INDICES(indices, lin_ptr, line, nlines);
+  error |= write_block(fptr, indices, nlines * sizeof(int));
+  error |= write_block(fptr, phot_top, nphot_total * sizeof(Topbase_phot));
+  POINTERS_TO_INDICES(indices, phot_top_ptr, phot_top, nphot_total);
+  error |= write_block(fptr, indices, nphot_total * sizeof(int));
+  error |= write_block(fptr, inner_cross, n_inner_tot * sizeof(Topbase_phot));
+  POINTERS_TO_INDICES(indices, inner_cross_ptr, inner_cross, n_inner_tot);
+  error |= write_block(fptr, indices, n_inner_tot * sizeof(int));
+  error |= write_block(fptr, xsection_freq, nxsection_points * sizeof(double));
+  error |= write_block(fptr, xsection_x, nxsection_points * sizeof(double));
+  error |= write_block(fptr, inner_elec_yield, n_inner_tot * sizeof(Inner_elec_yield));
+  error |= write_block(fptr, coll_stren, n_coll_stren * sizeof(Coll_stren));
+  error |= write_block(fptr, ground_frac, nions * sizeof(struct ground_fracs));
+  error |= write_block(fptr, drecomb, ndrecomb * sizeof(Drecomb));
+  error |= write_block(fptr, total_rr, n_total_rr * sizeof(Total_rr));
+  error |= write_block(fptr, bad_gs_rr, n_bad_gs_rr * sizeof(Bad_gs_rr));
+  error |= write_block(fptr, dere_di_rate, n_dere_di_rate * sizeof(Dere_di_rate));
+  error |= write_block(fptr, gaunt_total, gaunt_n_gsqrd * sizeof(Gaunt_total));
+
+  for(i = first_summary; i < ATOMIC_BUFFER.nlines; ++i)
+  {
+    len = strlen(ATOMIC_BUFFER.lines[i].chars);
+    error |= write_block(fptr, ATOMIC_BUFFER.lines[i].chars, len);
+  }
+
+  free(indices);
+  error |= fclose(fptr) != 0;
+
+  if(error || rename(tmp_path, path) != 0)
+  {
+    logfile("save_atomic_snapshot: unable to write snapshot %s\n", path);
+    remove(tmp_path);
+    return EXIT_FAILURE;
+  }
+
+  logfile("save_atomic_snapshot: saved atomic data snapshot to %s\n", path);
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read the index block of a frequency ordered pointer array.
+ *
+ * @param[in,out]  cursor    The current position in the snapshot
+ * @param[in]      end       The end of the snapshot
+ * @param[out]     pointers  The pointer array to restore, or NULL to only
+ *                           check the indices
+ * @param[in]      base      The array the pointers point into
+ * @param[in]      stride    The size of each element of base
+ * @param[in]      n         The number of pointers
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the block is the wrong size or an
+ *          index is out of range
+ *
+ * ************************************************************************** */
+
+static int
+read_pointer_block(const char **cursor, const char *end, void **pointers, char *base, size_t stride, int n)
+{
+  int i, index;
+  const char *block;
+
+  if((block = read_block(cursor, end, NULL, n * sizeof(int))) == NULL)
+    return EXIT_FAILURE;
+
+  for(i = 0; i < n; ++i)
+  {
+    memcpy(&index, block + i * sizeof(int), sizeof(int));
+    if(index < 0 || index >= n)
+      return EXIT_FAILURE;
+    if(pointers != NULL)
+      pointers[i] = base + index * stride;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Check a range of entries in a table lies within the table.
+ *
+ * @param[in]  first  The first entry in the range
+ * @param[in]  n      The number of entries in the range, where a range with
+ *                    none is always valid
+ * @param[in]  size   The number of entries in the table
+ *
+ * @return  TRUE if the range is valid, otherwise FALSE
+ *
+ * ************************************************************************** */
+
+static int
+valid_range(int first, int n, int size)
+{
+  return n <= 0 || (first >= 0 && first <= size - n);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read the block of ions, checking their indices into the element and
+ *         level tables.
+ *
+ * @param[in,out]  cursor  The current position in the snapshot
+ * @param[in]      end     The end of the snapshot
+ * @param[out]     data    The ions to restore, or NULL to only check the block
+ * @param[in]      header  The header of the snapshot
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the block is the wrong size or an
+ *          index is out of range
+ *
+ * ************************************************************************** */
+
+static int
+read_ion_block(const char **cursor, const char *end, IonPtr data, const Snapshot_t *header)
+{
+  int i;
+  const char *block;
+  ion_dummy entry;
+
+  if((block = read_block(cursor, end, data, header->nions * sizeof(ion_dummy))) == NULL)
+    return EXIT_FAILURE;
+
+  for(i = 0; i < header->nions; ++i)
+  {
+    memcpy(&entry, block + i * sizeof(ion_dummy), sizeof(ion_dummy));
+    if(entry.nelem < 0 || entry.nelem >= header->nelements ||
+       !valid_range(entry.firstlevel, entry.nlevels, header->nlevels) ||
+       !valid_range(entry.first_nlte_level, entry.nlte, header->nlevels))
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read the block of configurations, checking their ion and where their
+ *         Macro Atom jumps are.
+ *
+ * @param[in,out]  cursor  The current position in the snapshot
+ * @param[in]      end     The end of the snapshot
+ * @param[out]     data    The configurations to restore, or NULL to only check
+ *                         the block
+ * @param[in]      header  The header of the snapshot
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the block is the wrong size or an
+ *          index is out of range
+ *
+ * ************************************************************************** */
+
+static int
+read_config_block(const char **cursor, const char *end, ConfigPtr data, const Snapshot_t *header)
+{
+  int i;
+  const char *block;
+  config_dummy entry;
+
+  if((block = read_block(cursor, end, data, header->nlevels * sizeof(config_dummy))) == NULL)
+    return EXIT_FAILURE;
+
+  for(i = 0; i < header->nlevels; ++i)
+  {
+    memcpy(&entry, block + i * sizeof(config_dummy), sizeof(config_dummy));
+    if(entry.nion < 0 || entry.nion >= header->nions || entry.n_bbu_jump < 0 || entry.n_bbd_jump < 0 ||
+       entry.n_bfu_jump < 0 || entry.n_bfd_jump < 0 ||
+       !valid_range(entry.jump_start[JUMP_BB_UP], entry.n_bbu_jump, header->nmacro_jumps[JUMP_BB_UP]) ||
+       !valid_range(entry.jump_start[JUMP_BB_DOWN], entry.n_bbd_jump, header->nmacro_jumps[JUMP_BB_DOWN]) ||
+       !valid_range(entry.jump_start[JUMP_BF_UP], entry.n_bfu_jump, header->nmacro_jumps[JUMP_BF_UP]) ||
+       !valid_range(entry.jump_start[JUMP_BF_DOWN], entry.n_bfd_jump, header->nmacro_jumps[JUMP_BF_DOWN]))
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read the block of Macro Atom jumps of one kind, checking each jump
+ *         is to a line or x-section.
+ *
+ * @param[in,out]  cursor   The current position in the snapshot
+ * @param[in]      end      The end of the snapshot
+ * @param[out]     data     The jumps to restore, or NULL to only check the
+ *                          block
+ * @param[in]      n        The number of jumps
+ * @param[in]      ntarget  The number of lines or x-sections the jumps are to
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the block is the wrong size or a
+ *          jump is out of range
+ *
+ * ************************************************************************** */
+
+static int
+read_jump_block(const char **cursor, const char *end, int *data, int n, int ntarget)
+{
+  int i, jump;
+  const char *block;
+
+  if((block = read_block(cursor, end, data, n * sizeof(int))) == NULL)
+    return EXIT_FAILURE;
+
+  for(i = 0; i < n; ++i)
+  {
+    memcpy(&jump, block + i * sizeof(int), sizeof(int));
+    if(jump < 0 || jump >= ntarget)
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read the block of lines, checking their ion and levels.
+ *
+ * @param[in,out]  cursor  The current position in the snapshot
+ * @param[in]      end     The end of the snapshot
+ * @param[out]     data    The lines to restore, or NULL to only check the block
+ * @param[in]      header  The header of the snapshot
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the block is the wrong size or an
+ *          index is out of range
+ *
+ * @details
+ *
+ * A line which was not matched to a level has a negative level, so only the
+ * upper bound of the levels is checked.
+ *
+ * ************************************************************************** */
+
+static int
+read_line_block(const char **cursor, const char *end, LinePtr data, const Snapshot_t *header)
+{
+  int i;
+  const char *block;
+  line_dummy entry;
+
+  if((block = read_block(cursor, end, data, header->nlines * sizeof(line_dummy))) == NULL)
+    return EXIT_FAILURE;
+
+  for(i = 0; i < header->nlines; ++i)
+  {
+    memcpy(&entry, block + i * sizeof(line_dummy), sizeof(line_dummy));
+    if(entry.nion < 0 || entry.nion >= header->nions || entry.nconfigl >= header->nlevels ||
+       entry.nconfigu >= header->nlevels)
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read a block of x-sections, checking their ion, levels and points.
+ *
+ * @param[in,out]  cursor    The current position in the snapshot
+ * @param[in]      end       The end of the snapshot
+ * @param[out]     xsection  The x-sections to restore, or NULL to only check
+ *                           the block
+ * @param[in]      n         The number of x-sections
+ * @param[in]      header    The header of the snapshot
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the block is the wrong size or an
+ *          index is out of range
+ *
+ * @details
+ *
+ * As for the lines, an x-section which is not for a level has a negative
+ * level, so only the upper bound of the levels is checked. The points must lie
+ * in the pools, but the pointers to them are not valid until
+ * update_xsection_pointers() has been called. A snapshot stores every
+ * x-section in full, so the packed pointers are cleared as they are copied.
+ *
+ * ************************************************************************** */
+
+static int
+read_xsection_block(const char **cursor, const char *end, Topbase_phot *xsection, int n, const Snapshot_t *header)
+{
+  int i;
+  const char *block;
+  Topbase_phot entry;
+
+  if((block = read_block(cursor, end, xsection, n * sizeof(Topbase_phot))) == NULL)
+    return EXIT_FAILURE;
+
+  for(i = 0; i < n; ++i)
+  {
+    memcpy(&entry, block + i * sizeof(Topbase_phot), sizeof(Topbase_phot));
+    if(entry.nion < 0 || entry.nion >= header->nions || entry.nlev >= header->nlevels ||
+       entry.uplev >= header->nlevels || entry.offset < 0 || entry.np > NCROSS ||
+       entry.offset > header->nxsection_points - MAX(entry.np, 0))
+      return EXIT_FAILURE;
+    if(xsection != NULL)
+      xsection[i].packed = NULL;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read the data blocks which follow the header of a snapshot.
+ *
+ * @param[in]  header  The header of the snapshot
+ * @param[in]  cursor  The position of the first block in the snapshot
+ * @param[in]  end     The end of the snapshot
+ * @param[in]  copy    If FALSE the blocks are only checked, otherwise they are
+ *                     copied into the atomic data structures
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if a block is malformed
+ *
+ * @details
+ *
+ * This is done in two passes, first without copying, so that a malformed
+ * snapshot is detected before any of the atomic data has been overwritten. As
+ * well as the size of each block, the indices the records hold into the other
+ * tables are checked, so a damaged snapshot cannot send the queries outside
+ * of a table.
+ *
+ * ************************************************************************** */
+
+static int
+read_snapshot_blocks(const Snapshot_t *header, const char *cursor, const char *end, int copy)
+{
+  int i;
+  int error = FALSE;
+  uint64_t len;
+  const char *block;
+  char *summary;
+
+#define SNAPSHOT_DATA(array) (copy ? (void *) (array) : NULL)
+
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(ele), header->nelements * sizeof(ele_dummy)) == NULL;
+  error |= read_ion_block(&cursor, end, SNAPSHOT_DATA(ions), header);
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(ion_links), header->nions * sizeof(ion_links_dummy)) == NULL;
+  error |= read_config_block(&cursor, end, SNAPSHOT_DATA(config), header);
+  for(i = 0; i < NMACRO_JUMPS; ++i)
+    error |= read_jump_block(&cursor, end, SNAPSHOT_DATA(macro_jumps[i]), header->nmacro_jumps[i],
+                             i == JUMP_BB_UP || i == JUMP_BB_DOWN ? header->nlines : header->nphot_total);
+  error |= read_line_block(&cursor, end, SNAPSHOT_DATA(line), header);
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(line_links), header->nlines * sizeof(line_links_dummy)) == NULL;
+  error |= read_pointer_block(&cursor, end, SNAPSHOT_DATA(lin_ptr), (char *) line, sizeof(line_dummy),
+                              header->nlines);
+  error |= read_xsection_block(&cursor, end, SNAPSHOT_DATA(phot_top), header->nphot_total, header);
+  error |= read_pointer_block(&cursor, end, SNAPSHOT_DATA(phot_top_ptr), (char *) phot_top, sizeof(Topbase_phot),
+                              header->nphot_total);
+  error |= read_xsection_block(&cursor, end, SNAPSHOT_DATA(inner_cross), header->n_inner_tot, header);
+  error |= read_pointer_block(&cursor, end, SNAPSHOT_DATA(inner_cross_ptr), (char *) inner_cross,
+                              sizeof(Topbase_phot), header->n_inner_tot);
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(xsection_freq), header->nxsection_points * sizeof(double)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(xsection_x), header->nxsection_points * sizeof(double)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(inner_elec_yield),
+                      header->n_inner_tot * sizeof(Inner_elec_yield)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(coll_stren), header->n_coll_stren * sizeof(Coll_stren)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(ground_frac), header->nions * sizeof(struct ground_fracs)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(drecomb), header->ndrecomb * sizeof(Drecomb)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(total_rr), header->n_total_rr * sizeof(Total_rr)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(bad_gs_rr), header->n_bad_gs_rr * sizeof(Bad_gs_rr)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(dere_di_rate),
+                      header->n_dere_di_rate * sizeof(Dere_di_rate)) == NULL;
+  error |= read_block(&cursor, end, SNAPSHOT_DATA(gaunt_total), header->gaunt_n_gsqrd * sizeof(Gaunt_total)) == NULL;
+
+#undef SNAPSHOT_DATA
+
+  /*
+   * The summary lines are stored as size prefixed strings, so their size has
+   * to be peeked at before the block is read
+   */
+
+  for(i = 0; i < header->nsummary && !error; ++i)
+  {
+    if(end - cursor < (long) sizeof len)
+      return EXIT_FAILURE;
+    memcpy(&len, cursor, sizeof len);
+    if((block = read_block(&cursor, end, NULL, len)) == NULL)
+      return EXIT_FAILURE;
+    if(copy)
+    {
+      if((summary = malloc(len + 1)) == NULL)
+        return EXIT_FAILURE;
+      memcpy(summary, block, len);
+      summary[len] = '\0';
+      atomic_summary_add("%s", summary);
+      free(summary);
+    }
+  }
+
+  return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Restore the atomic data from a snapshot, if a valid one exists.
+ *
+ * @param[in]  masterfile    The full path to the masterfile
+ * @param[in]  use_relative  If TRUE, the data file paths are used as is
+ *
+ * @return  EXIT_SUCCESS if the atomic data was restored, otherwise
+ *          EXIT_FAILURE and the atomic data has to be parsed as normal
+ *
+ * @details
+ *
+ * The structures must have already been allocated and initialised by
+ * get_atomic_data(), as only the entries which were filled when the snapshot
+ * was made are copied. No data is copied unless the whole snapshot is valid,
+ * but the tables are grown to the size of the snapshot first, and if that
+ * fails part way some of them will have been enlarged. They are still empty
+ * and initialised, so the data can be parsed as normal. If the restored data
+ * cannot be indexed, the atomic data is emptied again so it can be parsed from
+ * the start.
+ *
+ * ************************************************************************** */
+
+int
+load_atomic_snapshot(char *masterfile, int use_relative)
+{
+  int fd;
+  uint64_t fingerprint;
+  size_t size;
+  struct stat st;
+  const char *map, *cursor, *end;
+  Snapshot_t header;
+  char path[LINELEN * 4];
+
+  if(get_snapshot_path(masterfile, path, FALSE))
+    return EXIT_FAILURE;
+
+  if((fd = open(path, O_RDONLY)) < 0)
+    return EXIT_FAILURE;
+
+  if(fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof header)
+  {
+    close(fd);
+    return EXIT_FAILURE;
+  }
+
+  size = (size_t) st.st_size;
+  map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if(map == MAP_FAILED)
+    return EXIT_FAILURE;
+
+  cursor = map;
+  end = map + size;
+
+  if(read_block(&cursor, end, &header, sizeof header) == NULL ||
+     memcmp(header.magic, SNAPSHOT_MAGIC, sizeof header.magic) != 0 || header.version != SNAPSHOT_VERSION ||
+     fingerprint_atomic_data(masterfile, use_relative, &fingerprint) || fingerprint != header.fingerprint)
+  {
+    munmap((void *) map, size);
+    return EXIT_FAILURE;
+  }
+
+  if(header.nelements < 0 || header.nelements > NELEMENTS || header.nions < 0 || header.nlevels < 0 ||
+     header.nlines < 0 || header.nphot_total < 0 || header.n_inner_tot < 0 || header.n_coll_stren < 0 ||
+     header.ndrecomb < 0 || header.n_total_rr < 0 || header.n_bad_gs_rr < 0 || header.n_dere_di_rate < 0 ||
+     header.gaunt_n_gsqrd < 0 || header.gaunt_n_gsqrd > MAX_GAUNT_N_GSQRD || header.nxsection_points < 1 ||
+     header.nmacro_jumps[JUMP_BB_UP] < 0 || header.nmacro_jumps[JUMP_BB_DOWN] < 0 ||
+     header.nmacro_jumps[JUMP_BF_UP] < 0 || header.nmacro_jumps[JUMP_BF_DOWN] < 0 ||
+     read_snapshot_blocks(&header, cursor, end, FALSE))
+  {
+    logfile("load_atomic_snapshot: snapshot %s is corrupt, it will be rebuilt\n", path);
+    munmap((void *) map, size);
+    return EXIT_FAILURE;
+  }
+
+  if(resize_xsection_points(header.nxsection_points) || grow_ions(header.nions + 2) ||
+     grow_levels(header.nlevels + 2) || grow_lines(header.nlines + 2) || grow_coll_stren(header.n_coll_stren + 2) ||
+     grow_phot_top(header.nphot_total + 2) || grow_inner_cross(header.n_inner_tot + 2) ||
+     grow_drecomb(header.ndrecomb + 2) || grow_total_rr(header.n_total_rr + 2) ||
+     grow_bad_gs_rr(header.n_bad_gs_rr + 2) || grow_dere_di_rate(header.n_dere_di_rate + 2) ||
+     resize_macro_jumps(header.nmacro_jumps))
+  {
+    munmap((void *) map, size);
+    return EXIT_FAILURE;
+  }
+
+  read_snapshot_blocks(&header, cursor, end, TRUE);
+  munmap((void *) map, size);
+
+  nelements = header.nelements;
+  nions = header.nions;
+  nlevels = header.nlevels;
+  nlte_levels = header.nlte_levels;
+  nlevels_macro = header.nlevels_macro;
+  nlines = header.nlines;
+  nlines_macro = header.nlines_macro;
+  nxphot = header.nxphot;
+  ntop_phot = header.ntop_phot;
+  nphot_total = header.nphot_total;
+  n_inner_tot = header.n_inner_tot;
+  n_coll_stren = header.n_coll_stren;
+  nxsection_points = header.nxsection_points;
+  ndrecomb = header.ndrecomb;
+  n_total_rr = header.n_total_rr;
+  n_bad_gs_rr = header.n_bad_gs_rr;
+  n_dere_di_rate = header.n_dere_di_rate;
+  gaunt_n_gsqrd = header.gaunt_n_gsqrd;
+  rho2nh = header.rho2nh;
+  phot_freq_min = header.phot_freq_min;
+  inner_freq_min = header.inner_freq_min;
+  update_xsection_pointers();
+  rebuild_lookup_tables();
+  if(build_line_columns() || build_posting_lists() || build_species_stats() || build_strongest_index() ||
+     build_coverage_index() || build_lower_level_index() || build_level_links())
+  {
+    logfile("load_atomic_snapshot: unable to index the data restored from %s, it will be parsed again\n", path);
+    reset_atomic_data();
+    return EXIT_FAILURE;
+  }
+
+  logfile("load_atomic_snapshot: restored atomic data from snapshot %s\n", path);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,275 @@
+/* ************************************************************************** */
+/**
+ * @file     sort.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * A stable, parallel sort for putting the atomic data into frequency order.
+ *
+ * @details
+ *
+ * The sort is a merge sort on double keys, which produces the order of the
+ * keys rather than moving them, so the same routine can be used for the lines
+ * and both types of x-section. As it is stable, keys which are equal stay in
+ * the order they were read in.
+ *
+ * Large arrays are split into one run for each core, which are sorted at the
+ * same time and then merged together in pairs, again with a thread for each
+ * pair.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "atomix.h"
+
+#define SORT_INSERTION_MAX 16   /* Runs this short are sorted by insertion */
+#define SORT_PARALLEL_MIN 32768 /* The shortest run which is given its own thread */
+#define SORT_MAX_THREADS 64
+
+typedef struct SortJob_t
+{
+  const double *keys;
+  int *order;
+  int *scratch;
+  int lo;
+  int mid;
+  int hi;
+} SortJob_t;
+
+/* ************************************************************************** */
+/**
+ * @brief  Merge two sorted runs of an order into one.
+ *
+ * @param[in]   keys  The keys being sorted
+ * @param[in]   src   The order containing the runs [lo, mid) and [mid, hi)
+ * @param[out]  dst   The order to put the merged run [lo, hi) in
+ * @param[in]   lo    The start of the first run
+ * @param[in]   mid   The start of the second run
+ * @param[in]   hi    The end of the second run
+ *
+ * @details
+ *
+ * An entry from the second run only goes first if its key is strictly less,
+ * which is what keeps the sort stable.
+ *
+ * ************************************************************************** */
+
+static void
+merge_runs(const double *keys, const int *src, int *dst, int lo, int mid, int hi)
+{
+  int i = lo;
+  int j = mid;
+  int k = lo;
+
+  while(i < mid && j < hi)
+  {
+    if(keys[src[j]] < keys[src[i]])
+      dst[k++] = src[j++];
+    else
+      dst[k++] = src[i++];
+  }
+
+  while(i < mid)
+    dst[k++] = src[i++];
+  while(j < hi)
+    dst[k++] = src[j++];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Sort a run of an order, using a copy of it as scratch space.
+ *
+ * @param[in]      keys  The keys being sorted
+ * @param[in,out]  src   A copy of the run, which is overwritten
+ * @param[in,out]  dst   The run to sort
+ * @param[in]      lo    The start of the run
+ * @param[in]      hi    The end of the run
+ *
+ * @details
+ *
+ * src and dst have to hold the same entries on the way in. Each level of the
+ * recursion swaps the two, so that nothing has to be copied back.
+ *
+ * ************************************************************************** */
+
+static void
+sort_run(const double *keys, int *src, int *dst, int lo, int hi)
+{
+  int i, j, entry, mid;
+
+  if(hi - lo <= SORT_INSERTION_MAX)
+  {
+    for(i = lo + 1; i < hi; ++i)
+    {
+      entry = dst[i];
+      for(j = i; j > lo && keys[entry] < keys[dst[j - 1]]; --j)
+        dst[j] = dst[j - 1];
+      dst[j] = entry;
+    }
+    return;
+  }
+
+  mid = lo + (hi - lo) / 2;
+  sort_run(keys, dst, src, lo, mid);
+  sort_run(keys, dst, src, mid, hi);
+  merge_runs(keys, src, dst, lo, mid, hi);
+}
+
+static void *
+sort_run_worker(void *arg)
+{
+  SortJob_t *job = arg;
+
+  sort_run(job->keys, job->scratch, job->order, job->lo, job->hi);
+
+  return NULL;
+}
+
+static void *
+merge_runs_worker(void *arg)
+{
+  SortJob_t *job = arg;
+
+  merge_runs(job->keys, job->scratch, job->order, job->lo, job->mid, job->hi);
+
+  return NULL;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Run a set of sort jobs, one per thread.
+ *
+ * @param[in]  worker  The work to do for each job
+ * @param[in]  jobs    The jobs
+ * @param[in]  njobs   The number of jobs
+ *
+ * @details
+ *
+ * The first job is done on the calling thread, as are any jobs which a thread
+ * could not be created for.
+ *
+ * ************************************************************************** */
+
+static void
+run_sort_jobs(void *(*worker)(void *), SortJob_t *jobs, int njobs)
+{
+  int i;
+  int started[SORT_MAX_THREADS];
+  pthread_t threads[SORT_MAX_THREADS];
+
+  for(i = 1; i < njobs; ++i)
+    started[i] = pthread_create(&threads[i], NULL, worker, &jobs[i]) == 0;
+
+  worker(&jobs[0]);
+
+  for(i = 1; i < njobs; ++i)
+  {
+    if(started[i])
+      pthread_join(threads[i], NULL);
+    else
+      worker(&jobs[i]);
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the order which sorts an array of keys into ascending order.
+ *
+ * @param[in]   n      The number of keys
+ * @param[in]   keys   The keys to sort
+ * @param[out]  order  The index of each key in sorted order, so that
+ *                     keys[order[0]] is the smallest
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * The sort is stable, so keys which are equal keep their original order.
+ *
+ * The keys are split into as many runs as there are cores, as long as each
+ * run is at least SORT_PARALLEL_MIN keys long. Each run is sorted on its own
+ * thread, and then neighbouring runs are merged in pairs until only one is
+ * left.
+ *
+ * ************************************************************************** */
+
+int
+sort_by_key(int n, const double *keys, int *order)
+{
+  int i, nruns, width;
+  long ncores;
+  int *result, *scratch, *tmp;
+  SortJob_t jobs[SORT_MAX_THREADS];
+
+  for(i = 0; i < n; ++i)
+    order[i] = i;
+
+  if(n < 2)
+    return EXIT_SUCCESS;
+
+  if((scratch = malloc(n * sizeof(int))) == NULL)
+    return EXIT_FAILURE;
+  memcpy(scratch, order, n * sizeof(int));
+  result = order;
+
+  ncores = n >= 2 * SORT_PARALLEL_MIN ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+  nruns = 1;
+  while(2 * nruns <= ncores && 2 * nruns <= SORT_MAX_THREADS && n / (2 * nruns) >= SORT_PARALLEL_MIN)
+    nruns *= 2;
+
+  for(i = 0; i < nruns; ++i)
+  {
+    jobs[i].keys = keys;
+    jobs[i].order = order;
+    jobs[i].scratch = scratch;
+    jobs[i].lo = (int) ((long) n * i / nruns);
+    jobs[i].hi = (int) ((long) n * (i + 1) / nruns);
+  }
+
+  run_sort_jobs(sort_run_worker, jobs, nruns);
+
+  /*
+   * Merge the sorted runs in pairs, swapping between the two arrays each time.
+   * As nruns is a power of two, every run always has a partner
+   */
+
+  for(width = 1; width < nruns; width *= 2)
+  {
+    tmp = order;
+    order = scratch;
+    scratch = tmp;
+
+    for(i = 0; i < nruns / (2 * width); ++i)
+    {
+      jobs[i].keys = keys;
+      jobs[i].order = order;
+      jobs[i].scratch = scratch;
+      jobs[i].lo = (int) ((long) n * (2 * i * width) / nruns);
+      jobs[i].mid = (int) ((long) n * ((2 * i + 1) * width) / nruns);
+      jobs[i].hi = (int) ((long) n * ((2 * i + 2) * width) / nruns);
+    }
+
+    run_sort_jobs(merge_runs_worker, jobs, nruns / (2 * width));
+  }
+
+  /*
+   * If there were an odd number of merge passes, the result is in the array
+   * which was allocated as scratch space, so has to be copied back
+   */
+
+  if(order != result)
+  {
+    memcpy(result, order, n * sizeof(int));
+    scratch = order;
+  }
+
+  free(scratch);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,559 @@
+/* ************************************************************************** */
+/**
+ * @file     stats.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Totals over the lines and edges of each element and ion.
+ *
+ * @details
+ *
+ * The number of lines and edges, the wavelength range, the sum of gf, the
+ * strongest line and how many of the lines are macro atom lines or have a
+ * collision strength are worked out for every element and ion once the
+ * posting lists have been built. Each element or ion only needs its own
+ * posting lists, so they are shared out between threads and all worked out in
+ * one pass.
+ *
+ * The totals can be looked at for one element or ion, or as a table of all of
+ * them sorted by one of the totals, to see which dominate the atomic data.
+ *
+ * ************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "atomix.h"
+
+#define STATS_PARALLEL_MIN 65536  /* The fewest lines and edges which are worth using threads for */
+#define STATS_MAX_THREADS 64
+
+typedef struct StatsJob_t
+{
+  int first;                    /* The first species for this thread */
+  int stride;                   /* The number of threads */
+} StatsJob_t;
+
+static SpeciesStats *element_stats = NULL;
+static SpeciesStats *ion_stats = NULL;
+static int nelement_stats = 0;
+static int nion_stats = 0;
+
+static const char *stats_order_names[NSTATS_ORDERS] = {"index", "lines", "gf", "macro", "coll", "edges"};
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the element and ion totals.
+ *
+ * ************************************************************************** */
+
+void
+free_species_stats(void)
+{
+  free(element_stats);
+  free(ion_stats);
+  element_stats = NULL;
+  ion_stats = NULL;
+  nelement_stats = 0;
+  nion_stats = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Work out the totals for one element or ion from its posting lists.
+ *
+ * @param[out]  stats   The totals
+ * @param[in]   z       The atomic number of the element
+ * @param[in]   istate  The ionization state of the ion, or 0 for the element
+ *
+ * @details
+ *
+ * The posting lists are in frequency order, so the first line has the longest
+ * wavelength and the last line the shortest.
+ *
+ * ************************************************************************** */
+
+static void
+count_species(SpeciesStats *stats, int z, int istate)
+{
+  int i, j, n;
+  double gf, gf_max;
+  const int *entries;
+
+  memset(stats, 0, sizeof(*stats));
+  stats->strongest = -1;
+
+  n = find_postings(POSTING_LINES, z, istate, &entries);
+  stats->nlines = n;
+
+  if(n > 0)
+  {
+    stats->wmax = line_columns.wavelength[entries[0]];
+    stats->wmin = line_columns.wavelength[entries[n - 1]];
+  }
+
+  gf_max = -1;
+  for(i = 0; i < n; ++i)
+  {
+    j = entries[i];
+    gf = line_columns.gl[j] * line_columns.f[j];
+    stats->gf_sum += gf;
+    if(gf > gf_max)
+    {
+      gf_max = gf;
+      stats->strongest = j;
+    }
+    if(line_columns.macro_info[j] == TRUE)
+      stats->nmacro++;
+    else
+      stats->nsimple++;
+    if(line_link(lin_ptr[j])->coll_index >= 0)
+      stats->ncoll++;
+  }
+
+  stats->nphot = find_postings(POSTING_PHOT, z, istate, &entries);
+  stats->ninner = find_postings(POSTING_INNER, z, istate, &entries);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Work out the totals for every stride'th element and ion.
+ *
+ * @details
+ *
+ * The elements and ions are numbered together, with the elements first. Taking
+ * every stride'th one spreads the elements and ions with the most lines over
+ * the threads.
+ *
+ * ************************************************************************** */
+
+static void *
+stats_worker(void *arg)
+{
+  int n, nion;
+  StatsJob_t *job = arg;
+
+  for(n = job->first; n < nelements + nions; n += job->stride)
+  {
+    if(n < nelements)
+    {
+      count_species(&element_stats[n], ele[n].z, 0);
+    }
+    else
+    {
+      nion = n - nelements;
+      count_species(&ion_stats[nion], ions[nion].z, ions[nion].istate);
+    }
+  }
+
+  return NULL;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Work out the totals for every element and ion.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * This has to be called once the posting lists have been built. When there
+ * are enough lines and edges, the elements and ions are shared out between a
+ * thread for each core.
+ *
+ * ************************************************************************** */
+
+int
+build_species_stats(void)
+{
+  int i, nthreads;
+  long ncores;
+  int started[STATS_MAX_THREADS];
+  pthread_t threads[STATS_MAX_THREADS];
+  StatsJob_t jobs[STATS_MAX_THREADS];
+
+  free_species_stats();
+
+  element_stats = malloc((nelements + 1) * sizeof(SpeciesStats));
+  ion_stats = malloc((nions + 1) * sizeof(SpeciesStats));
+  if(element_stats == NULL || ion_stats == NULL)
+  {
+    free_species_stats();
+    return EXIT_FAILURE;
+  }
+
+  nelement_stats = nelements;
+  nion_stats = nions;
+
+  ncores = nlines + nphot_total + n_inner_tot >= STATS_PARALLEL_MIN ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+  nthreads = ncores < 1 ? 1 : ncores > STATS_MAX_THREADS ? STATS_MAX_THREADS : (int) ncores;
+
+  for(i = 0; i < nthreads; ++i)
+  {
+    jobs[i].first = i;
+    jobs[i].stride = nthreads;
+  }
+
+  for(i = 1; i < nthreads; ++i)
+    started[i] = pthread_create(&threads[i], NULL, stats_worker, &jobs[i]) == 0;
+
+  stats_worker(&jobs[0]);
+
+  for(i = 1; i < nthreads; ++i)
+  {
+    if(started[i])
+      pthread_join(threads[i], NULL);
+    else
+      stats_worker(&jobs[i]);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the totals for an element.
+ *
+ * @param[in]  nelem  The index of the element in ele
+ *
+ * @return  The totals, or NULL if there are none for the element
+ *
+ * ************************************************************************** */
+
+const SpeciesStats *
+get_element_stats(int nelem)
+{
+  if(nelem < 0 || nelem >= nelement_stats)
+    return NULL;
+
+  return &element_stats[nelem];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the totals for an ion.
+ *
+ * @param[in]  nion  The index of the ion in ions
+ *
+ * @return  The totals, or NULL if there are none for the ion
+ *
+ * ************************************************************************** */
+
+const SpeciesStats *
+get_ion_stats(int nion)
+{
+  if(nion < 0 || nion >= nion_stats)
+    return NULL;
+
+  return &ion_stats[nion];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the order of the totals table from its name.
+ *
+ * @param[in]  name  The name of the order, as used on the command line
+ *
+ * @return  The order, or -1 if the name is not known
+ *
+ * ************************************************************************** */
+
+int
+stats_order_from_name(const char *name)
+{
+  int order;
+
+  for(order = 0; order < NSTATS_ORDERS; ++order)
+    if(strcmp(name, stats_order_names[order]) == 0)
+      return order;
+
+  return -1;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the name of an order of the totals table.
+ *
+ * @param[in]  order  The order
+ *
+ * @return  The name of the order
+ *
+ * ************************************************************************** */
+
+const char *
+stats_order_name(int order)
+{
+  if(order < 0 || order >= NSTATS_ORDERS)
+    return "unknown";
+
+  return stats_order_names[order];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Sort the element or ion totals.
+ *
+ * @param[in]   by_element  TRUE to sort the elements, otherwise the ions
+ * @param[in]   order       How to sort them
+ * @param[out]  index       The index of each element or ion in sorted order,
+ *                          which needs room for nelements or nions entries
+ *
+ * @return  The number of elements or ions, or -1 if memory could not be
+ *          allocated
+ *
+ * @details
+ *
+ * Apart from STATS_BY_INDEX, the largest come first. As the sort is stable,
+ * those which are equal stay in index order.
+ *
+ * ************************************************************************** */
+
+int
+order_species_stats(int by_element, int order, int *index)
+{
+  int i, n;
+  double *keys;
+  const SpeciesStats *stats;
+
+  n = by_element ? nelement_stats : nion_stats;
+  stats = by_element ? element_stats : ion_stats;
+
+  if((keys = malloc((n + 1) * sizeof(double))) == NULL)
+    return -1;
+
+  for(i = 0; i < n; ++i)
+  {
+    switch(order)
+    {
+    case STATS_BY_LINES:
+      keys[i] = -stats[i].nlines;
+      break;
+    case STATS_BY_GF:
+      keys[i] = -stats[i].gf_sum;
+      break;
+    case STATS_BY_MACRO:
+      keys[i] = -stats[i].nmacro;
+      break;
+    case STATS_BY_COLL:
+      keys[i] = -stats[i].ncoll;
+      break;
+    case STATS_BY_EDGES:
+      keys[i] = -(stats[i].nphot + stats[i].ninner);
+      break;
+    default:
+      keys[i] = i;
+      break;
+    }
+  }
+
+  if(sort_by_key(n, keys, index))
+    n = -1;
+
+  free(keys);
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Write the header of the totals table.
+ *
+ * @param[out]  row  The header
+ * @param[in]   len  The size of row
+ *
+ * ************************************************************************** */
+
+void
+species_stats_header(char *row, size_t len)
+{
+  snprintf(row, len, " %-6s %-8s %-8s %-8s %-8s %-8s %-10s %-12s %-12s %-12s %-6s %s", "Index", "Species", "Lines",
+           "Macro", "Simple", "Coll", "Sum gf", "Wmin", "Wmax", "Strongest", "Phot", "Inner");
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Write the row of the totals table for an element or ion.
+ *
+ * @param[out]  row         The row
+ * @param[in]   len         The size of row
+ * @param[in]   by_element  TRUE if n is an element, otherwise an ion
+ * @param[in]   n           The index of the element or ion
+ *
+ * @details
+ *
+ * The strongest line is given by its wavelength in Angstroms.
+ *
+ * ************************************************************************** */
+
+void
+species_stats_row(char *row, size_t len, int by_element, int n)
+{
+  double strongest;
+  char species[LINELEN];
+  const SpeciesStats *stats;
+
+  if(by_element)
+  {
+    stats = get_element_stats(n);
+    snprintf(species, LINELEN, "%s", ele[n].name);
+  }
+  else
+  {
+    stats = get_ion_stats(n);
+    get_element_name(ions[n].z, species);
+    snprintf(species + strlen(species), LINELEN - strlen(species), " %i", ions[n].istate);
+  }
+
+  if(stats == NULL)
+  {
+    row[0] = '\0';
+    return;
+  }
+
+  strongest = stats->strongest >= 0 ? line_columns.wavelength[stats->strongest] : 0;
+
+  snprintf(row, len, " %-6i %-8s %-8i %-8i %-8i %-8i %-10.3e %-12.2f %-12.2f %-12.2f %-6i %i", n, species,
+           stats->nlines, stats->nmacro, stats->nsimple, stats->ncoll, stats->gf_sum, stats->wmin, stats->wmax,
+           strongest, stats->nphot, stats->ninner);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the totals table for the elements or ions.
+ *
+ * @param[in]  f           The file to print to
+ * @param[in]  by_element  TRUE for the elements, otherwise the ions
+ * @param[in]  order       How to sort the table
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * ************************************************************************** */
+
+int
+print_species_stats(FILE *f, int by_element, int order)
+{
+  int i, n;
+  int *index;
+  char row[2 * LINELEN];
+
+  if((index = malloc((nions + nelements + 1) * sizeof(int))) == NULL)
+    return EXIT_FAILURE;
+
+  if((n = order_species_stats(by_element, order, index)) < 0)
+  {
+    free(index);
+    return EXIT_FAILURE;
+  }
+
+  species_stats_header(row, sizeof(row));
+  fprintf(f, "%s\n", row);
+  for(i = 0; i < n; ++i)
+  {
+    species_stats_row(row, sizeof(row), by_element, index[i]);
+    fprintf(f, "%s\n", row);
+  }
+
+  free(index);
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the totals tables for the elements and ions to stdout, for
+ *         when atomix is run without the UI.
+ *
+ * @param[in]  order  How to sort the tables
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the tables could not be printed
+ *
+ * ************************************************************************** */
+
+int
+headless_species_summary(int order)
+{
+  printf("Elements sorted by %s\n\n", stats_order_name(order));
+  if(print_species_stats(stdout, TRUE, order))
+    return EXIT_FAILURE;
+
+  printf("\nIons sorted by %s\n\n", stats_order_name(order));
+  if(print_species_stats(stdout, FALSE, order))
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Show the totals table for the elements or ions in the content view.
+ *
+ * @param[in]  by_element  TRUE for the elements, otherwise the ions
+ *
+ * @details
+ *
+ * The order of the table is queried first.
+ *
+ * ************************************************************************** */
+
+void
+species_summary(int by_element)
+{
+  int i, n, order;
+  int *index;
+  char row[2 * LINELEN];
+  const int ndash = 117;
+
+  if(query_stats_order(&order) == FORM_QUIT)
+    return;
+
+  if((index = malloc((nions + nelements + 1) * sizeof(int))) == NULL ||
+     (n = order_species_stats(by_element, order, index)) < 0)
+  {
+    free(index);
+    error_atomix("Unable to allocate memory to sort the summary");
+    return;
+  }
+
+  display_add(" %s sorted by %s", by_element ? "Elements" : "Ions", stats_order_name(order));
+  add_sep_display(ndash);
+  species_stats_header(row, sizeof(row));
+  display_add("%s", row);
+  add_sep_display(ndash);
+
+  for(i = 0; i < n; ++i)
+  {
+    species_stats_row(row, sizeof(row), by_element, index[i]);
+    display_add("%s", row);
+  }
+
+  free(index);
+
+  count(ndash, n);
+
+  display_show(SCROLL_ENABLE, true, 4);
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the element and ion totals to a memory
+ *         table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * ************************************************************************** */
+
+void
+species_stats_memory(MemoryTable *table)
+{
+  if(element_stats == NULL || ion_stats == NULL)
+    return;
+
+  account_memory(table, element_stats, (nelement_stats + 1) * sizeof(SpeciesStats),
+                 nelement_stats * sizeof(SpeciesStats));
+  account_memory(table, ion_stats, (nion_stats + 1) * sizeof(SpeciesStats), nion_stats * sizeof(SpeciesStats));
+}
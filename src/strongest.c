@@ -0,0 +1,375 @@
+/* ************************************************************************** */
+/**
+ * @file     strongest.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * An index for finding the strongest lines in a frequency range.
+ *
+ * @details
+ *
+ * The frequency ordered line list is split into blocks of STRONGEST_BLOCK
+ * lines. For each measure of line strength, a sparse table holds the
+ * strongest line in every run of 1, 2, 4, ... blocks, so the strongest line in
+ * any range of lines is found by looking at the two runs of blocks which cover
+ * the middle of the range, and the lines in the partial blocks at each end.
+ *
+ * The k strongest lines are then found by taking the strongest line in the
+ * range, splitting the range either side of it and putting both halves into a
+ * heap ordered by the strongest line in each. Taking from the heap k times
+ * gives the k strongest lines, strongest first, having looked at no more than
+ * 2k + 1 ranges, however many lines the range has in it.
+ *
+ * ************************************************************************** */
+
+#include <stdlib.h>
+
+#include "atomix.h"
+
+#define STRONGEST_BLOCK 32      /* The number of lines in each block */
+
+typedef struct StrengthIndex_t
+{
+  double *strength;             /* The strength of each line in frequency order */
+  int *table;                   /* The strongest line in each run of blocks, ntable_rows rows of nblocks */
+} StrengthIndex_t;
+
+typedef struct Candidate_t
+{
+  int line;                     /* The strongest line in the range */
+  int first;                    /* The first line in the range */
+  int end;                      /* One past the last line in the range */
+} Candidate_t;
+
+static StrengthIndex_t strength_index[NSTRENGTHS];
+static int nindexed = 0;
+static int nblocks = 0;
+static int ntable_rows = 0;
+
+/* ************************************************************************** */
+/**
+ * @brief  Free the strongest line index.
+ *
+ * ************************************************************************** */
+
+void
+free_strongest_index(void)
+{
+  int s;
+
+  for(s = 0; s < NSTRENGTHS; ++s)
+  {
+    free(strength_index[s].strength);
+    free(strength_index[s].table);
+    strength_index[s].strength = NULL;
+    strength_index[s].table = NULL;
+  }
+
+  nindexed = 0;
+  nblocks = 0;
+  ntable_rows = 0;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Pick the stronger of two lines.
+ *
+ * @details
+ *
+ * Lines of equal strength are decided by frequency, so the results do not
+ * depend on the order lines are looked at in.
+ *
+ * ************************************************************************** */
+
+static inline int
+stronger(const double *strength, int a, int b)
+{
+  if(strength[a] > strength[b] || (strength[a] == strength[b] && a < b))
+    return a;
+
+  return b;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the strongest line by scanning a range of lines.
+ *
+ * ************************************************************************** */
+
+static int
+scan_strongest(const double *strength, int first, int end)
+{
+  int i;
+  int best = first;
+
+  for(i = first + 1; i < end; ++i)
+    best = stronger(strength, best, i);
+
+  return best;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Build the strongest line index for the frequency ordered lines.
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * This has to be called once the line columns have been built. The A
+ * coefficients are worked out with a21().
+ *
+ * ************************************************************************** */
+
+int
+build_strongest_index(void)
+{
+  int i, s, b, end, level, half;
+  int *row, *previous;
+  double *strength;
+
+  free_strongest_index();
+
+  nindexed = line_columns.nlines;
+  nblocks = (nindexed + STRONGEST_BLOCK - 1) / STRONGEST_BLOCK;
+  for(ntable_rows = 1; (1 << ntable_rows) <= nblocks; ++ntable_rows);
+
+  for(s = 0; s < NSTRENGTHS; ++s)
+  {
+    strength_index[s].strength = malloc((nindexed + 1) * sizeof(double));
+    strength_index[s].table = malloc(((long) ntable_rows * nblocks + 1) * sizeof(int));
+    if(strength_index[s].strength == NULL || strength_index[s].table == NULL)
+    {
+      free_strongest_index();
+      return EXIT_FAILURE;
+    }
+
+    strength = strength_index[s].strength;
+    for(i = 0; i < nindexed; ++i)
+      strength[i] = s == STRENGTH_GF ? line_columns.gl[i] * line_columns.f[i] : a21(lin_ptr[i]);
+
+    row = strength_index[s].table;
+    for(b = 0; b < nblocks; ++b)
+    {
+      end = (b + 1) * STRONGEST_BLOCK;
+      row[b] = scan_strongest(strength, b * STRONGEST_BLOCK, end < nindexed ? end : nindexed);
+    }
+
+    for(level = 1; level < ntable_rows; ++level)
+    {
+      previous = row;
+      row += nblocks;
+      half = 1 << (level - 1);
+      for(b = 0; b + 2 * half <= nblocks; ++b)
+        row[b] = stronger(strength, previous[b], previous[b + half]);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the strongest line in a range of lines.
+ *
+ * @param[in]  s      The measure of line strength
+ * @param[in]  first  The first line in the range
+ * @param[in]  end    One past the last line in the range, which must be more
+ *                    than first
+ *
+ * @return  The strongest line in the range
+ *
+ * ************************************************************************** */
+
+static int
+range_strongest(int s, int first, int end)
+{
+  int best, level;
+  int bfirst, bend;
+  const double *strength = strength_index[s].strength;
+  const int *row;
+
+  bfirst = (first + STRONGEST_BLOCK - 1) / STRONGEST_BLOCK;
+  bend = end / STRONGEST_BLOCK;
+
+  if(bend <= bfirst)
+    return scan_strongest(strength, first, end);
+
+  for(level = 0; (2 << level) <= bend - bfirst; ++level);
+  row = strength_index[s].table + (long) level * nblocks;
+  best = stronger(strength, row[bfirst], row[bend - (1 << level)]);
+
+  if(first < bfirst * STRONGEST_BLOCK)
+    best = stronger(strength, scan_strongest(strength, first, bfirst * STRONGEST_BLOCK), best);
+  if(bend * STRONGEST_BLOCK < end)
+    best = stronger(strength, best, scan_strongest(strength, bend * STRONGEST_BLOCK, end));
+
+  return best;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add a range of lines to the heap of candidates.
+ *
+ * @details
+ *
+ * The heap is ordered so that the candidate with the strongest line is at the
+ * top. Empty ranges are not added.
+ *
+ * ************************************************************************** */
+
+static void
+push_candidate(int s, Candidate_t *heap, int *nheap, int first, int end)
+{
+  int i, parent;
+  Candidate_t c;
+  const double *strength = strength_index[s].strength;
+
+  if(end <= first)
+    return;
+
+  c.line = range_strongest(s, first, end);
+  c.first = first;
+  c.end = end;
+
+  for(i = (*nheap)++; i > 0; i = parent)
+  {
+    parent = (i - 1) / 2;
+    if(stronger(strength, heap[parent].line, c.line) == heap[parent].line)
+      break;
+    heap[i] = heap[parent];
+  }
+
+  heap[i] = c;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Take the candidate with the strongest line from the heap.
+ *
+ * ************************************************************************** */
+
+static Candidate_t
+pop_candidate(int s, Candidate_t *heap, int *nheap)
+{
+  int i, child;
+  Candidate_t top = heap[0];
+  Candidate_t last = heap[--(*nheap)];
+  const double *strength = strength_index[s].strength;
+
+  for(i = 0; (child = 2 * i + 1) < *nheap; i = child)
+  {
+    if(child + 1 < *nheap && stronger(strength, heap[child + 1].line, heap[child].line) == heap[child + 1].line)
+      child++;
+    if(stronger(strength, last.line, heap[child].line) == last.line)
+      break;
+    heap[i] = heap[child];
+  }
+
+  heap[i] = last;
+
+  return top;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the strongest lines within a frequency range.
+ *
+ * @param[in]   freqmin    The lowest frequency of the range
+ * @param[in]   freqmax    The highest frequency of the range
+ * @param[in]   s          The measure of line strength to use
+ * @param[in]   k          The most lines to find
+ * @param[out]  strongest  The position in lin_ptr of each line found,
+ *                         strongest first, which needs room for k entries
+ *
+ * @return  The number of lines found, which is less than k if there are
+ *          fewer lines in the range, or -1 if the index has not been built
+ *          or memory could not be allocated
+ *
+ * @details
+ *
+ * The range includes both ends, as with find_line_range().
+ *
+ * ************************************************************************** */
+
+int
+find_strongest_lines(double freqmin, double freqmax, int s, int k, int *strongest)
+{
+  int n, nheap;
+  LineRange range;
+  Candidate_t c;
+  Candidate_t *heap;
+
+  if(s < 0 || s >= NSTRENGTHS || strength_index[s].table == NULL || nindexed != line_columns.nlines)
+    return -1;
+
+  if(k <= 0)
+    return 0;
+
+  range = find_line_range(freqmin, freqmax);
+  if(range.end <= range.first)
+    return 0;
+
+  if((heap = malloc((k + 1) * sizeof(Candidate_t))) == NULL)
+    return -1;
+
+  nheap = 0;
+  push_candidate(s, heap, &nheap, range.first, range.end);
+
+  for(n = 0; n < k && nheap > 0; ++n)
+  {
+    c = pop_candidate(s, heap, &nheap);
+    strongest[n] = c.line;
+    push_candidate(s, heap, &nheap, c.first, c.line);
+    push_candidate(s, heap, &nheap, c.line + 1, c.end);
+  }
+
+  free(heap);
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Get the strength of a line.
+ *
+ * @param[in]  s     The measure of line strength
+ * @param[in]  line  The position of the line in lin_ptr
+ *
+ * @return  The strength of the line, or 0 if the index has not been built
+ *
+ * ************************************************************************** */
+
+double
+line_strength(int s, int line)
+{
+  if(s < 0 || s >= NSTRENGTHS || strength_index[s].strength == NULL || line < 0 || line >= nindexed)
+    return 0;
+
+  return strength_index[s].strength[line];
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Add the memory taken by the strongest line index to a memory table.
+ *
+ * @param[in,out]  table  The memory table
+ *
+ * ************************************************************************** */
+
+void
+strongest_index_memory(MemoryTable *table)
+{
+  int s;
+  size_t ntable = (size_t) ntable_rows * nblocks;
+
+  for(s = 0; s < NSTRENGTHS; ++s)
+  {
+    if(strength_index[s].strength == NULL)
+      continue;
+    account_memory(table, strength_index[s].strength, (nindexed + 1) * sizeof(double), nindexed * sizeof(double));
+    account_memory(table, strength_index[s].table, (ntable + 1) * sizeof(int), ntable * sizeof(int));
+  }
+}
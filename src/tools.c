@@ -28,8 +28,8 @@
  *
  * @details
  *
- * This simply loops through the element structure to find the name of the
- * element given the atomic number z.
+ * The element is found using the element lookup table. If there is no element
+ * with atomic number z, element is left as it is.
  *
  * ************************************************************************** */
 
@@ -48,14 +48,8 @@ get_element_name(int z, char *element)
     return;
   }
 
-  for(i = 0; i < nelements; ++i)
-  {
-    if(ele[i].z == z)
-    {
-      strcpy(element, ele[i].name);
-      break;
-    }
-  }
+  if((i = element_index(z)) >= 0)
+    strcpy(element, ele[i].name);
 }
 
 /* ************************************************************************** */
@@ -69,25 +63,21 @@ get_element_name(int z, char *element)
  *
  * @details
  *
- * The input element is converted to lower case first. The function loops over
- * the elements array and compares the input element name to the names in the
- * element array until it finds a match. If a match is found, then
- * atomic_number is updated, otherwise -1 is returned.
+ * The element name is looked up in the table of element names, which ignores
+ * the case of the letters. If a match is found, then atomic_number is updated,
+ * otherwise -1 is returned.
  *
  * ************************************************************************** */
 
 void
 get_atomic_number(const char *element, int *atomic_number)
 {
-  int i, j;
-  const int nletters = 20;
-  char input_name[nletters];
-  char ele_name[nletters];
+  int i;
 
   *atomic_number = -1;
 
   // Return if an empty string is passed
-  if(element[0] == '\0' || element == NULL)
+  if(element == NULL || element[0] == '\0')
     return;
 
   if(ele == NULL)
@@ -96,27 +86,8 @@ get_atomic_number(const char *element, int *atomic_number)
     return;
   }
 
-  /*
-   * Convert the name to lower characters to avoid situation where strcmp will
-   * not be able to match the strings due to different letter cases
-   */
-
-  strcpy(input_name, element);
-  for(i = 0; i < (int) strlen(element); i++)
-    input_name[i] = (char) tolower(element[i]);
-
-  for(i = 0; i < nelements; ++i)
-  {
-    strcpy(ele_name, ele[i].name);
-    // Convert to lower case again
-    for(j = 0; j < nletters; ++j)
-      ele_name[j] = (char) tolower(ele_name[j]);
-    if(strcmp(input_name, ele_name) == 0)
-    {
-      *atomic_number = ele[i].z;
-      break;
-    }
-  }
+  if((i = element_index_by_name(element)) >= 0)
+    *atomic_number = ele[i].z;
 }
 
 
@@ -131,8 +102,7 @@ get_atomic_number(const char *element, int *atomic_number)
  *
  * @details
  *
- * Loops over the ele array trying to match the provided z with the z of all the
- * elements in the atomic data.
+ * The index is found using the element lookup table.
  *
  * ************************************************************************** */
 
@@ -140,18 +110,8 @@ int
 find_element(int z)
 {
   int i;
-  int found = FALSE;
-
-  for(i = 0; i < nelements; ++i)
-  {
-    if(ele[i].z == z)
-    {
-      found = TRUE;
-      break;
-    }
-  }
 
-  if(!found)
+  if((i = element_index(z)) < 0)
   {
     error_atomix("Element Z = %i is not in the atomic data", z);
     return ELEMENT_NO_FOUND;
@@ -0,0 +1,390 @@
+/* ************************************************************************** */
+/**
+ * @file     windows.c
+ * @author   Edward Parkinson
+ * @date     October 2026
+ *
+ * @brief
+ *
+ * Functions for finding the lines and edges in many spectral windows at once.
+ *
+ * @details
+ *
+ * When identifying the features in a spectrum, there are usually hundreds of
+ * wavelengths to look up. Rather than searching for each one on its own, the
+ * windows are sorted by frequency and the frequency ordered lines and edges
+ * are swept through once, picking up where each window starts and ends along
+ * the way. The sweep gallops forward, so windows which are far apart do not
+ * have to step over every line in between.
+ *
+ * The windows can also be read from a file and printed without starting the
+ * UI, which is the headless mode of atomix.
+ *
+ * ************************************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "atomix.h"
+
+#define WINDOW_LINE_LEN 256
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the first key at or after a position which is above a
+ *         frequency.
+ *
+ * @param[in]  keys       The keys in ascending order
+ * @param[in]  n          The number of keys
+ * @param[in]  from       The position to start from
+ * @param[in]  freq       The frequency
+ * @param[in]  inclusive  If TRUE, a key equal to the frequency counts as above
+ *                        it
+ *
+ * @return  The first position above the frequency, or n if there is none
+ *
+ * @details
+ *
+ * The step forward is doubled until it overshoots, and then the last step is
+ * binary searched, so moving d keys forward takes O(log d) comparisons.
+ *
+ * ************************************************************************** */
+
+static int
+gallop_to(const double *keys, int n, int from, double freq, int inclusive)
+{
+  int lo, hi, mid, step;
+
+#define BELOW(k) ((k) < freq || (!inclusive && (k) == freq))
+
+  lo = hi = from;
+  step = 1;
+  while(hi < n && BELOW(keys[hi]))
+  {
+    lo = hi + 1;
+    hi += step;
+    step *= 2;
+  }
+
+  if(hi > n)
+    hi = n;
+
+  while(lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if(BELOW(keys[mid]))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+#undef BELOW
+
+  return lo;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Sweep through a list of keys to find the range of each window.
+ *
+ * @param[in]      keys      The keys in ascending order
+ * @param[in]      n         The number of keys
+ * @param[in]      by_min    The windows in order of freqmin
+ * @param[in]      by_max    The windows in order of freqmax
+ * @param[in,out]  windows   The windows
+ * @param[in]      nwindows  The number of windows
+ * @param[in]      offset    The offset of the range to fill in each window
+ *
+ * ************************************************************************** */
+
+static void
+sweep_windows(const double *keys, int n, const int *by_min, const int *by_max, SpectralWindow *windows,
+              int nwindows, size_t offset)
+{
+  int i, position;
+  LineRange *range;
+
+  for(i = 0, position = 0; i < nwindows; ++i)
+  {
+    range = (LineRange *) ((char *) &windows[by_min[i]] + offset);
+    range->first = position = gallop_to(keys, n, position, windows[by_min[i]].freqmin, TRUE);
+  }
+
+  for(i = 0, position = 0; i < nwindows; ++i)
+  {
+    range = (LineRange *) ((char *) &windows[by_max[i]] + offset);
+    range->end = position = gallop_to(keys, n, position, windows[by_max[i]].freqmax, FALSE);
+    if(range->end < range->first)
+      range->end = range->first;
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Find the lines and edges within each of a set of windows.
+ *
+ * @param[in,out]  windows   The windows, with wmin, wmax and velocity set
+ * @param[in]      nwindows  The number of windows
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if memory could not be allocated
+ *
+ * @details
+ *
+ * The wavelength range of each window is widened by its velocity and turned
+ * into a frequency range. The windows are then sorted by each end of their
+ * frequency range, and the lines, photoionization edges and inner shell edges
+ * are each swept through once for the starts and once for the ends. The
+ * ranges found are the same as find_line_range() would find for each window,
+ * using the threshold frequency of the edges.
+ *
+ * ************************************************************************** */
+
+int
+find_window_ranges(SpectralWindow *windows, int nwindows)
+{
+  int i, n, error;
+  int *by_min, *by_max;
+  double *freqmin, *freqmax, *keys;
+  double tmp, widen;
+
+  if(nwindows <= 0)
+    return EXIT_SUCCESS;
+
+  for(i = 0; i < nwindows; ++i)
+  {
+    if(windows[i].wmin > windows[i].wmax)
+    {
+      tmp = windows[i].wmin;
+      windows[i].wmin = windows[i].wmax;
+      windows[i].wmax = tmp;
+    }
+    widen = windows[i].velocity * 1e5 / C;
+    windows[i].freqmin = C / (windows[i].wmax * (1 + widen) * ANGSTROM);
+    windows[i].freqmax = C / (windows[i].wmin * (1 - widen) * ANGSTROM);
+  }
+
+  n = MAX(nphot_total, n_inner_tot);
+  by_min = malloc(nwindows * sizeof(int));
+  by_max = malloc(nwindows * sizeof(int));
+  freqmin = malloc(nwindows * sizeof(double));
+  freqmax = malloc(nwindows * sizeof(double));
+  keys = malloc((n + 1) * sizeof(double));
+
+  error = by_min == NULL || by_max == NULL || freqmin == NULL || freqmax == NULL || keys == NULL;
+
+  if(!error)
+  {
+    for(i = 0; i < nwindows; ++i)
+    {
+      freqmin[i] = windows[i].freqmin;
+      freqmax[i] = windows[i].freqmax;
+    }
+    error = sort_by_key(nwindows, freqmin, by_min) || sort_by_key(nwindows, freqmax, by_max);
+  }
+
+  if(!error)
+  {
+    sweep_windows(line_columns.freq, line_columns.nlines, by_min, by_max, windows, nwindows,
+                  offsetof(SpectralWindow, lines));
+
+    for(i = 0; i < nphot_total; ++i)
+      keys[i] = phot_top_ptr[i]->freq[0];
+    sweep_windows(keys, nphot_total, by_min, by_max, windows, nwindows, offsetof(SpectralWindow, phot));
+
+    for(i = 0; i < n_inner_tot; ++i)
+      keys[i] = inner_cross_ptr[i]->freq[0];
+    sweep_windows(keys, n_inner_tot, by_min, by_max, windows, nwindows, offsetof(SpectralWindow, inner));
+  }
+
+  free(by_min);
+  free(by_max);
+  free(freqmin);
+  free(freqmax);
+  free(keys);
+
+  return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Read a list of spectral windows from a file.
+ *
+ * @param[in]   path      The file to read
+ * @param[in]   velocity  The velocity width in km/s of windows which do not
+ *                        give their own
+ * @param[out]  windows   The windows read, which should be freed by the caller
+ *
+ * @return  The number of windows read, or -1 if the file could not be read
+ *
+ * @details
+ *
+ * Each line of the file is a window, given as
+ *
+ *  @verbatim
+ *  wavelength [wavelength_max [velocity]]
+ *  @endverbatim
+ *
+ * with the wavelengths in Angstroms and the velocity in km/s. A window with
+ * only one wavelength is a single wavelength, which is usually widened by a
+ * velocity. Blank lines and lines starting with # are ignored.
+ *
+ * ************************************************************************** */
+
+int
+read_spectral_windows(const char *path, double velocity, SpectralWindow **windows)
+{
+  int n, nmax, nwords;
+  double wmin, wmax, v;
+  char aline[WINDOW_LINE_LEN];
+  FILE *f;
+  SpectralWindow *tmp;
+
+  *windows = NULL;
+
+  if((f = fopen(path, "r")) == NULL)
+    return -1;
+
+  n = nmax = 0;
+
+  while(fgets(aline, WINDOW_LINE_LEN, f) != NULL)
+  {
+    if(aline[strspn(aline, " \t")] == '#')
+      continue;
+
+    nwords = sscanf(aline, "%le %le %le", &wmin, &wmax, &v);
+    if(nwords < 1)
+      continue;
+    if(nwords < 2)
+      wmax = wmin;
+    if(nwords < 3)
+      v = velocity;
+
+    if(n == nmax)
+    {
+      nmax = nmax ? 2 * nmax : 64;
+      if((tmp = realloc(*windows, nmax * sizeof(SpectralWindow))) == NULL)
+      {
+        free(*windows);
+        *windows = NULL;
+        fclose(f);
+        return -1;
+      }
+      *windows = tmp;
+    }
+
+    memset(&(*windows)[n], 0, sizeof(SpectralWindow));
+    (*windows)[n].wmin = wmin;
+    (*windows)[n].wmax = wmax;
+    (*windows)[n].velocity = v;
+    n++;
+  }
+
+  fclose(f);
+
+  return n;
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Print the lines and edges found in each window.
+ *
+ * @param[in]  f         The stream to print to
+ * @param[in]  windows   The windows, after find_window_ranges()
+ * @param[in]  nwindows  The number of windows
+ *
+ * @details
+ *
+ * The columns are the same as in the bound-bound and bound-free screens, so
+ * the output can be compared with what is shown in the UI.
+ *
+ * ************************************************************************** */
+
+void
+print_spectral_windows(FILE *f, const SpectralWindow *windows, int nwindows)
+{
+  int i, n;
+  char element[LINELEN];
+  const SpectralWindow *w;
+  TopPhotPtr edge;
+
+  for(i = 0; i < nwindows; ++i)
+  {
+    w = &windows[i];
+    fprintf(f, "# Window %i: %.2f - %.2f Angstroms +/- %.1f km/s: %i lines, %i photoionization edges, "
+            "%i inner shell edges\n", i, w->wmin, w->wmax, w->velocity, w->lines.end - w->lines.first,
+            w->phot.end - w->phot.first, w->inner.end - w->inner.first);
+
+    if(w->lines.end > w->lines.first)
+    {
+      fprintf(f, " %-12s %-12s %-12s %-12s %-12s %-12s %-12s %-12s %-12s\n", "Wavelength", "Element", "Z", "istate",
+              "levu", "levl", "nion", "macro info", "nres");
+      for(n = w->lines.first; n < w->lines.end; ++n)
+      {
+        get_element_name(line_columns.z[n], element);
+        fprintf(f, " %-12.2f %-12s %-12i %-12i %-12i %-12i %-12i %-12i %-12i\n", line_columns.wavelength[n], element,
+                line_columns.z[n], line_columns.istate[n], line_columns.levu[n], line_columns.levl[n],
+                line_columns.nion[n], line_columns.macro_info[n], n);
+      }
+    }
+
+    if(w->phot.end > w->phot.first || w->inner.end > w->inner.first)
+    {
+      fprintf(f, " %-12s %-12s %-12s %-12s %-12s %-12s %-12s\n", "Wavelength", "Element", "Z", "istate", "n", "l",
+              "type");
+      for(n = w->phot.first; n < w->phot.end; ++n)
+      {
+        edge = phot_top_ptr[n];
+        get_element_name(edge->z, element);
+        fprintf(f, " %-12.2f %-12s %-12i %-12i %-12i %-12i %-12s\n", C_SI / edge->freq[0] / ANGSTROM / 1e-2, element,
+                edge->z, edge->istate, edge->n, edge->l, "phot");
+      }
+      for(n = w->inner.first; n < w->inner.end; ++n)
+      {
+        edge = inner_cross_ptr[n];
+        get_element_name(edge->z, element);
+        fprintf(f, " %-12.2f %-12s %-12i %-12i %-12i %-12i %-12s\n", C_SI / edge->freq[0] / ANGSTROM / 1e-2, element,
+                edge->z, edge->istate, edge->n, edge->l, "inner");
+      }
+    }
+  }
+}
+
+/* ************************************************************************** */
+/**
+ * @brief  Look up a file of spectral windows and print the results, without
+ *         starting the UI.
+ *
+ * @param[in]  path      The file of windows
+ * @param[in]  velocity  The default velocity width in km/s
+ *
+ * @return  EXIT_SUCCESS, or EXIT_FAILURE if the windows could not be read or
+ *          looked up
+ *
+ * ************************************************************************** */
+
+int
+headless_window_lookup(const char *path, double velocity)
+{
+  int nwindows;
+  SpectralWindow *windows;
+
+  if((nwindows = read_spectral_windows(path, velocity, &windows)) < 0)
+  {
+    printf("Unable to read the spectral windows in %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  if(find_window_ranges(windows, nwindows))
+  {
+    printf("Unable to allocate memory to look up the spectral windows\n");
+    free(windows);
+    return EXIT_FAILURE;
+  }
+
+  print_spectral_windows(stdout, windows, nwindows);
+  free(windows);
+
+  return EXIT_SUCCESS;
+}
@@ -1,4 +1,5 @@
 #!/bin/bash
 cproto lines.c buffer.c main.c menu.c tools.c ui.c photoionization.c atomic_data.c query.c \
-       elements.c ions.c levels.c inner.c parse.c > functions.h
+       elements.c ions.c levels.c inner.c parse.c snapshot.c records.c lookup.c sort.c columns.c windows.c \
+       postings.c stats.c strongest.c coverage.c lowerlevel.c adjacency.c compact.c memory.c > functions.h
 cproto log.c > log.h